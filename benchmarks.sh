@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Benchmark runner for post-scarcity software environment. Runs every
+# compiled benchmark in target/bench, and every script in the benchmarks
+# subdirectory, reporting their timings. Unlike the unit tests, these do
+# not pass or fail; the numbers are for comparison between builds.
+
+# (c) 2017 Simon Brooke <simon@journeyman.cc>
+# Licensed under GPL version 2.0, or, at your option, any later version.
+
+for file in target/bench/*
+do
+    if [ -x "${file}" ]
+    then
+        echo "${file}:"
+        ${file}
+        echo
+    fi
+done
+
+for file in benchmarks/*.sh
+do
+    if [ -f "${file}" ]
+    then
+        echo "${file}:"
+        bash ${file}
+        echo
+    fi
+done
@@ -0,0 +1,90 @@
+/*
+ * alloc-threads.c
+ *
+ * Measure how cons cell allocation scales with the number of threads
+ * allocating concurrently. Each thread repeatedly allocates a batch of
+ * cells and then frees them; the total number of cells allocated is the
+ * same whatever the number of threads, so on a machine with enough cores
+ * the elapsed time should fall in proportion to the number of threads.
+ *
+ * usage: alloc-threads [CELLS [MAX_THREADS [BATCH]]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+struct worker {
+    pthread_t thread;
+    uint64_t cells;
+    uint64_t batch;
+};
+
+void *allocate_and_free( void *arg ) {
+    struct worker *worker = ( struct worker * ) arg;
+    struct cons_pointer *cells =
+        calloc( worker->batch, sizeof( struct cons_pointer ) );
+
+    for ( uint64_t done = 0; done < worker->cells; done += worker->batch ) {
+        for ( uint64_t i = 0; i < worker->batch; i++ ) {
+            cells[i] = allocate_cell( CONSTV );
+        }
+        for ( uint64_t i = 0; i < worker->batch; i++ ) {
+            dec_ref( cells[i] );
+        }
+    }
+
+    free( cells );
+    release_cons_pages(  );
+
+    return NULL;
+}
+
+int main( int argc, char *argv[] ) {
+    long cores = sysconf( _SC_NPROCESSORS_ONLN );
+    uint64_t n = bench_arg( argc, argv, 1, 20000000 );
+    uint64_t max_threads = bench_arg( argc, argv, 2,
+                                      cores > 0 ? 2 * cores : 2 );
+    uint64_t batch = bench_arg( argc, argv, 3, 4096 );
+    char name[64];
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    printf( "%ld cores online\n", cores );
+
+    for ( uint64_t threads = 1; threads <= max_threads; threads *= 2 ) {
+        struct worker *workers = calloc( threads, sizeof( struct worker ) );
+        uint64_t start = bench_now(  );
+
+        for ( uint64_t t = 0; t < threads; t++ ) {
+            workers[t].cells = n / threads;
+            workers[t].batch = batch;
+            pthread_create( &workers[t].thread, NULL, allocate_and_free,
+                            &workers[t] );
+        }
+        for ( uint64_t t = 0; t < threads; t++ ) {
+            pthread_join( workers[t].thread, NULL );
+        }
+
+        snprintf( name, sizeof( name ), "allocate+free, %llu threads",
+                  ( unsigned long long ) threads );
+        bench_report( name, n, bench_now(  ) - start );
+
+        free( workers );
+    }
+
+    /* every cell allocated should also have been freed */
+    summarise_allocation(  );
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * alloc-throughput.c
+ *
+ * Measure cons cell allocation throughput: allocate N live cells (by
+ * default ten million), free them all, and then allocate them all again
+ * from the recycled cells.
+ *
+ * usage: alloc-throughput [N]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 10000000 );
+    struct cons_pointer *cells = calloc( n, sizeof( struct cons_pointer ) );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    if ( cells == NULL ) {
+        fprintf( stderr, "Failed to allocate %llu pointers\n",
+                 ( unsigned long long ) n );
+        exit( 1 );
+    }
+
+    uint64_t start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        cells[i] = allocate_cell( CONSTV );
+    }
+    bench_report( "allocate fresh cells", n, bench_now(  ) - start );
+
+    start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        dec_ref( cells[i] );
+    }
+    bench_report( "free cells", n, bench_now(  ) - start );
+
+    start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        cells[i] = allocate_cell( CONSTV );
+    }
+    bench_report( "allocate recycled cells", n, bench_now(  ) - start );
+
+    free( cells );
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * array-arith.c
+ *
+ * Measure the cost per element of arithmetic on numeric arrays, against
+ * that of the same arithmetic on the boxed numbers of a vector. To compare
+ * the SSE2 kernels with the scalar loops, build this once as usual and
+ * once with `-DSCALAR_KERNELS` added to CFLAGS (after `make clean`).
+ *
+ * usage: array-arith [CALLS [LENGTH]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "arith/array.h"
+#include "arith/integer.h"
+#include "arith/peano.h"
+#include "arith/real.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/stack.h"
+#include "memory/vector.h"
+
+/**
+ * Apply `op` to these two arrays, `a` and `b`, `n` times, and report how
+ * long it took per element under this `name`.
+ *
+ * @return the number of calls which returned an exception.
+ */
+static uint64_t time_arrays( const char *name, wchar_t op,
+                             struct cons_pointer a, struct cons_pointer b,
+                             struct cons_pointer frame_pointer, uint64_t n ) {
+    uint64_t failures = 0;
+    uint64_t start = bench_now(  );
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        struct cons_pointer r = array_arithmetic( op, a, b, frame_pointer );
+
+        if ( exceptionp( r ) ) {
+            failures++;
+        }
+        dec_ref( r );
+    }
+    bench_report( name, n * numeric_array_length( a ), bench_now(  ) - start );
+
+    return failures;
+}
+
+/**
+ * Subtract the boxed numbers in vector `b` from those in vector `a`,
+ * pairwise, `n` times, and report how long it took per element under this
+ * `name`.
+ */
+static void time_boxed( const char *name, struct cons_pointer a,
+                        struct cons_pointer b,
+                        struct cons_pointer frame_pointer, uint64_t n ) {
+    struct stack_frame *frame = get_stack_frame( frame_pointer );
+    uint64_t length = vector_length( a );
+    uint64_t start = bench_now(  );
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        for ( uint64_t j = 0; j < length; j++ ) {
+            dec_ref( subtract_2( frame, frame_pointer, vector_get( a, j ),
+                                 vector_get( b, j ) ) );
+        }
+    }
+    bench_report( name, n * length, bench_now(  ) - start );
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 10000 );
+    uint64_t length = bench_arg( argc, argv, 2, 1000 );
+    uint64_t failures = 0;
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    struct cons_pointer frame_pointer = make_empty_frame( NIL );
+    struct cons_pointer ia = make_intarray( length );
+    struct cons_pointer ib = make_intarray( length );
+    struct cons_pointer ra = make_realarray( length );
+    struct cons_pointer rb = make_realarray( length );
+    struct cons_pointer ints = NIL;
+    struct cons_pointer reals = NIL;
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        pointer_to_vso( ia )->payload.intarray.elements[i] = i;
+        pointer_to_vso( ib )->payload.intarray.elements[i] = length - i;
+        pointer_to_vso( ra )->payload.realarray.elements[i] = i * 0.5;
+        pointer_to_vso( rb )->payload.realarray.elements[i] = length - i;
+    }
+    for ( uint64_t i = length; i > 0; i-- ) {
+        ints = make_cons( acquire_integer( i, NIL ), ints );
+        reals = make_cons( make_real( i * 0.5 ), reals );
+    }
+    struct cons_pointer vi = list_to_vector( ints );
+    struct cons_pointer vr = list_to_vector( reals );
+
+    failures += time_arrays( "integer array +", L'+', ia, ib, frame_pointer,
+                             n );
+    failures += time_arrays( "integer array -", L'-', ia, ib, frame_pointer,
+                             n );
+    failures += time_arrays( "integer array *", L'*', ia, ib, frame_pointer,
+                             n );
+    failures += time_arrays( "real array +", L'+', ra, rb, frame_pointer, n );
+    failures += time_arrays( "real array -", L'-', ra, rb, frame_pointer, n );
+    failures += time_arrays( "real array *", L'*', ra, rb, frame_pointer, n );
+    time_boxed( "boxed integer -", vi, vi, frame_pointer, n );
+    time_boxed( "boxed real -", vr, vr, frame_pointer, n );
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu calls failed\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
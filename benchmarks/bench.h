@@ -0,0 +1,62 @@
+/*
+ * bench.h
+ *
+ * Shared helpers for the micro-benchmarks in this directory. Each
+ * benchmark is a standalone program linked against everything in `src`
+ * except `init.c`, so that it can drive the allocator and the interpreter
+ * directly.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_bench_h
+#define __psse_bench_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @return the current value of the monotonic clock, in nanoseconds.
+ */
+static inline uint64_t bench_now(  ) {
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Report one measurement, in a form which is easy both to read and to
+ * grep: the name of the benchmark, the number of operations, the elapsed
+ * time and the time per operation.
+ */
+static inline void bench_report( const char *name, uint64_t operations,
+                                 uint64_t elapsed_ns ) {
+    printf( "%-36s %12llu ops %10.3f ms %10.2f ns/op\n", name,
+            ( unsigned long long ) operations, elapsed_ns / 1e6,
+            operations > 0 ? ( double ) elapsed_ns / operations : 0.0 );
+}
+
+/**
+ * @return the numeric value of argument `n` of `argv`, if present and
+ * positive, else `dflt`.
+ */
+static inline uint64_t bench_arg( int argc, char *argv[], int n,
+                                  uint64_t dflt ) {
+    uint64_t result = dflt;
+
+    if ( argc > n ) {
+        long long v = atoll( argv[n] );
+        if ( v > 0 ) {
+            result = ( uint64_t ) v;
+        }
+    }
+
+    return result;
+}
+
+#endif
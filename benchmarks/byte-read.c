@@ -0,0 +1,106 @@
+/*
+ * byte-read.c
+ *
+ * Measure the cost of ingesting a file as raw bytes with `read-bytes`,
+ * against that of reading it as characters with `slurp`, and the cost of
+ * slicing the byte buffer so made, which should not depend on the length
+ * of the slice.
+ *
+ * usage: byte-read [LENGTH [REPEATS]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include "bench.h"
+#include "io/io.h"
+#include "memory/bytes.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/pstring.h"
+#include "memory/stack.h"
+#include "ops/lispops.h"
+
+/**
+ * Evaluate `(reader (open path))` `repeats` times, and report how long it
+ * took per byte of the file, of this `length`, under this `name`.
+ *
+ * @return the value of the last evaluation.
+ */
+static struct cons_pointer time_reader( const char *name,
+                                        struct cons_pointer reader,
+                                        struct cons_pointer path,
+                                        uint64_t length, uint64_t repeats ) {
+    struct cons_pointer frame_pointer = make_empty_frame( NIL );
+    struct stack_frame *frame = get_stack_frame( frame_pointer );
+    struct cons_pointer open = make_function( NIL, &lisp_open );
+    struct cons_pointer form =
+        make_cons( reader,
+                   make_cons( make_cons( open, make_cons( path, NIL ) ),
+                              NIL ) );
+    struct cons_pointer result = NIL;
+    uint64_t start = bench_now(  );
+
+    for ( uint64_t r = 0; r < repeats; r++ ) {
+        dec_ref( result );
+        result = eval_form( frame, frame_pointer, form, NIL );
+    }
+    bench_report( name, length * repeats, bench_now(  ) - start );
+
+    return result;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t length = bench_arg( argc, argv, 1, 1000000 );
+    uint64_t repeats = bench_arg( argc, argv, 2, 3 );
+    char path[] = "/tmp/byte-read-XXXXXX";
+    int fd = mkstemp( path );
+    FILE *file = fdopen( fd, "w" );
+    uint64_t failures = 0;
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        fputc( ( i % 64 == 63 ) ? '\n' : 'a' + ( i % 26 ), file );
+    }
+    fclose( file );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    wchar_t wide_path[sizeof( path )];
+
+    mbstowcs( wide_path, path, sizeof( path ) );
+
+    struct cons_pointer lisp_path = c_string_to_lisp_string( wide_path );
+    struct cons_pointer bytes =
+        time_reader( "read-bytes", make_function( NIL, &lisp_read_bytes ),
+                     lisp_path, length, repeats );
+    struct cons_pointer string =
+        time_reader( "slurp", make_function( NIL, &lisp_slurp ), lisp_path,
+                     length, repeats );
+
+    failures += bytes_length( bytes ) == length ? 0 : 1;
+    failures += pstring_length( string ) == length ? 0 : 1;
+
+    uint64_t start = bench_now(  );
+    for ( uint64_t r = 0; r < repeats * 1000; r++ ) {
+        dec_ref( bytes_slice( bytes, 1, length - 2 ) );
+    }
+    bench_report( "byte-slice of the whole buffer", repeats * 1000,
+                  bench_now(  ) - start );
+
+    unlink( path );
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu reads failed\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
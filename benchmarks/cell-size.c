@@ -0,0 +1,111 @@
+/*
+ * cell-size.c
+ *
+ * Measure the memory used by each element of a long list of integers,
+ * which is to say by a cons cell and an integer cell, as the growth in
+ * resident set size while the list is built; and the cost of the access
+ * control list side table, both to look up cells which have no access
+ * control list, which is almost all of them, and to maintain a sparse
+ * scattering of cells which do. The report of memory by type is written
+ * to stderr.
+ *
+ * usage: cell-size [ELEMENTS [ONE-IN]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "arith/integer.h"
+#include "io/fopen.h"
+#include "io/io.h"
+#include "memory/access.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * @return the resident set size of this process, in kilobytes.
+ */
+uint64_t rss_kb(  ) {
+    unsigned long long size = 0, resident = 0;
+    FILE *statm = fopen( "/proc/self/statm", "r" );
+
+    if ( statm != NULL ) {
+        if ( fscanf( statm, "%llu %llu", &size, &resident ) != 2 ) {
+            resident = 0;
+        }
+        fclose( statm );
+    }
+
+    return resident * ( uint64_t ) sysconf( _SC_PAGESIZE ) / 1024;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 4000000 );
+    uint64_t one_in = bench_arg( argc, argv, 2, 100 );
+    struct cons_pointer list = NIL;
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    uint64_t before = rss_kb(  );
+    uint64_t start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        /* large enough not to come from the cache of small integers */
+        struct cons_pointer number =
+            make_integer( ( int64_t ) ( i + 1000 ), NIL );
+        struct cons_pointer next = make_cons( number, list );
+
+        dec_ref( number );
+        dec_ref( list );
+        list = next;
+    }
+    bench_report( "build list of integers", n, bench_now(  ) - start );
+    printf( "%-36s %12.2f bytes\n", "resident memory per element",
+            ( rss_kb(  ) - before ) * 1024.0 / n );
+
+    /* give a sparse scattering of the conses access control lists */
+    struct cons_pointer acl = make_cons( TRUE, NIL );
+    uint64_t with_acl = 0;
+    uint64_t i = 0;
+    start = bench_now(  );
+    for ( struct cons_pointer p = list; !nilp( p ); p = c_cdr( p ) ) {
+        if ( i++ % one_in == 0 ) {
+            set_access( p, acl );
+            with_acl++;
+        }
+    }
+    bench_report( "set access control lists", n,
+                  bench_now(  ) - start );
+
+    uint64_t found = 0;
+    start = bench_now(  );
+    for ( struct cons_pointer p = list; !nilp( p ); p = c_cdr( p ) ) {
+        if ( !nilp( get_access( p ) ) ) {
+            found++;
+        }
+    }
+    bench_report( "look up access control lists", n, bench_now(  ) - start );
+
+    summarise_memory_by_tag( file_to_url_file( stderr ) );
+
+    start = bench_now(  );
+    dec_ref( list );
+    dec_ref( acl );
+    reclaim_pending_cells( 0 );
+    bench_report( "free list", n, bench_now(  ) - start );
+
+    if ( found != with_acl || access_entries != 0 ) {
+        fprintf( stdout, "Inconsistent access table: %llu, %llu, %u\n",
+                 ( unsigned long long ) found,
+                 ( unsigned long long ) with_acl, access_entries );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * deep-equal.c
+ *
+ * Measure how fast we can walk, and compare with `equal`, two large
+ * structures, each a balanced binary tree of conses with integers at its
+ * leaves, whose cells have been scattered across cons space by heavy churn
+ * beforehand; which is to say, measure the cost of chasing pointers at
+ * random through a large heap. The trees are balanced because `equal`
+ * recurses down the cdrs of lists, and would overflow the stack on long
+ * ones. If HUGE is not zero, cons space is backed by transparent huge
+ * pages.
+ *
+ * usage: deep-equal [DEPTH [HUGE [WALKS]]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "arith/integer.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "ops/equal.h"
+
+/**
+ * A cheap, deterministic pseudo-random number generator, so that runs
+ * are comparable.
+ */
+static uint64_t bench_random_state = 88172645463325252ULL;
+
+static uint64_t bench_random(  ) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+
+    return bench_random_state;
+}
+
+/**
+ * Free these `n` `cells` in random order, so that the cells of whatever is
+ * built next are scattered.
+ */
+static void churn( struct cons_pointer *cells, uint64_t n ) {
+    for ( uint64_t i = n - 1; i > 0; i-- ) {
+        uint64_t j = bench_random(  ) % ( i + 1 );
+        struct cons_pointer swap = cells[i];
+        cells[i] = cells[j];
+        cells[j] = swap;
+    }
+    for ( uint64_t i = 0; i < n; i++ ) {
+        dec_ref( cells[i] );
+    }
+}
+
+/**
+ * @return a balanced binary tree of conses of this `depth`, with integers,
+ * counting up from this `first`, at its leaves.
+ */
+static struct cons_pointer build( uint32_t depth, int64_t first ) {
+    struct cons_pointer result;
+
+    if ( depth == 0 ) {
+        /* large enough not to come from the cache of small integers */
+        result = make_integer( first + 1000, NIL );
+    } else {
+        struct cons_pointer left = build( depth - 1, first );
+        struct cons_pointer right =
+            build( depth - 1, first + ( 1LL << ( depth - 1 ) ) );
+
+        result = make_cons( left, right );
+        dec_ref( left );
+        dec_ref( right );
+    }
+
+    return result;
+}
+
+/**
+ * @return the number of integers at the leaves of this `tree`.
+ */
+static uint64_t walk( struct cons_pointer tree ) {
+    uint64_t result = 0;
+
+    if ( pointer2tag( tree ).value == CONSTV ) {
+        result = walk( pointer2cell( tree ).payload.cons.car ) +
+            walk( pointer2cell( tree ).payload.cons.cdr );
+    } else if ( pointer2tag( tree ).value == INTEGERTV ) {
+        result = 1;
+    }
+
+    return result;
+}
+
+int main( int argc, char *argv[] ) {
+    uint32_t depth = bench_arg( argc, argv, 1, 20 );
+    uint64_t n = 1ULL << depth;
+    uint64_t walks = bench_arg( argc, argv, 3, 5 );
+    uint64_t n_cells = n * 4;
+    struct cons_pointer *cells =
+        calloc( n_cells, sizeof( struct cons_pointer ) );
+
+    setlocale( LC_ALL, "" );
+    cons_space_huge_pages = bench_arg( argc, argv, 2, 0 ) != 0;
+    initialise_cons_pages(  );
+
+    for ( uint64_t i = 0; i < n_cells; i++ ) {
+        cells[i] = allocate_cell( CONSTV );
+    }
+    churn( cells, n_cells );
+
+    struct cons_pointer a = build( depth, 0 );
+    struct cons_pointer b = build( depth, 0 );
+    uint64_t visited = 0;
+    uint64_t start = bench_now(  );
+
+    for ( uint64_t w = 0; w < walks; w++ ) {
+        visited += walk( a );
+    }
+    bench_report( "walk tree after churn", visited,
+                  bench_now(  ) - start );
+
+    uint64_t same = 0;
+    start = bench_now(  );
+    for ( uint64_t w = 0; w < walks; w++ ) {
+        same += equal( a, b ) ? 1 : 0;
+    }
+    bench_report( "equal on trees", n * walks,
+                  bench_now(  ) - start );
+
+    free( cells );
+
+    if ( same != walks || visited != n * walks ) {
+        fprintf( stdout, "Inconsistent structures: %llu, %llu\n",
+                 ( unsigned long long ) same,
+                 ( unsigned long long ) visited );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Calls per second on lisp/fact.lisp: the workload is evaluated repeatedly,
+# with further factorials, and the number of stack frames made, as counted
+# by (room), is divided by the best wall clock time of several runs. Each
+# application of a function or special form makes one stack frame, save
+# that primitives called with few arguments make theirs on the C stack,
+# and are not counted; so across that change, compare times, not rates.
+
+# (c) 2017 Simon Brooke <simon@journeyman.cc>
+# Licensed under GPL version 2.0, or, at your option, any later version.
+
+repeats=${REPEATS:-500}
+runs=${RUNS:-3}
+workload=`mktemp`
+
+cat lisp/fact.lisp > ${workload}
+for i in `seq ${repeats}`
+do
+    echo "(fact 20)" >> ${workload}
+done
+echo '(:allocated (:stak (:by-vector-type (room))))' >> ${workload}
+
+best=''
+for run in `seq ${runs}`
+do
+    start=`date +%s%N`
+    frames=`target/psse "$@" < ${workload} 2>/dev/null | tail -1`
+    end=`date +%s%N`
+    elapsed=$(( ( end - start ) / 1000000 ))
+    if [ -z "${best}" ] || [ ${elapsed} -lt ${best} ]
+    then
+        best=${elapsed}
+    fi
+done
+
+printf "%-36s %12s frames %10s ms %12s calls/s\n" "fact.lisp x ${repeats}" \
+       "${frames//,/}" "${best}" $(( ${frames//,/} * 1000 / best ))
+
+rm ${workload}
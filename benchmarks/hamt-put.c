@@ -0,0 +1,161 @@
+/*
+ * hamt-put.c
+ *
+ * Measure the cost of putting a key into a hashmap which may not be
+ * changed, so that the put must give a new map: for a hashmap, by cloning
+ * it and putting into the clone, as `hashmap_put` does when the current
+ * user may not write the map; for a persistent hashmap, by copying only the
+ * path to the key. Also measure getting keys from each, and removing keys
+ * from a persistent hashmap, as the number of keys grows.
+ *
+ * usage: hamt-put [KEYS...]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#include "bench.h"
+#include "arith/integer.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/hamt.h"
+#include "memory/hashmap.h"
+#include "memory/vectorspace.h"
+#include "ops/equal.h"
+#include "ops/intern.h"
+
+/**
+ * The number of new maps made by putting into each map.
+ */
+#define PUTS 1000
+
+/**
+ * Report the time since `start` of `ops` operations, under this `what` and
+ * this number `n` of keys.
+ */
+static void report( const char *what, uint64_t n, uint64_t ops,
+                    uint64_t start ) {
+    char name[40];
+
+    snprintf( name, sizeof( name ), "%s, %lu keys", what, n );
+    bench_report( name, ops, bench_now(  ) - start );
+}
+
+/**
+ * Fill a hashmap and a persistent hashmap with `n` distinct symbols, then
+ * time puts, gets and removes on each.
+ *
+ * @return the number of operations which gave wrong answers.
+ */
+static uint64_t time_maps( uint64_t n ) {
+    struct cons_pointer *keys = calloc( n, sizeof( struct cons_pointer ) );
+    struct cons_pointer flat = make_hashmap( DFLT_HASHMAP_SLOTS, NIL, TRUE );
+    struct cons_pointer hamt = make_hamt( NIL, TRUE );
+    struct cons_pointer extra = c_string_to_lisp_symbol( L"extra" );
+    struct cons_pointer value = acquire_integer( 1, NIL );
+    uint64_t failures = 0;
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        wchar_t wide[40];
+
+        swprintf( wide, 40, L"key-%lu", i );
+        keys[i] = c_string_to_lisp_symbol( wide );
+        hashmap_put( flat, keys[i], acquire_integer( i, NIL ) );
+        hashmap_put( hamt, keys[i], acquire_integer( i, NIL ) );
+    }
+
+    uint64_t start = bench_now(  );
+    for ( uint64_t r = 0; r < PUTS; r++ ) {
+        struct cons_pointer clone = clone_hashmap( flat );
+
+        hashmap_put( clone, extra, value );
+        failures += eq( hashmap_get( clone, extra, false ), value ) ? 0 : 1;
+        dec_ref( clone );
+    }
+    report( "clone and put, hashmap", n, PUTS, start );
+
+    start = bench_now(  );
+    for ( uint64_t r = 0; r < PUTS; r++ ) {
+        struct cons_pointer next = hamt_assoc( hamt, extra, value );
+
+        failures += eq( hamt_get( next, extra, false ), value ) ? 0 : 1;
+        dec_ref( next );
+    }
+    report( "persistent put, hamt", n, PUTS, start );
+    failures += nilp( hamt_get( hamt, extra, false ) ) ? 0 : 1;
+
+    for ( int m = 0; m < 2; m++ ) {
+        struct cons_pointer map = m == 0 ? flat : hamt;
+
+        start = bench_now(  );
+        for ( uint64_t i = 0; i < n; i++ ) {
+            struct cons_pointer found = hashmap_get( map, keys[i], false );
+
+            if ( !integerp( found ) ||
+                 pointer2cell( found ).payload.integer.value != i ) {
+                failures++;
+            }
+        }
+        report( m == 0 ? "get, hashmap" : "get, hamt", n, n, start );
+    }
+
+    start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        struct cons_pointer next = hamt_dissoc( hamt, keys[i] );
+
+        failures += hamt_count( next ) == n - 1 &&
+            nilp( hamt_get( next, keys[i], false ) ) ? 0 : 1;
+        dec_ref( next );
+    }
+    report( "persistent remove, hamt", n, n, start );
+
+    /* and the map it was removed from is unchanged, while removing every
+     * key in place leaves it empty */
+    start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        failures += nilp( hamt_get( hamt, keys[i], false ) ) ? 1 : 0;
+        hamt = hamt_remove( hamt, keys[i] );
+    }
+    report( "remove in place, hamt", n, n, start );
+    failures += hamt_count( hamt ) == 0 &&
+        nilp( hamt_payload( hamt )->root ) ? 0 : 1;
+
+    dec_ref( flat );
+    dec_ref( hamt );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        dec_ref( keys[i] );
+    }
+    free( keys );
+
+    return failures;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t failures = 0;
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    if ( argc > 1 ) {
+        for ( int i = 1; i < argc; i++ ) {
+            failures += time_maps( bench_arg( argc, argv, i, 10000 ) );
+        }
+    } else {
+        for ( uint64_t n = 100; n <= 10000; n *= 10 ) {
+            failures += time_maps( n );
+        }
+    }
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu operations gave wrong answers\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * hashmap-lookup.c
+ *
+ * Measure the cost of putting symbol keys into a hashmap, and of getting
+ * them out again, as the number of keys grows. A hashmap which is rehashed
+ * as it grows should cost much the same per operation whatever its size.
+ * Since most maps are read far more often than they are written, the gets
+ * are repeated, and are followed by gets of keys which are not there.
+ *
+ * usage: hashmap-lookup [KEYS...]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#include "bench.h"
+#include "arith/integer.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/hashmap.h"
+#include "memory/vectorspace.h"
+#include "ops/intern.h"
+
+/**
+ * The number of times each key is got from the map.
+ */
+#define GET_ROUNDS 10
+
+/**
+ * Put `n` distinct symbols into a new hashmap, then get each of them out
+ * `GET_ROUNDS` times, then get as many symbols which were not put, and
+ * report how long each took per key.
+ *
+ * @return the number of keys which were not found.
+ */
+static uint64_t time_map( uint64_t n ) {
+    struct cons_pointer *keys = calloc( n, sizeof( struct cons_pointer ) );
+    struct cons_pointer *absent = calloc( n, sizeof( struct cons_pointer ) );
+    struct cons_pointer map = make_hashmap( DFLT_HASHMAP_SLOTS, NIL, TRUE );
+    uint64_t failures = 0;
+    char name[40];
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        wchar_t wide[40];
+
+        swprintf( wide, 40, L"key-%lu", i );
+        keys[i] = c_string_to_lisp_symbol( wide );
+        swprintf( wide, 40, L"absent-%lu", i );
+        absent[i] = c_string_to_lisp_symbol( wide );
+    }
+
+    uint64_t start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        hashmap_put( map, keys[i], acquire_integer( i, NIL ) );
+    }
+    snprintf( name, sizeof( name ), "put, %lu keys", n );
+    bench_report( name, n, bench_now(  ) - start );
+
+    start = bench_now(  );
+    for ( int r = 0; r < GET_ROUNDS; r++ ) {
+        for ( uint64_t i = 0; i < n; i++ ) {
+            struct cons_pointer value = hashmap_get( map, keys[i], false );
+
+            if ( !integerp( value ) ||
+                 pointer2cell( value ).payload.integer.value != i ) {
+                failures++;
+            }
+        }
+    }
+    snprintf( name, sizeof( name ), "get, %lu keys", n );
+    bench_report( name, n * GET_ROUNDS, bench_now(  ) - start );
+
+    start = bench_now(  );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        if ( !nilp( hashmap_get( map, absent[i], false ) ) ) {
+            failures++;
+        }
+    }
+    snprintf( name, sizeof( name ), "get absent, %lu keys", n );
+    bench_report( name, n, bench_now(  ) - start );
+
+    printf( "%-36s %12u slots\n", "",
+            pointer_to_vso( map )->payload.hashmap.n_slots );
+
+    dec_ref( map );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        dec_ref( keys[i] );
+        dec_ref( absent[i] );
+    }
+    free( keys );
+    free( absent );
+
+    return failures;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t failures = 0;
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    if ( argc > 1 ) {
+        for ( int i = 1; i < argc; i++ ) {
+            failures += time_map( bench_arg( argc, argv, i, 10000 ) );
+        }
+    } else {
+        for ( uint64_t n = 1000; n <= 100000; n *= 10 ) {
+            failures += time_map( n );
+        }
+    }
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu keys not found\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * heap-scan.c
+ *
+ * Measure the cost of the operations which look at the tags of many
+ * cells: walking the whole of cons space to find the cells in use, as the
+ * collectors and `dump_pages` do, and dispatching on the types of a great
+ * many objects, as `eval` and `print` do. The heap is filled with a mix of
+ * types, and then a random three quarters of the cells are freed, so that
+ * the walks must pass over free cells.
+ *
+ * usage: heap-scan [CELLS [PASSES]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * A cheap, deterministic pseudo-random number generator, so that runs
+ * are comparable.
+ */
+static uint64_t bench_random_state = 88172645463325252ULL;
+
+static uint64_t bench_random(  ) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+
+    return bench_random_state;
+}
+
+static const uint32_t mixed_tags[] = {
+    CONSTV, INTEGERTV, RATIOTV, STRINGTV, SYMBOLTV, CONSTV, KEYTV, CONSTV
+};
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 1000000 );
+    uint64_t passes = bench_arg( argc, argv, 2, 20 );
+    struct cons_pointer *cells = calloc( n, sizeof( struct cons_pointer ) );
+    uint64_t live = 0;
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        cells[i] = allocate_cell( mixed_tags[i % 8] );
+    }
+    for ( uint64_t i = 0; i < n; i++ ) {
+        if ( bench_random(  ) % 4 != 0 ) {
+            dec_ref( cells[i] );
+        } else {
+            cells[live++] = cells[i];
+        }
+    }
+
+    /* walk the heap cell by cell, checking whether each is free */
+    uint64_t found = 0;
+    uint64_t scanned = 0;
+    uint64_t start = bench_now(  );
+    for ( uint64_t pass = 0; pass < passes; pass++ ) {
+        for ( uint32_t p = 0; p < initialised_cons_pages; p++ ) {
+            for ( uint32_t o = 0; o < conspages[p]->high_water; o++ ) {
+                struct cons_pointer pointer = { p, o };
+
+                scanned++;
+                if ( !freep( pointer ) ) {
+                    found++;
+                }
+            }
+        }
+    }
+    bench_report( "heap walk, cell by cell", scanned, bench_now(  ) - start );
+
+    /* walk the heap, skipping free cells */
+    uint64_t skipped = 0;
+    start = bench_now(  );
+    for ( uint64_t pass = 0; pass < passes; pass++ ) {
+        for ( uint32_t p = 0; p < initialised_cons_pages; p++ ) {
+            for ( uint32_t o = next_cell_in_use( p, 0 );
+                  o < conspages[p]->high_water;
+                  o = next_cell_in_use( p, o + 1 ) ) {
+                skipped++;
+            }
+        }
+    }
+    bench_report( "heap walk, skipping free cells", scanned,
+                  bench_now(  ) - start );
+
+    /* dispatch on the types of the live objects */
+    uint64_t conses = 0;
+    uint64_t numbers = 0;
+    uint64_t strings = 0;
+    start = bench_now(  );
+    for ( uint64_t pass = 0; pass < passes; pass++ ) {
+        for ( uint64_t i = 0; i < live; i++ ) {
+            switch ( get_tag_value( cells[i] ) ) {
+                case CONSTV:
+                    conses++;
+                    break;
+                case INTEGERTV:
+                case RATIOTV:
+                    numbers++;
+                    break;
+                case STRINGTV:
+                case SYMBOLTV:
+                case KEYTV:
+                    strings++;
+                    break;
+            }
+        }
+    }
+    bench_report( "type dispatch", live * passes, bench_now(  ) - start );
+
+    /* NIL and T are in use, too, but were not in `cells` */
+    if ( found != skipped || conses + numbers + strings != live * passes ) {
+        fprintf( stderr, "Inconsistent counts: %llu, %llu, %llu\n",
+                 ( unsigned long long ) found,
+                 ( unsigned long long ) skipped,
+                 ( unsigned long long ) ( conses + numbers + strings ) );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * list-walk.c
+ *
+ * Measure how fast we can walk long lists which have been built after
+ * heavy churn in cons space, which is to say after a great many cells
+ * have been allocated and then freed in an order unrelated to the order
+ * in which they were allocated. How well the allocator then keeps the
+ * cells of a newly built list close together shows up in the walk time.
+ *
+ * usage: list-walk [CELLS [LISTS [WALKS]]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * A cheap, deterministic pseudo-random number generator, so that runs
+ * are comparable.
+ */
+static uint64_t bench_random_state = 88172645463325252ULL;
+
+static uint64_t bench_random(  ) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+
+    return bench_random_state;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 1000000 );
+    uint64_t n_lists = bench_arg( argc, argv, 2, 4 );
+    uint64_t walks = bench_arg( argc, argv, 3, 10 );
+    uint64_t length = n / n_lists;
+    struct cons_pointer *cells = calloc( n, sizeof( struct cons_pointer ) );
+    struct cons_pointer *lists =
+        calloc( n_lists, sizeof( struct cons_pointer ) );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    /* churn: allocate every cell, then free them all in random order */
+    for ( uint64_t i = 0; i < n; i++ ) {
+        cells[i] = allocate_cell( CONSTV );
+    }
+    for ( uint64_t i = n - 1; i > 0; i-- ) {
+        uint64_t j = bench_random(  ) % ( i + 1 );
+        struct cons_pointer swap = cells[i];
+        cells[i] = cells[j];
+        cells[j] = swap;
+    }
+    for ( uint64_t i = 0; i < n; i++ ) {
+        dec_ref( cells[i] );
+    }
+
+    /* build the lists, interleaving their construction */
+    uint64_t start = bench_now(  );
+    for ( uint64_t i = 0; i < length; i++ ) {
+        for ( uint64_t l = 0; l < n_lists; l++ ) {
+            struct cons_pointer cell = allocate_cell( CONSTV );
+            pointer2cell( cell ).payload.cons.cdr = lists[l];
+            lists[l] = cell;
+        }
+    }
+    bench_report( "build lists after churn", length * n_lists,
+                  bench_now(  ) - start );
+
+    /* walk them */
+    uint64_t visited = 0;
+    start = bench_now(  );
+    for ( uint64_t w = 0; w < walks; w++ ) {
+        for ( uint64_t l = 0; l < n_lists; l++ ) {
+            for ( struct cons_pointer p = lists[l]; !nilp( p );
+                  p = pointer2cell( p ).payload.cons.cdr ) {
+                visited++;
+            }
+        }
+    }
+    bench_report( "walk lists after churn", visited, bench_now(  ) - start );
+
+    free( cells );
+    free( lists );
+
+    return 0;
+}
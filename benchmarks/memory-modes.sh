@@ -0,0 +1,48 @@
+#!/bin/bash
+
+# Head to head comparison of reference counting with mark-sweep collection
+# (the -M option), both of the whole heap only (-n 0) and with collections
+# of the nursery between them, on the workloads in the lisp directory. Each workload is
+# repeated to make its run time dominate start up, and each is run several
+# times under each mode, reporting the best wall clock time.
+
+# (c) 2017 Simon Brooke <simon@journeyman.cc>
+# Licensed under GPL version 2.0, or, at your option, any later version.
+
+repeats=${REPEATS:-20}
+runs=${RUNS:-3}
+workload=`mktemp`
+
+best_time () {
+    best=''
+    for run in `seq ${runs}`
+    do
+        start=`date +%s%N`
+        target/psse "$@" < ${workload} > /dev/null 2>&1
+        end=`date +%s%N`
+        elapsed=$(( ( end - start ) / 1000000 ))
+        if [ -z "${best}" ] || [ ${elapsed} -lt ${best} ]
+        then
+            best=${elapsed}
+        fi
+    done
+    echo ${best}
+}
+
+printf "%-24s %12s %12s %12s\n" "workload" "refcount ms" "marksweep ms" \
+       "nursery ms"
+
+for file in lisp/documentation.lisp lisp/expt.lisp lisp/fact.lisp \
+            lisp/member.lisp lisp/nth.lisp lisp/types.lisp
+do
+    > ${workload}
+    for i in `seq ${repeats}`
+    do
+        cat ${file} >> ${workload}
+    done
+
+    printf "%-24s %12s %12s %12s\n" ${file} `best_time` `best_time -M -n 0` \
+           `best_time -M`
+done
+
+rm -f ${workload}
@@ -0,0 +1,127 @@
+/*
+ * primitive-call.c
+ *
+ * Measure the cost of evaluating a call of a primitive function on a few
+ * arguments: `(eq? 1 1)`, `(+ 1 2)` and `(car '(1 2))`; and on many, more
+ * than fit in a stack frame of the usual size: `(+ 1 2 ... 15)` and
+ * `(list 1 2 ... 15)`. The arguments are
+ * self-evaluating small integers, which come locked from the cache as the
+ * reader's do, save that of `car`, which is quoted; so that very little
+ * but the machinery of the call itself is measured. The function
+ * cells are put directly in the function position of each form, so that
+ * no environment is needed.
+ *
+ * usage: primitive-call [CALLS]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "arith/integer.h"
+#include "arith/peano.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/stack.h"
+#include "ops/lispops.h"
+
+/**
+ * @return a form applying this `fn` to these two arguments, `a` and `b`.
+ */
+static struct cons_pointer make_form( struct cons_pointer fn,
+                                      struct cons_pointer a,
+                                      struct cons_pointer b ) {
+    struct cons_pointer tail = nilp( b ) ? NIL : make_cons( b, NIL );
+    struct cons_pointer result = make_cons( fn, make_cons( a, tail ) );
+
+    return result;
+}
+
+/**
+ * @return a form applying this `fn` to the integers from 1 to `n`.
+ */
+static struct cons_pointer make_wide_form( struct cons_pointer fn, int n ) {
+    struct cons_pointer args = NIL;
+
+    for ( int i = n; i > 0; i-- ) {
+        args = make_cons( acquire_integer( i, NIL ), args );
+    }
+
+    return make_cons( fn, args );
+}
+
+/**
+ * Evaluate this `form` `n` times in this `frame`, and report how long it
+ * took under this `name`.
+ *
+ * @return the number of evaluations which returned an exception.
+ */
+static uint64_t time_calls( const char *name, struct cons_pointer form,
+                            struct cons_pointer frame_pointer, uint64_t n ) {
+    struct stack_frame *frame = get_stack_frame( frame_pointer );
+    uint64_t failures = 0;
+    uint64_t start = bench_now(  );
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        struct cons_pointer result =
+            eval_form( frame, frame_pointer, form, NIL );
+
+        /* the result is not dropped, as the REPL does not drop it: it
+         * may be a reference which the call does not own, such as one of
+         * the arguments */
+        if ( exceptionp( result ) ) {
+            failures++;
+        }
+    }
+    bench_report( name, n, bench_now(  ) - start );
+
+    return failures;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 1000000 );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    struct cons_pointer frame_pointer = make_empty_frame( NIL );
+    struct cons_pointer one = acquire_integer( 1, NIL );
+    struct cons_pointer two = acquire_integer( 2, NIL );
+    struct cons_pointer quote = make_special( NIL, &lisp_quote );
+    struct cons_pointer list = make_cons( one, make_cons( two, NIL ) );
+    uint64_t failures = 0;
+
+    failures +=
+        time_calls( "(eq? 1 1)",
+                    make_form( make_function( NIL, &lisp_eq ), one, one ),
+                    frame_pointer, n );
+    failures +=
+        time_calls( "(+ 1 2)",
+                    make_form( make_function( NIL, &lisp_add ), one, two ),
+                    frame_pointer, n );
+    failures +=
+        time_calls( "(car '(1 2))",
+                    make_form( make_function( NIL, &lisp_car ),
+                               make_form( quote, list, NIL ), NIL ),
+                    frame_pointer, n );
+    failures +=
+        time_calls( "(+ 1 2 ... 15)",
+                    make_wide_form( make_function( NIL, &lisp_add ), 15 ),
+                    frame_pointer, n );
+    failures +=
+        time_calls( "(list 1 2 ... 15)",
+                    make_wide_form( make_function( NIL, &lisp_list ), 15 ),
+                    frame_pointer, n );
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu calls failed\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
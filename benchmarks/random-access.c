@@ -0,0 +1,119 @@
+/*
+ * random-access.c
+ *
+ * Measure the cost of `(nth n sequence)` at random indices into a list and
+ * into a vector of the same elements: the list must be walked to the
+ * element wanted, whereas the vector's is got at directly, so the cost of
+ * the one should grow with the length of the sequence and of the other
+ * should not. The function cell of `nth` is put directly in the function
+ * position of each form, so that no environment is needed.
+ *
+ * usage: random-access [CALLS [LENGTH]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "arith/integer.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/stack.h"
+#include "memory/vector.h"
+#include "ops/lispops.h"
+
+/**
+ * The number of distinct forms, each with its own index, cycled through.
+ */
+#define N_FORMS 64
+
+/**
+ * A cheap, deterministic pseudo-random number generator, so that runs
+ * are comparable.
+ */
+static uint64_t bench_random_state = 88172645463325252ULL;
+
+static uint64_t bench_random(  ) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+
+    return bench_random_state;
+}
+
+/**
+ * Evaluate each of these `forms` in turn, `n` times in all, in this
+ * `frame`, and report how long it took under this `name`.
+ *
+ * @return the number of evaluations which returned an exception.
+ */
+static uint64_t time_calls( const char *name, struct cons_pointer *forms,
+                            struct cons_pointer frame_pointer, uint64_t n ) {
+    struct stack_frame *frame = get_stack_frame( frame_pointer );
+    uint64_t failures = 0;
+    uint64_t start = bench_now(  );
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        if ( exceptionp( eval_form( frame, frame_pointer,
+                                    forms[i % N_FORMS], NIL ) ) ) {
+            failures++;
+        }
+    }
+    bench_report( name, n, bench_now(  ) - start );
+
+    return failures;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 100000 );
+    uint64_t length = bench_arg( argc, argv, 2, 1000 );
+    struct cons_pointer list_forms[N_FORMS];
+    struct cons_pointer vector_forms[N_FORMS];
+    char name[64];
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    struct cons_pointer frame_pointer = make_empty_frame( NIL );
+    struct cons_pointer nth = make_function( NIL, &lisp_nth );
+    struct cons_pointer quote = make_special( NIL, &lisp_quote );
+    struct cons_pointer list = NIL;
+    uint64_t failures = 0;
+
+    for ( uint64_t i = length; i > 0; i-- ) {
+        list = make_cons( acquire_integer( i, NIL ), list );
+    }
+    struct cons_pointer vector = list_to_vector( list );
+    struct cons_pointer quoted = make_cons( quote, make_cons( list, NIL ) );
+
+    for ( int i = 0; i < N_FORMS; i++ ) {
+        struct cons_pointer index =
+            acquire_integer( 1 + bench_random(  ) % length, NIL );
+
+        list_forms[i] = make_cons( nth, make_cons( index,
+                                                   make_cons( quoted,
+                                                              NIL ) ) );
+        vector_forms[i] = make_cons( nth, make_cons( index,
+                                                     make_cons( vector,
+                                                                NIL ) ) );
+    }
+
+    snprintf( name, sizeof( name ), "nth of list of %llu",
+              ( unsigned long long ) length );
+    failures += time_calls( name, list_forms, frame_pointer, n );
+    snprintf( name, sizeof( name ), "nth of vector of %llu",
+              ( unsigned long long ) length );
+    failures += time_calls( name, vector_forms, frame_pointer, n );
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu calls failed\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * reclaim.c
+ *
+ * Measure the cost of dropping the last reference to a long list, both
+ * reclaiming it all at once, and reclaiming it incrementally, a few cells
+ * on each subsequent allocation.
+ *
+ * usage: reclaim [LENGTH [BUDGET]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * @return a list of `n` conses, built so that every cell in it has a
+ * reference count of exactly one.
+ */
+struct cons_pointer make_long_list( uint64_t n ) {
+    struct cons_pointer result = NIL;
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        struct cons_pointer next = make_cons( NIL, result );
+        dec_ref( result );
+        result = next;
+    }
+
+    return result;
+}
+
+void report_pauses( const char *name ) {
+    struct reclamation_stats stats = get_reclamation_stats(  );
+
+    printf( "%-36s %12llu pauses; longest %llu ns; longest work list %llu\n",
+            name, ( unsigned long long ) stats.pauses,
+            ( unsigned long long ) stats.max_pause_ns,
+            ( unsigned long long ) stats.max_pending );
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t n = bench_arg( argc, argv, 1, 10000000 );
+    uint64_t budget = bench_arg( argc, argv, 2, 64 );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    struct cons_pointer list = make_long_list( n );
+    reset_reclamation_stats(  );
+    uint64_t start = bench_now(  );
+    dec_ref( list );
+    bench_report( "drop long list at once", n, bench_now(  ) - start );
+    report_pauses( "  pauses" );
+
+    reclamation_budget = budget;
+    list = make_long_list( n );
+    reset_reclamation_stats(  );
+    start = bench_now(  );
+    dec_ref( list );
+    for ( uint64_t i = 0; i < n; i++ ) {
+        dec_ref( allocate_cell( CONSTV ) );
+    }
+    bench_report( "drop long list incrementally", n,
+                  bench_now(  ) - start );
+    report_pauses( "  pauses" );
+
+    reclaim_pending_cells( 0 );
+    summarise_allocation(  );
+
+    return 0;
+}
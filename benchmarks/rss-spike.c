@@ -0,0 +1,113 @@
+/*
+ * rss-spike.c
+ *
+ * Measure resident set size over time through a spiky workload: a small
+ * steady working set, interrupted now and then by a large transient
+ * structure which is built and then dropped. Run first keeping every
+ * empty cons page resident, as before pages could be released, and then
+ * returning empty pages to the operating system.
+ *
+ * usage: rss-spike [SPIKE-CELLS [SPIKES [STEADY-CELLS]]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * @return the resident set size of this process, in kilobytes.
+ */
+uint64_t rss_kb(  ) {
+    unsigned long long size = 0, resident = 0;
+    FILE *statm = fopen( "/proc/self/statm", "r" );
+
+    if ( statm != NULL ) {
+        if ( fscanf( statm, "%llu %llu", &size, &resident ) != 2 ) {
+            resident = 0;
+        }
+        fclose( statm );
+    }
+
+    return resident * ( uint64_t ) sysconf( _SC_PAGESIZE ) / 1024;
+}
+
+/**
+ * @return a list of `n` conses, built so that every cell in it has a
+ * reference count of exactly one.
+ */
+struct cons_pointer make_long_list( uint64_t n ) {
+    struct cons_pointer result = NIL;
+
+    for ( uint64_t i = 0; i < n; i++ ) {
+        struct cons_pointer next = make_cons( NIL, result );
+        dec_ref( result );
+        result = next;
+    }
+
+    return result;
+}
+
+void report_rss( const char *mode, uint64_t start, const char *phase ) {
+    printf( "%-12s %10.3f ms  %-20s %10llu KB\n", mode,
+            ( bench_now(  ) - start ) / 1e6, phase,
+            ( unsigned long long ) rss_kb(  ) );
+}
+
+/**
+ * Run the spiky workload, releasing empty pages (subject to the current
+ * value of `cons_pages_retained`) between phases, as the REPL does
+ * between top level forms.
+ */
+void run( const char *mode, uint64_t spike, uint64_t spikes,
+          uint64_t steady ) {
+    uint64_t start = bench_now(  );
+    struct cons_pointer working_set = make_long_list( steady );
+
+    release_empty_cons_pages(  );
+    report_rss( mode, start, "steady" );
+
+    for ( uint64_t i = 0; i < spikes; i++ ) {
+        struct cons_pointer transient = make_long_list( spike );
+
+        release_empty_cons_pages(  );
+        report_rss( mode, start, "spike" );
+
+        dec_ref( transient );
+        release_empty_cons_pages(  );
+        report_rss( mode, start, "after spike" );
+
+        dec_ref( working_set );
+        working_set = make_long_list( steady );
+        release_empty_cons_pages(  );
+        report_rss( mode, start, "steady" );
+    }
+
+    dec_ref( working_set );
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t spike = bench_arg( argc, argv, 1, 4000000 );
+    uint64_t spikes = bench_arg( argc, argv, 2, 3 );
+    uint64_t steady = bench_arg( argc, argv, 3, 100000 );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    cons_pages_retained = UINT32_MAX;
+    run( "retain all", spike, spikes, steady );
+
+    cons_pages_retained = DFLT_CONS_PAGES_RETAINED;
+    run( "release", spike, spikes, steady );
+
+    summarise_allocation(  );
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * string-pack.c
+ *
+ * Measure the cost of a long string, such as `slurp` makes of a file,
+ * held as a packed string, against that of the same characters held one
+ * to a cell, as `slurp` used to make them: the time taken to make each,
+ * the memory each occupies, and the time taken by `equal` on two of each.
+ * Packed strings are made by `slurp` itself, from a file written for the
+ * purpose; cell strings by `make_string`, as `slurp` did.
+ *
+ * usage: string-pack [LENGTH [REPEATS]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include "bench.h"
+#include "io/io.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/pstring.h"
+#include "memory/stack.h"
+#include "ops/equal.h"
+#include "ops/lispops.h"
+
+/**
+ * @return a cell string of these `length` `characters`, made one cell at a
+ * time from the front, as `slurp` used to make it.
+ */
+static struct cons_pointer make_cell_string( const wchar_t *characters,
+                                             uint64_t length ) {
+    struct cons_pointer result = make_string( characters[0], NIL );
+    struct cons_pointer cursor = result;
+
+    for ( uint64_t i = 1; i < length; i++ ) {
+        struct cons_space_object *cell = &pointer2cell( cursor );
+
+        cursor = make_string( characters[i], NIL );
+        cell->payload.string.cdr = cursor;
+    }
+
+    return result;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t length = bench_arg( argc, argv, 1, 1000000 );
+    uint64_t repeats = bench_arg( argc, argv, 2, 3 );
+    wchar_t *characters = calloc( length, sizeof( wchar_t ) );
+    char path[] = "/tmp/string-pack-XXXXXX";
+    int fd = mkstemp( path );
+    FILE *file = fdopen( fd, "w" );
+    uint64_t failures = 0;
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        characters[i] = ( i % 64 == 63 ) ? L'\n' : L'a' + ( i % 26 );
+        fputc( ( int ) characters[i], file );
+    }
+    fclose( file );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    struct cons_pointer frame_pointer = make_empty_frame( NIL );
+    struct stack_frame *frame = get_stack_frame( frame_pointer );
+    struct cons_pointer slurp = make_function( NIL, &lisp_slurp );
+    struct cons_pointer open = make_function( NIL, &lisp_open );
+    wchar_t wide_path[sizeof( path )];
+
+    mbstowcs( wide_path, path, sizeof( path ) );
+
+    struct cons_pointer form =
+        make_cons( slurp,
+                   make_cons( make_cons( open,
+                                         make_cons( c_string_to_lisp_string
+                                                    ( wide_path ), NIL ) ),
+                              NIL ) );
+    struct cons_pointer packed[2] = { NIL, NIL };
+    struct cons_pointer cells[2] = { NIL, NIL };
+
+    uint64_t start = bench_now(  );
+    for ( uint64_t r = 0; r < repeats; r++ ) {
+        dec_ref( packed[r % 2] );
+        packed[r % 2] = eval_form( frame, frame_pointer, form, NIL );
+    }
+    bench_report( "slurp to packed string", length * repeats,
+                  bench_now(  ) - start );
+    if ( repeats < 2 ) {
+        packed[1] = eval_form( frame, frame_pointer, form, NIL );
+    }
+
+    start = bench_now(  );
+    for ( uint64_t r = 0; r < repeats; r++ ) {
+        dec_ref( cells[r % 2] );
+        cells[r % 2] = make_cell_string( characters, length );
+    }
+    bench_report( "make cell string", length * repeats,
+                  bench_now(  ) - start );
+    if ( repeats < 2 ) {
+        cells[1] = make_cell_string( characters, length );
+    }
+
+    printf( "%-36s %12llu bytes in %llu allocation\n", "packed string",
+            ( unsigned long long ) ( sizeof( struct vector_space_header ) +
+                                     sizeof( struct pstring_payload ) +
+                                     length * sizeof( wchar_t ) ),
+            1ULL );
+    printf( "%-36s %12llu bytes in %llu allocations\n", "cell string",
+            ( unsigned long long ) ( length *
+                                     sizeof( struct cons_space_object ) ),
+            ( unsigned long long ) length );
+
+    start = bench_now(  );
+    for ( uint64_t r = 0; r < repeats; r++ ) {
+        failures += equal( packed[0], packed[1] ) ? 0 : 1;
+    }
+    bench_report( "equal on packed strings", length * repeats,
+                  bench_now(  ) - start );
+
+    start = bench_now(  );
+    for ( uint64_t r = 0; r < repeats; r++ ) {
+        failures += equal( cells[0], cells[1] ) ? 0 : 1;
+    }
+    bench_report( "equal on cell strings", length * repeats,
+                  bench_now(  ) - start );
+
+    if ( pstring_length( packed[0] ) != length ) {
+        failures++;
+    }
+
+    unlink( path );
+    free( characters );
+
+    if ( failures != 0 ) {
+        fprintf( stdout, "%llu comparisons failed\n",
+                 ( unsigned long long ) failures );
+        return 1;
+    }
+
+    return 0;
+}
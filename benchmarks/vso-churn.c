@@ -0,0 +1,112 @@
+/*
+ * vso-churn.c
+ *
+ * Measure the cost of making and freeing vector space objects: first of
+ * stack frames, one at a time, as every function call makes and drops one;
+ * then of a working set of hashmaps of assorted sizes, replaced at random,
+ * so that objects of many sizes are freed in no particular order. Resident
+ * set size is reported after each, and should not grow with the number of
+ * objects made.
+ *
+ * usage: vso-churn [FRAMES [MAPS [WORKING-SET]]]
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "io/fopen.h"
+#include "io/io.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/stack.h"
+#include "memory/vectorspace.h"
+#include "ops/intern.h"
+
+/**
+ * @return the resident set size of this process, in kilobytes.
+ */
+uint64_t rss_kb(  ) {
+    unsigned long long size = 0, resident = 0;
+    FILE *statm = fopen( "/proc/self/statm", "r" );
+
+    if ( statm != NULL ) {
+        if ( fscanf( statm, "%llu %llu", &size, &resident ) != 2 ) {
+            resident = 0;
+        }
+        fclose( statm );
+    }
+
+    return resident * ( uint64_t ) sysconf( _SC_PAGESIZE ) / 1024;
+}
+
+/**
+ * A cheap, deterministic pseudo-random number generator, so that runs
+ * are comparable.
+ */
+static uint64_t bench_random_state = 88172645463325252ULL;
+
+static uint64_t bench_random(  ) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+
+    return bench_random_state;
+}
+
+int main( int argc, char *argv[] ) {
+    uint64_t frames = bench_arg( argc, argv, 1, 2000000 );
+    uint64_t maps = bench_arg( argc, argv, 2, 1000000 );
+    uint64_t working_set = bench_arg( argc, argv, 3, 1000 );
+    struct cons_pointer *live =
+        calloc( working_set, sizeof( struct cons_pointer ) );
+
+    setlocale( LC_ALL, "" );
+    initialise_cons_pages(  );
+
+    uint64_t before = rss_kb(  );
+    uint64_t start = bench_now(  );
+    for ( uint64_t i = 0; i < frames; i++ ) {
+        struct cons_pointer frame = make_empty_frame( NIL );
+
+        dec_ref( frame );
+        reclaim_pending_cells( 0 );
+    }
+    bench_report( "make and free stack frames", frames,
+                  bench_now(  ) - start );
+    printf( "%-36s %12lld kB\n", "growth in resident memory",
+            ( long long ) ( rss_kb(  ) - before ) );
+
+    for ( uint64_t i = 0; i < working_set; i++ ) {
+        live[i] = NIL;
+    }
+
+    before = rss_kb(  );
+    start = bench_now(  );
+    for ( uint64_t i = 0; i < maps; i++ ) {
+        uint64_t j = bench_random(  ) % working_set;
+
+        dec_ref( live[j] );
+        live[j] = make_hashmap( 1 + bench_random(  ) % 200, NIL, TRUE );
+        reclaim_pending_cells( 0 );
+    }
+    bench_report( "replace hashmaps at random", maps,
+                  bench_now(  ) - start );
+    printf( "%-36s %12lld kB\n", "growth in resident memory",
+            ( long long ) ( rss_kb(  ) - before ) );
+
+    for ( uint64_t i = 0; i < working_set; i++ ) {
+        dec_ref( live[i] );
+    }
+    reclaim_pending_cells( 0 );
+    free( live );
+
+    summarise_vector_space( file_to_url_file( stderr ) );
+
+    return 0;
+}
@@ -0,0 +1,946 @@
+/*
+ * array.c
+ *
+ * Arrays of integers and of reals, held unboxed in vector space, and the
+ * arithmetic on them. Addition, subtraction and multiplication of arrays
+ * are reached through `add_2`, `subtract_2` and `multiply_2` in peano.c,
+ * so that `+`, `-` and `*` work element by element on arrays, and between
+ * arrays and single numbers; reductions and comparisons have functions of
+ * their own.
+ *
+ * The inner loops are kernels written with SSE2 intrinsics, which every
+ * x86-64 processor has, so that two elements are dealt with at a time;
+ * each has a scalar loop too, which finishes off odd elements, and does
+ * the whole job where SSE2 is not available or `SCALAR_KERNELS` is defined.
+ * SSE2 has no instructions to multiply or compare 64 bit integers, so
+ * those are always scalar.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined( __SSE2__ ) && !defined( SCALAR_KERNELS )
+#define SSE2_KERNELS
+#include <emmintrin.h>
+#endif
+
+#include "arith/array.h"
+#include "arith/integer.h"
+#include "arith/peano.h"
+#include "arith/real.h"
+#include "io/io.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/vector.h"
+#include "memory/vectorspace.h"
+#include "ops/lispops.h"
+
+#ifdef SSE2_KERNELS
+/**
+ * The body of `real_kernel`, for one operation, which is `vector_op` on
+ * pairs of elements and `scalar_op` on single elements.
+ */
+#define REAL_KERNEL_LOOP(vector_op, scalar_op) {\
+    __m128d a0 = _mm_set1_pd( a[0] );\
+    __m128d b0 = _mm_set1_pd( b[0] );\
+    for ( ; i + 2 <= n; i += 2 ) {\
+        _mm_storeu_pd( r + i,\
+                       vector_op( a_step ? _mm_loadu_pd( a + i ) : a0,\
+                                  b_step ? _mm_loadu_pd( b + i ) : b0 ) );\
+    }\
+    for ( ; i < n; i++ ) {\
+        r[i] = a[i * a_step] scalar_op b[i * b_step];\
+    }\
+}
+
+/**
+ * The body of `integer_kernel`, for addition or subtraction, which is
+ * `vector_op` on pairs of elements and `scalar_op` on single elements.
+ * Whether each result is in range is seen from its top bits, which are
+ * gathered in `high_bits` rather than tested one by one.
+ */
+#define INTEGER_KERNEL_LOOP(vector_op, scalar_op) {\
+    __m128i a0 = _mm_set1_epi64x( a[0] );\
+    __m128i b0 = _mm_set1_epi64x( b[0] );\
+    __m128i offset = _mm_set1_epi64x( INTARRAY_OFFSET );\
+    __m128i high_bits = _mm_setzero_si128(  );\
+    for ( ; i + 2 <= n; i += 2 ) {\
+        __m128i vr =\
+            vector_op( a_step ?\
+                       _mm_loadu_si128( ( const __m128i * ) ( a + i ) ) : a0,\
+                       b_step ?\
+                       _mm_loadu_si128( ( const __m128i * ) ( b + i ) ) : b0 );\
+        _mm_storeu_si128( ( __m128i * ) ( r + i ), vr );\
+        high_bits = _mm_or_si128( high_bits,\
+                                  _mm_srli_epi64( _mm_add_epi64\
+                                                  ( vr, offset ), 61 ) );\
+    }\
+    out_of_range = _mm_cvtsi128_si64( high_bits ) |\
+        _mm_cvtsi128_si64( _mm_unpackhi_epi64( high_bits, high_bits ) );\
+    for ( ; i < n; i++ ) {\
+        r[i] = a[i * a_step] scalar_op b[i * b_step];\
+        out_of_range |= !intarray_in_range( r[i] );\
+    }\
+}
+#else
+#define REAL_KERNEL_LOOP(vector_op, scalar_op) {\
+    for ( ; i < n; i++ ) {\
+        r[i] = a[i * a_step] scalar_op b[i * b_step];\
+    }\
+}
+
+#define INTEGER_KERNEL_LOOP(vector_op, scalar_op) {\
+    for ( ; i < n; i++ ) {\
+        r[i] = a[i * a_step] scalar_op b[i * b_step];\
+        out_of_range |= !intarray_in_range( r[i] );\
+    }\
+}
+#endif
+
+/**
+ * Apply this `op`, which is one of `+`, `-` or `*`, to the elements of `a`
+ * and `b` pairwise, putting the results in `r`, all of length `n`. Where
+ * `a_step` or `b_step` is zero, the first element of that operand stands
+ * for every element. `r` may be the same as `a` or `b`.
+ */
+static void real_kernel( wchar_t op, const double *a, int a_step,
+                         const double *b, int b_step, double *r,
+                         uint64_t n ) {
+    uint64_t i = 0;
+
+    switch ( op ) {
+        case L'+':
+            REAL_KERNEL_LOOP( _mm_add_pd, + );
+            break;
+        case L'-':
+            REAL_KERNEL_LOOP( _mm_sub_pd, - );
+            break;
+        default:
+            REAL_KERNEL_LOOP( _mm_mul_pd, * );
+            break;
+    }
+}
+
+/**
+ * As `real_kernel`, q.v., but on integers.
+ *
+ * @return true if every result is in the range an integer array may hold,
+ * else false.
+ */
+static bool integer_kernel( wchar_t op, const int64_t *a, int a_step,
+                            const int64_t *b, int b_step, int64_t *r,
+                            uint64_t n ) {
+    uint64_t out_of_range = 0;
+    uint64_t i = 0;
+
+    switch ( op ) {
+        case L'+':
+            INTEGER_KERNEL_LOOP( _mm_add_epi64, + );
+            break;
+        case L'-':
+            INTEGER_KERNEL_LOOP( _mm_sub_epi64, - );
+            break;
+        default:
+            /* SSE2 cannot multiply 64 bit integers */
+            for ( ; i < n; i++ ) {
+                int64_t v;
+
+                if ( __builtin_mul_overflow( a[i * a_step], b[i * b_step],
+                                             &v )
+                     || !intarray_in_range( v ) ) {
+                    out_of_range = 1;
+                }
+                r[i] = v;
+            }
+            break;
+    }
+
+    return out_of_range == 0;
+}
+
+/**
+ * Compare each element of `a` with the element of `b` at the same index,
+ * or, if `b_step` is zero, with the first element of `b`, putting 1 in
+ * `r` where the comparison `op`, one of `<`, `=` or `>`, holds, else 0.
+ */
+static void real_compare_kernel( wchar_t op, const double *a,
+                                 const double *b, int b_step, int64_t *r,
+                                 uint64_t n ) {
+    uint64_t i = 0;
+
+#ifdef SSE2_KERNELS
+    __m128d b0 = _mm_set1_pd( b[0] );
+    __m128i one = _mm_set1_epi64x( 1 );
+
+    for ( ; i + 2 <= n; i += 2 ) {
+        __m128d va = _mm_loadu_pd( a + i );
+        __m128d vb = b_step ? _mm_loadu_pd( b + i ) : b0;
+        __m128d mask = op == L'<' ? _mm_cmplt_pd( va, vb ) :
+            op == L'=' ? _mm_cmpeq_pd( va, vb ) : _mm_cmpgt_pd( va, vb );
+
+        _mm_storeu_si128( ( __m128i * ) ( r + i ),
+                          _mm_and_si128( _mm_castpd_si128( mask ), one ) );
+    }
+#endif
+
+    for ( ; i < n; i++ ) {
+        double x = a[i];
+        double y = b[i * b_step];
+
+        r[i] = op == L'<' ? x < y : op == L'=' ? x == y : x > y;
+    }
+}
+
+/**
+ * @return the sum of these `n` reals `a`.
+ */
+static double real_sum_kernel( const double *a, uint64_t n ) {
+    double result = 0;
+    uint64_t i = 0;
+
+#ifdef SSE2_KERNELS
+    __m128d sum = _mm_setzero_pd(  );
+    double lanes[2];
+
+    for ( ; i + 2 <= n; i += 2 ) {
+        sum = _mm_add_pd( sum, _mm_loadu_pd( a + i ) );
+    }
+    _mm_storeu_pd( lanes, sum );
+    result = lanes[0] + lanes[1];
+#endif
+
+    for ( ; i < n; i++ ) {
+        result += a[i];
+    }
+
+    return result;
+}
+
+/**
+ * @return the sum of the products of these `n` reals `a` and `b`, taken
+ * pairwise.
+ */
+static double real_dot_kernel( const double *a, const double *b,
+                               uint64_t n ) {
+    double result = 0;
+    uint64_t i = 0;
+
+#ifdef SSE2_KERNELS
+    __m128d sum = _mm_setzero_pd(  );
+    double lanes[2];
+
+    for ( ; i + 2 <= n; i += 2 ) {
+        sum = _mm_add_pd( sum, _mm_mul_pd( _mm_loadu_pd( a + i ),
+                                           _mm_loadu_pd( b + i ) ) );
+    }
+    _mm_storeu_pd( lanes, sum );
+    result = lanes[0] + lanes[1];
+#endif
+
+    for ( ; i < n; i++ ) {
+        result += a[i] * b[i];
+    }
+
+    return result;
+}
+
+/**
+ * @return the greatest, if `max` is true, else the least, of these `n`
+ * reals `a`, of which there must be at least one.
+ */
+static double real_extremum_kernel( const double *a, uint64_t n, bool max ) {
+    double result = a[0];
+    uint64_t i = 1;
+
+#ifdef SSE2_KERNELS
+    if ( n >= 2 ) {
+        __m128d best = _mm_loadu_pd( a );
+        double lanes[2];
+
+        for ( i = 2; i + 2 <= n; i += 2 ) {
+            __m128d va = _mm_loadu_pd( a + i );
+
+            best = max ? _mm_max_pd( best, va ) : _mm_min_pd( best, va );
+        }
+        _mm_storeu_pd( lanes, best );
+        result = ( max ? lanes[1] > lanes[0] : lanes[1] < lanes[0] ) ?
+            lanes[1] : lanes[0];
+    }
+#endif
+
+    for ( ; i < n; i++ ) {
+        if ( max ? a[i] > result : a[i] < result ) {
+            result = a[i];
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Make an array of this `tag` with room for `length` elements of this
+ * `element_size`, all zero.
+ *
+ * @return the array, or an exception if memory is exhausted.
+ */
+static struct cons_pointer make_numeric_array( uint32_t tag,
+                                               uint64_t length,
+                                               uint64_t element_size ) {
+    struct cons_pointer result =
+        make_vso( tag, sizeof( uint64_t ) + length * element_size );
+
+    if ( nilp( result ) ) {
+        result = make_exception( privileged_string_memory_exhausted, NIL );
+    } else {
+        /* the length is the first word of either payload */
+        pointer_to_vso( result )->payload.intarray.length = length;
+    }
+
+    return result;
+}
+
+/**
+ * Make an integer array of this `length`, all of whose elements are zero.
+ *
+ * @return the array, or an exception if memory is exhausted.
+ */
+struct cons_pointer make_intarray( uint64_t length ) {
+    return make_numeric_array( INTARRAYTV, length, sizeof( int64_t ) );
+}
+
+/**
+ * Make a real array of this `length`, all of whose elements are zero.
+ *
+ * @return the array, or an exception if memory is exhausted.
+ */
+struct cons_pointer make_realarray( uint64_t length ) {
+    return make_numeric_array( REALARRAYTV, length, sizeof( double ) );
+}
+
+/**
+ * @return the number of elements in the integer or real array indicated by
+ * this `pointer`, or zero if it is neither.
+ */
+uint64_t numeric_array_length( struct cons_pointer pointer ) {
+    return numeric_arrayp( pointer ) ?
+        pointer_to_vso( pointer )->payload.intarray.length : 0;
+}
+
+/**
+ * @return the element at this zero-based `index` of the integer or real
+ * array indicated by this `pointer`, as a number cell; or `NIL` if it is
+ * neither, or has no such element.
+ */
+struct cons_pointer numeric_array_get( struct cons_pointer pointer,
+                                       uint64_t index ) {
+    struct cons_pointer result = NIL;
+
+    if ( index < numeric_array_length( pointer ) ) {
+        struct vector_space_object *vso = pointer_to_vso( pointer );
+
+        result = intarrayp( pointer ) ?
+            acquire_integer( vso->payload.intarray.elements[index], NIL ) :
+            make_real( vso->payload.realarray.elements[index] );
+    }
+
+    return result;
+}
+
+/**
+ * @return the element at this zero-based `index` of this integer or real
+ * `array`, which must have one, as a real.
+ */
+static double element_as_real( struct cons_pointer array, uint64_t index ) {
+    struct vector_space_object *vso = pointer_to_vso( array );
+
+    return intarrayp( array ) ?
+        ( double ) vso->payload.intarray.elements[index] :
+        vso->payload.realarray.elements[index];
+}
+
+/**
+ * @return true if this `pointer` indicates an integer array, or an integer
+ * small enough to fit in a single cell.
+ */
+static bool integer_operandp( struct cons_pointer pointer ) {
+    return intarrayp( pointer ) || ( integerp( pointer ) &&
+                                     nilp( pointer2cell( pointer ).payload.
+                                           integer.more ) );
+}
+
+/**
+ * @return the elements of this `operand`, if it is an integer array; else,
+ * if it is an integer, a pointer to its value, put in `scalar`. In either
+ * case, set `step` to the distance from one element to the next.
+ */
+static const int64_t *integer_operand( struct cons_pointer operand,
+                                       int64_t *scalar, int *step ) {
+    const int64_t *result = scalar;
+
+    if ( intarrayp( operand ) ) {
+        result = pointer_to_vso( operand )->payload.intarray.elements;
+        *step = 1;
+    } else {
+        *scalar = pointer2cell( operand ).payload.integer.value;
+        *step = 0;
+    }
+
+    return result;
+}
+
+/**
+ * @return the elements of this `operand`, if it is a real array; if it is
+ * an integer array, its elements converted to reals in `scratch`, which
+ * has room for them; else, if it is a number, a pointer to its value, put
+ * in `scalar`. In each case, set `step` to the distance from one element
+ * to the next.
+ */
+static const double *real_operand( struct cons_pointer operand,
+                                   double *scratch, double *scalar,
+                                   int *step ) {
+    const double *result = scalar;
+
+    *step = 1;
+    if ( realarrayp( operand ) ) {
+        result = pointer_to_vso( operand )->payload.realarray.elements;
+    } else if ( intarrayp( operand ) ) {
+        uint64_t length = numeric_array_length( operand );
+
+        for ( uint64_t i = 0; i < length; i++ ) {
+            scratch[i] = element_as_real( operand, i );
+        }
+        result = scratch;
+    } else {
+        *scalar = ( double ) to_long_double( operand );
+        *step = 0;
+    }
+
+    return result;
+}
+
+/**
+ * Apply this `op`, one of `+`, `-` or `*`, to `arg1` and `arg2`, of which
+ * at least one is an array and the other is an array of the same length
+ * or a number, element by element. The result is an integer array if both
+ * are integer arrays or integers, else a real array.
+ *
+ * @return the resulting array, or an exception if either argument is not
+ * a number or numeric array, if both are arrays but of different lengths,
+ * or if an integer result is out of range.
+ */
+struct cons_pointer array_arithmetic( wchar_t op, struct cons_pointer arg1,
+                                      struct cons_pointer arg2,
+                                      struct cons_pointer frame_pointer ) {
+    struct cons_pointer result = NIL;
+    wchar_t name[] = { op, L'\0' };
+    uint64_t length = numeric_arrayp( arg1 ) ?
+        numeric_array_length( arg1 ) : numeric_array_length( arg2 );
+
+    if ( exceptionp( arg1 ) ) {
+        result = arg1;
+    } else if ( exceptionp( arg2 ) ) {
+        result = arg2;
+    } else if ( !( numberp( arg1 ) || numeric_arrayp( arg1 ) ) ||
+                !( numberp( arg2 ) || numeric_arrayp( arg2 ) ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( name ),
+                                  c_string_to_lisp_string
+                                  ( L"Cannot do arithmetic: not a number or numeric array" ),
+                                  frame_pointer );
+    } else if ( numeric_arrayp( arg1 ) && numeric_arrayp( arg2 ) &&
+                numeric_array_length( arg2 ) != length ) {
+        result = throw_exception( c_string_to_lisp_symbol( name ),
+                                  c_string_to_lisp_string
+                                  ( L"Cannot do arithmetic: arrays differ in length" ),
+                                  frame_pointer );
+    } else if ( integer_operandp( arg1 ) && integer_operandp( arg2 ) ) {
+        result = make_intarray( length );
+
+        if ( intarrayp( result ) ) {
+            int64_t scalar1, scalar2;
+            int step1, step2;
+            const int64_t *a = integer_operand( arg1, &scalar1, &step1 );
+            const int64_t *b = integer_operand( arg2, &scalar2, &step2 );
+
+            if ( !integer_kernel( op, a, step1, b, step2,
+                                  pointer_to_vso( result )->payload.
+                                  intarray.elements, length ) ) {
+                dec_ref( result );
+                result = throw_exception( c_string_to_lisp_symbol( name ),
+                                          c_string_to_lisp_string
+                                          ( L"Integer array overflow" ),
+                                          frame_pointer );
+            }
+        }
+    } else {
+        result = make_realarray( length );
+
+        if ( realarrayp( result ) ) {
+            double *r = pointer_to_vso( result )->payload.realarray.elements;
+            double scalar1, scalar2;
+            int step1, step2;
+            /* at most one argument is an integer array, so `r` is needed
+             * as scratch space for at most one */
+            const double *a = real_operand( arg1, r, &scalar1, &step1 );
+            const double *b = real_operand( arg2, r, &scalar2, &step2 );
+
+            real_kernel( op, a, step1, b, step2, r, length );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return true if these two arrays, `a` and `b`, are of the same type and
+ * length, and have equal elements at each index, else false.
+ */
+bool equal_numeric_arrays( struct cons_pointer a, struct cons_pointer b ) {
+    uint64_t length = numeric_array_length( a );
+    bool result = ( intarrayp( a ) == intarrayp( b ) ) &&
+        numeric_arrayp( b ) && length == numeric_array_length( b );
+
+    for ( uint64_t i = 0; result && i < length; i++ ) {
+        result = intarrayp( a ) ?
+            pointer_to_vso( a )->payload.intarray.elements[i] ==
+            pointer_to_vso( b )->payload.intarray.elements[i] :
+            element_as_real( a, i ) == element_as_real( b, i );
+    }
+
+    return result;
+}
+
+/**
+ * Print this integer or real `array` to this `output` stream, as `#i[1 2]`
+ * or `#r[1.5 2]` respectively.
+ */
+void print_numeric_array( URL_FILE *output, struct cons_pointer array ) {
+    uint64_t length = numeric_array_length( array );
+    struct vector_space_object *vso = pointer_to_vso( array );
+
+    url_fputws( intarrayp( array ) ? L"#i[" : L"#r[", output );
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        if ( i > 0 ) {
+            url_fputwc( L' ', output );
+        }
+        if ( intarrayp( array ) ) {
+            url_fwprintf( output, L"%ld",
+                          vso->payload.intarray.elements[i] );
+        } else {
+            url_fwprintf( output, L"%.15g",
+                          vso->payload.realarray.elements[i] );
+        }
+    }
+
+    url_fputwc( L']', output );
+}
+
+/**
+ * Make an integer array, if `integers` is true, else a real array, of the
+ * elements of this `sequence`, a list or vector of numbers.
+ *
+ * @return the array, or an exception if `sequence` is not a list or vector,
+ * or any of its elements is not a number, or, for an integer array, not
+ * an integer in range.
+ */
+static struct cons_pointer sequence_to_array( struct cons_pointer sequence,
+                                              bool integers,
+                                              struct cons_pointer
+                                              frame_pointer, wchar_t *name ) {
+    struct cons_pointer result = NIL;
+    bool in_vector = vectorp( sequence );
+
+    if ( !( in_vector || consp( sequence ) || nilp( sequence ) ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( name ),
+                                  c_string_to_lisp_string
+                                  ( L"Expected a list or vector of numbers" ),
+                                  frame_pointer );
+    } else {
+        uint64_t length = in_vector ? vector_length( sequence ) :
+            c_length( sequence );
+        struct cons_pointer cursor = sequence;
+
+        result = integers ? make_intarray( length ) :
+            make_realarray( length );
+
+        for ( uint64_t i = 0; i < length && !exceptionp( result ); i++ ) {
+            struct cons_pointer element = in_vector ?
+                vector_get( sequence, i ) : c_car( cursor );
+            struct vector_space_object *vso = pointer_to_vso( result );
+
+            if ( integers && integer_operandp( element ) &&
+                 !intarrayp( element ) ) {
+                vso->payload.intarray.elements[i] =
+                    pointer2cell( element ).payload.integer.value;
+            } else if ( !integers && numberp( element ) ) {
+                vso->payload.realarray.elements[i] =
+                    ( double ) to_long_double( element );
+            } else {
+                dec_ref( result );
+                result = throw_exception( c_string_to_lisp_symbol( name ),
+                                          c_string_to_lisp_string
+                                          ( integers ?
+                                            L"Elements of an integer array must be integers in range" :
+                                            L"Elements of a real array must be numbers" ),
+                                          frame_pointer );
+            }
+
+            cursor = in_vector ? cursor : c_cdr( cursor );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Function: return an integer array of the elements of a list or vector
+ * of integers.
+ *
+ * * (integer-array sequence)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return an integer array.
+ * @exception if any element of `sequence` is not an integer which would fit
+ * in a single cell.
+ */
+struct cons_pointer lisp_intarray( struct stack_frame *frame,
+                                   struct cons_pointer frame_pointer,
+                                   struct cons_pointer env ) {
+    return sequence_to_array( frame->arg[0], true, frame_pointer,
+                              L"integer-array" );
+}
+
+/**
+ * Function: return a real array of the elements of a list or vector of
+ * numbers.
+ *
+ * * (real-array sequence)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return a real array.
+ * @exception if any element of `sequence` is not a number.
+ */
+struct cons_pointer lisp_realarray( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env ) {
+    return sequence_to_array( frame->arg[0], false, frame_pointer,
+                              L"real-array" );
+}
+
+/**
+ * @return an exception, thrown from the function of this `name`, saying
+ * that its first argument is not a numeric array.
+ */
+static struct cons_pointer not_an_array( wchar_t *name,
+                                         struct cons_pointer frame_pointer ) {
+    return throw_exception( c_string_to_lisp_symbol( name ),
+                            c_string_to_lisp_string
+                            ( L"Expected an integer or real array" ),
+                            frame_pointer );
+}
+
+/**
+ * Function: return the sum of the elements of a numeric array.
+ *
+ * * (array-sum array)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return an integer, for an integer array, else a real.
+ * @exception if `array` is not a numeric array, or the sum of an integer
+ * array is too large.
+ */
+struct cons_pointer lisp_array_sum( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env ) {
+    struct cons_pointer array = frame->arg[0];
+    uint64_t length = numeric_array_length( array );
+    struct cons_pointer result = NIL;
+
+    if ( intarrayp( array ) ) {
+        int64_t *elements = pointer_to_vso( array )->payload.intarray.elements;
+        __int128_t sum = 0;
+
+        /* no element is more than 2^60, so this cannot overflow for any
+         * array there is room for */
+        for ( uint64_t i = 0; i < length; i++ ) {
+            sum += elements[i];
+        }
+
+        result = ( sum >= -( __int128_t ) INTARRAY_OFFSET && sum <= MAX_INTEGER ) ?
+            acquire_integer( ( int64_t ) sum, NIL ) :
+            throw_exception( c_string_to_lisp_symbol( L"array-sum" ),
+                             c_string_to_lisp_string
+                             ( L"Integer array overflow" ), frame_pointer );
+    } else if ( realarrayp( array ) ) {
+        result =
+            make_real( real_sum_kernel
+                       ( pointer_to_vso( array )->payload.realarray.elements,
+                         length ) );
+    } else {
+        result = not_an_array( L"array-sum", frame_pointer );
+    }
+
+    return result;
+}
+
+/**
+ * @return the greatest, if `max` is true, else the least, element of the
+ * numeric array which is the first argument in this `frame`, or `NIL` if
+ * it is empty; or an exception, thrown from the function of this `name`,
+ * if it is not a numeric array.
+ */
+static struct cons_pointer array_extremum( struct stack_frame *frame,
+                                           struct cons_pointer frame_pointer,
+                                           bool max, wchar_t *name ) {
+    struct cons_pointer array = frame->arg[0];
+    uint64_t length = numeric_array_length( array );
+    struct cons_pointer result = NIL;
+
+    if ( !numeric_arrayp( array ) ) {
+        result = not_an_array( name, frame_pointer );
+    } else if ( length > 0 && intarrayp( array ) ) {
+        int64_t *elements = pointer_to_vso( array )->payload.intarray.elements;
+        int64_t best = elements[0];
+
+        for ( uint64_t i = 1; i < length; i++ ) {
+            if ( max ? elements[i] > best : elements[i] < best ) {
+                best = elements[i];
+            }
+        }
+        result = acquire_integer( best, NIL );
+    } else if ( length > 0 ) {
+        result =
+            make_real( real_extremum_kernel
+                       ( pointer_to_vso( array )->payload.realarray.elements,
+                         length, max ) );
+    }
+
+    return result;
+}
+
+/**
+ * Function: return the least element of a numeric array.
+ *
+ * * (array-min array)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return the least element, or `nil` if `array` is empty.
+ * @exception if `array` is not a numeric array.
+ */
+struct cons_pointer lisp_array_min( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env ) {
+    return array_extremum( frame, frame_pointer, false, L"array-min" );
+}
+
+/**
+ * Function: return the greatest element of a numeric array.
+ *
+ * * (array-max array)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return the greatest element, or `nil` if `array` is empty.
+ * @exception if `array` is not a numeric array.
+ */
+struct cons_pointer lisp_array_max( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env ) {
+    return array_extremum( frame, frame_pointer, true, L"array-max" );
+}
+
+/**
+ * Function: return the dot product of two numeric arrays of the same
+ * length; that is, the sum of the products of their elements, pairwise.
+ *
+ * * (array-dot a b)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return an integer, if both are integer arrays, else a real.
+ * @exception if either is not a numeric array, they differ in length, or
+ * the dot product of integer arrays is too large.
+ */
+struct cons_pointer lisp_array_dot( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env ) {
+    struct cons_pointer a = frame->arg[0];
+    struct cons_pointer b = frame->arg[1];
+    uint64_t length = numeric_array_length( a );
+    struct cons_pointer result = NIL;
+
+    if ( !numeric_arrayp( a ) || !numeric_arrayp( b ) ) {
+        result = not_an_array( L"array-dot", frame_pointer );
+    } else if ( numeric_array_length( b ) != length ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"array-dot" ),
+                                  c_string_to_lisp_string
+                                  ( L"Arrays differ in length" ),
+                                  frame_pointer );
+    } else if ( intarrayp( a ) && intarrayp( b ) ) {
+        int64_t *ea = pointer_to_vso( a )->payload.intarray.elements;
+        int64_t *eb = pointer_to_vso( b )->payload.intarray.elements;
+        __int128_t sum = 0;
+        bool overflow = false;
+
+        for ( uint64_t i = 0; i < length && !overflow; i++ ) {
+            overflow = __builtin_add_overflow( sum, ( __int128_t ) ea[i] *
+                                               eb[i], &sum );
+        }
+
+        result = ( !overflow && sum >= -( __int128_t ) INTARRAY_OFFSET
+                   && sum <= MAX_INTEGER ) ?
+            acquire_integer( ( int64_t ) sum, NIL ) :
+            throw_exception( c_string_to_lisp_symbol( L"array-dot" ),
+                             c_string_to_lisp_string
+                             ( L"Integer array overflow" ), frame_pointer );
+    } else if ( realarrayp( a ) && realarrayp( b ) ) {
+        result =
+            make_real( real_dot_kernel
+                       ( pointer_to_vso( a )->payload.realarray.elements,
+                         pointer_to_vso( b )->payload.realarray.elements,
+                         length ) );
+    } else {
+        double sum = 0;
+
+        for ( uint64_t i = 0; i < length; i++ ) {
+            sum += element_as_real( a, i ) * element_as_real( b, i );
+        }
+        result = make_real( sum );
+    }
+
+    return result;
+}
+
+/**
+ * @return an integer array with 1 at each index where the comparison `op`,
+ * one of `<`, `=` or `>`, holds between the element of the numeric array
+ * which is the first argument in this `frame` and the second argument, or
+ * its element at the same index if it is an array of the same length; and
+ * 0 elsewhere. Or an exception, thrown from the function of this `name`,
+ * if the arguments are not such.
+ */
+static struct cons_pointer array_compare( wchar_t op,
+                                          struct stack_frame *frame,
+                                          struct cons_pointer frame_pointer,
+                                          wchar_t *name ) {
+    struct cons_pointer a = frame->arg[0];
+    struct cons_pointer b = frame->arg[1];
+    uint64_t length = numeric_array_length( a );
+    struct cons_pointer result = NIL;
+
+    if ( !numeric_arrayp( a ) ) {
+        result = not_an_array( name, frame_pointer );
+    } else if ( numeric_arrayp( b ) ? numeric_array_length( b ) != length :
+                !numberp( b ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( name ),
+                                  c_string_to_lisp_string
+                                  ( L"Expected an array of the same length, or a number" ),
+                                  frame_pointer );
+    } else {
+        result = make_intarray( length );
+
+        if ( intarrayp( result ) ) {
+            int64_t *r = pointer_to_vso( result )->payload.intarray.elements;
+
+            if ( realarrayp( a ) && ( realarrayp( b ) || !intarrayp( b ) ) ) {
+                double scalar;
+                int step;
+                const double *eb = real_operand( b, NULL, &scalar, &step );
+
+                real_compare_kernel( op, pointer_to_vso( a )->payload.
+                                     realarray.elements, eb, step, r,
+                                     length );
+            } else if ( intarrayp( a ) && integer_operandp( b ) ) {
+                int64_t *ea = pointer_to_vso( a )->payload.intarray.elements;
+                int64_t scalar;
+                int step;
+                const int64_t *eb = integer_operand( b, &scalar, &step );
+
+                for ( uint64_t i = 0; i < length; i++ ) {
+                    int64_t x = ea[i];
+                    int64_t y = eb[i * step];
+
+                    r[i] = op == L'<' ? x < y : op == L'=' ? x == y : x > y;
+                }
+            } else {
+                double scalar = numberp( b ) ?
+                    ( double ) to_long_double( b ) : 0;
+
+                for ( uint64_t i = 0; i < length; i++ ) {
+                    double x = element_as_real( a, i );
+                    double y = numberp( b ) ? scalar :
+                        element_as_real( b, i );
+
+                    r[i] = op == L'<' ? x < y : op == L'=' ? x == y : x > y;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Function: compare a numeric array, element by element, with another of
+ * the same length, or with a number.
+ *
+ * * (array< a b)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return an integer array of 1 where the element of `a` is less than
+ * that of `b`, or than `b`, and 0 elsewhere.
+ */
+struct cons_pointer lisp_array_less( struct stack_frame *frame,
+                                     struct cons_pointer frame_pointer,
+                                     struct cons_pointer env ) {
+    return array_compare( L'<', frame, frame_pointer, L"array<" );
+}
+
+/**
+ * Function: as `array<`, but 1 where the elements are equal.
+ *
+ * * (array= a b)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return an integer array of 1 and 0.
+ */
+struct cons_pointer lisp_array_equal( struct stack_frame *frame,
+                                      struct cons_pointer frame_pointer,
+                                      struct cons_pointer env ) {
+    return array_compare( L'=', frame, frame_pointer, L"array=" );
+}
+
+/**
+ * Function: as `array<`, but 1 where the element of `a` is the greater.
+ *
+ * * (array> a b)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return an integer array of 1 and 0.
+ */
+struct cons_pointer lisp_array_greater( struct stack_frame *frame,
+                                        struct cons_pointer frame_pointer,
+                                        struct cons_pointer env ) {
+    return array_compare( L'>', frame, frame_pointer, L"array>" );
+}
@@ -0,0 +1,93 @@
+/*
+ * array.h
+ *
+ * Arrays of integers and of reals, held unboxed in vector space, and the
+ * arithmetic on them.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_array_h
+#define __psse_array_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <wchar.h>
+
+#include "io/fopen.h"
+#include "memory/consspaceobject.h"
+#include "memory/vectorspace.h"
+
+/**
+ * The elements of an integer array are those which would fit in a single
+ * integer cell, give or take one at the negative end: that is, in 61 bits,
+ * two's complement. The sum or difference of any two of them therefore
+ * fits in 64 bits, and whether it is in range again may be seen from its
+ * top bits alone: a value `v` is in range if and only if
+ * `( v + INTARRAY_OFFSET ) >> 61` is zero, as an unsigned integer.
+ */
+#define INTARRAY_OFFSET (1ULL << 60)
+
+#define intarray_in_range(v)(((( uint64_t ) (v) + INTARRAY_OFFSET) >> 61) == 0)
+
+/**
+ * true if `conspoint` points to an integer array or a real array, else
+ * false.
+ */
+#define numeric_arrayp(conspoint)(intarrayp(conspoint)||realarrayp(conspoint))
+
+struct cons_pointer make_intarray( uint64_t length );
+
+struct cons_pointer make_realarray( uint64_t length );
+
+uint64_t numeric_array_length( struct cons_pointer pointer );
+
+struct cons_pointer numeric_array_get( struct cons_pointer pointer,
+                                       uint64_t index );
+
+struct cons_pointer array_arithmetic( wchar_t op, struct cons_pointer arg1,
+                                      struct cons_pointer arg2,
+                                      struct cons_pointer frame_pointer );
+
+bool equal_numeric_arrays( struct cons_pointer a, struct cons_pointer b );
+
+void print_numeric_array( URL_FILE * output, struct cons_pointer pointer );
+
+struct cons_pointer lisp_intarray( struct stack_frame *frame,
+                                   struct cons_pointer frame_pointer,
+                                   struct cons_pointer env );
+
+struct cons_pointer lisp_realarray( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env );
+
+struct cons_pointer lisp_array_sum( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env );
+
+struct cons_pointer lisp_array_min( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env );
+
+struct cons_pointer lisp_array_max( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env );
+
+struct cons_pointer lisp_array_dot( struct stack_frame *frame,
+                                    struct cons_pointer frame_pointer,
+                                    struct cons_pointer env );
+
+struct cons_pointer lisp_array_less( struct stack_frame *frame,
+                                     struct cons_pointer frame_pointer,
+                                     struct cons_pointer env );
+
+struct cons_pointer lisp_array_equal( struct stack_frame *frame,
+                                      struct cons_pointer frame_pointer,
+                                      struct cons_pointer env );
+
+struct cons_pointer lisp_array_greater( struct stack_frame *frame,
+                                        struct cons_pointer frame_pointer,
+                                        struct cons_pointer env );
+
+#endif
@@ -72,7 +72,7 @@ __int128_t cell_value( struct cons_pointer c, char op, bool is_first_cell ) {
     debug_printf( DEBUG_ARITH,
                   L"cell_value: raw value is %ld, is_first_cell = %s; '%4.4s'; returning ",
                   val, is_first_cell ? "true" : "false",
-                  pointer2cell( c ).tag.bytes );
+                  pointer2tag( c ).bytes );
     debug_print_128bit( result, DEBUG_ARITH );
     debug_println( DEBUG_ARITH );
 
@@ -99,9 +99,12 @@ struct cons_pointer make_integer( int64_t value, struct cons_pointer more ) {
 
     if ( integerp( more ) || nilp( more ) ) {
         result = allocate_cell( INTEGERTV );
-        struct cons_space_object *cell = &pointer2cell( result );
-        cell->payload.integer.value = value;
-        cell->payload.integer.more = more;
+
+        if ( !exceptionp( result ) ) {
+            struct cons_space_object *cell = &pointer2cell( result );
+            cell->payload.integer.value = value;
+            cell->payload.integer.more = more;
+        }
     }
 
     debug_print( L"make_integer: returning\n", DEBUG_ALLOC );
@@ -138,7 +141,8 @@ struct cons_pointer acquire_integer( int64_t value, struct cons_pointer more ) {
         if ( !small_int_cache_initialised ) {
             for ( int64_t i = 0; i < SMALL_INT_LIMIT; i++ ) {
                 small_int_cache[i] = make_integer( i, NIL );
-                pointer2cell( small_int_cache[i] ).count = MAXREFERENCE;  // lock it in so it can't be GC'd
+                /* lock it in so it can't be GC'd */
+                pointer2count( small_int_cache[i] ) = MAXREFERENCE;
             }
             small_int_cache_initialised = true;
             debug_print( L"small_int_cache initialised.\n", DEBUG_ALLOC );
@@ -18,6 +18,7 @@
 #include "memory/conspage.h"
 #include "debug.h"
 #include "ops/equal.h"
+#include "arith/array.h"
 #include "arith/integer.h"
 #include "ops/intern.h"
 #include "ops/lispops.h"
@@ -42,7 +43,7 @@ bool zerop( struct cons_pointer arg ) {
     bool result = false;
     struct cons_space_object cell = pointer2cell( arg );
 
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( arg ).value ) {
         case INTEGERTV:{
                 do {
                     debug_print( L"zerop: ", DEBUG_ARITH );
@@ -100,7 +101,7 @@ bool is_negative( struct cons_pointer arg ) {
     bool result = false;
     struct cons_space_object cell = pointer2cell( arg );
 
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( arg ).value ) {
         case INTEGERTV:
             result = cell.payload.integer.value < 0;
             break;
@@ -128,7 +129,7 @@ struct cons_pointer absolute( struct cons_pointer arg ) {
 
     if ( numberp( arg ) ) {
         if ( is_negative( arg ) ) {
-            switch ( cell.tag.value ) {
+            switch ( pointer2tag( arg ).value ) {
                 case INTEGERTV:
                     result =
                         make_integer( llabs( cell.payload.integer.value ),
@@ -166,7 +167,7 @@ long double to_long_double( struct cons_pointer arg ) {
     long double result = 0;
     struct cons_space_object cell = pointer2cell( arg );
 
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( arg ).value ) {
         case INTEGERTV:
             // obviously, this doesn't work for bignums
             result = ( long double ) cell.payload.integer.value;
@@ -217,7 +218,7 @@ long double to_long_double( struct cons_pointer arg ) {
 int64_t to_long_int( struct cons_pointer arg ) {
     int64_t result = 0;
     struct cons_space_object cell = pointer2cell( arg );
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( arg ).value ) {
         case INTEGERTV:
             /* \todo if (integerp(cell.payload.integer.more)) {
              *     throw an exception!
@@ -248,7 +249,10 @@ int64_t to_long_int( struct cons_pointer arg ) {
 struct cons_pointer lisp_absolute( struct stack_frame
                                    *frame, struct cons_pointer frame_pointer, struct
                                    cons_pointer env ) {
-    return absolute( frame->arg[0] );
+    struct cons_pointer result = absolute( frame->arg[0] );
+
+    /* a number which is not negative is its own absolute value */
+    return eq( result, frame->arg[0] ) ? inc_ref( result ) : result;
 }
 
 /**
@@ -260,8 +264,6 @@ struct cons_pointer add_2( struct stack_frame *frame,
                            struct cons_pointer arg1,
                            struct cons_pointer arg2 ) {
     struct cons_pointer result;
-    struct cons_space_object cell1 = pointer2cell( arg1 );
-    struct cons_space_object cell2 = pointer2cell( arg2 );
 
     debug_print( L"add_2( arg1 = ", DEBUG_ARITH );
     debug_dump_object( arg1, DEBUG_ARITH );
@@ -273,14 +275,16 @@ struct cons_pointer add_2( struct stack_frame *frame,
         result = arg2;
     } else if ( zerop( arg2 ) ) {
         result = arg1;
+    } else if ( numeric_arrayp( arg1 ) || numeric_arrayp( arg2 ) ) {
+        result = array_arithmetic( L'+', arg1, arg2, frame_pointer );
     } else {
 
-        switch ( cell1.tag.value ) {
+        switch ( pointer2tag( arg1 ).value ) {
             case EXCEPTIONTV:
                 result = arg1;
                 break;
             case INTEGERTV:
-                switch ( cell2.tag.value ) {
+                switch ( pointer2tag( arg2 ).value ) {
                     case EXCEPTIONTV:
                         result = arg2;
                         break;
@@ -305,7 +309,7 @@ struct cons_pointer add_2( struct stack_frame *frame,
                 }
                 break;
             case RATIOTV:
-                switch ( cell2.tag.value ) {
+                switch ( pointer2tag( arg2 ).value ) {
                     case EXCEPTIONTV:
                         result = arg2;
                         break;
@@ -362,29 +366,24 @@ struct cons_pointer lisp_add( struct stack_frame
                               cons_pointer env ) {
     struct cons_pointer result = make_integer( 0, NIL );
     struct cons_pointer tmp;
+    /* whether `result` is ours to release, rather than an argument */
+    bool owned = true;
 
     for ( int i = 0;
-          i < args_in_frame &&
+          i < frame->args &&
           !nilp( frame->arg[i] ) && !exceptionp( result ); i++ ) {
         tmp = result;
         result = add_2( frame, frame_pointer, result, frame->arg[i] );
         if ( !eq( tmp, result ) ) {
-            dec_ref( tmp );
-        }
-    }
-
-    struct cons_pointer more = frame->more;
-    while ( consp( more ) && !exceptionp( result ) ) {
-        tmp = result;
-        result = add_2( frame, frame_pointer, result, c_car( more ) );
-        if ( !eq( tmp, result ) ) {
-            dec_ref( tmp );
+            if ( owned ) {
+                dec_ref( tmp );
+            }
+            owned = !eq( result, frame->arg[i] );
         }
-
-        more = c_cdr( more );
     }
 
-    return result;
+    /* an argument given back must be owned by the caller, as is a new sum */
+    return owned ? result : inc_ref( result );
 }
 
 
@@ -397,8 +396,6 @@ struct cons_pointer multiply_2( struct stack_frame *frame,
                                 struct cons_pointer arg1,
                                 struct cons_pointer arg2 ) {
     struct cons_pointer result;
-    struct cons_space_object cell1 = pointer2cell( arg1 );
-    struct cons_space_object cell2 = pointer2cell( arg2 );
 
     debug_print( L"multiply_2( arg1 = ", DEBUG_ARITH );
     debug_print_object( arg1, DEBUG_ARITH );
@@ -406,17 +403,21 @@ struct cons_pointer multiply_2( struct stack_frame *frame,
     debug_print_object( arg2, DEBUG_ARITH );
     debug_print( L")\n", DEBUG_ARITH );
 
-    if ( zerop( arg1 ) ) {
-        result = arg2;
-    } else if ( zerop( arg2 ) ) {
+    if ( numeric_arrayp( arg1 ) || numeric_arrayp( arg2 ) ) {
+        /* before the tests for zero, since zero times an array is an
+         * array of zeroes */
+        result = array_arithmetic( L'*', arg1, arg2, frame_pointer );
+    } else if ( zerop( arg1 ) ) {
         result = arg1;
+    } else if ( zerop( arg2 ) ) {
+        result = arg2;
     } else {
-        switch ( cell1.tag.value ) {
+        switch ( pointer2tag( arg1 ).value ) {
             case EXCEPTIONTV:
                 result = arg1;
                 break;
             case INTEGERTV:
-                switch ( cell2.tag.value ) {
+                switch ( pointer2tag( arg2 ).value ) {
                     case EXCEPTIONTV:
                         result = arg2;
                         break;
@@ -443,7 +444,7 @@ struct cons_pointer multiply_2( struct stack_frame *frame,
                 }
                 break;
             case RATIOTV:
-                switch ( cell2.tag.value ) {
+                switch ( pointer2tag( arg2 ).value ) {
                     case EXCEPTIONTV:
                         result = arg2;
                         break;
@@ -490,7 +491,7 @@ struct cons_pointer multiply_2( struct stack_frame *frame,
     return result;
 }
 
-#define multiply_one_arg(arg) {if (exceptionp(arg)){result=arg;}else{tmp = result; result = multiply_2( frame, frame_pointer, result, arg ); if ( !eq( tmp, result ) ) dec_ref( tmp );}}
+#define multiply_one_arg(arg) {if (exceptionp(arg)){result=arg;owned=false;}else{tmp = result; result = multiply_2( frame, frame_pointer, result, arg ); if ( !eq( tmp, result ) ) {if ( owned ) dec_ref( tmp ); owned = !eq( result, arg );}}}
 
 /**
  * Multiply an indefinite number of numbers together
@@ -505,8 +506,10 @@ struct cons_pointer lisp_multiply( struct
                                    cons_pointer env ) {
     struct cons_pointer result = make_integer( 1, NIL );
     struct cons_pointer tmp;
+    /* whether `result` is ours to release, rather than an argument */
+    bool owned = true;
 
-    for ( int i = 0; i < args_in_frame && !nilp( frame->arg[i] )
+    for ( int i = 0; i < frame->args && !nilp( frame->arg[i] )
           && !exceptionp( result ); i++ ) {
         debug_print( L"lisp_multiply: accumulator = ", DEBUG_ARITH );
         debug_print_object( result, DEBUG_ARITH );
@@ -517,18 +520,12 @@ struct cons_pointer lisp_multiply( struct
         multiply_one_arg( frame->arg[i] );
     }
 
-    struct cons_pointer more = frame->more;
-    while ( consp( more )
-            && !exceptionp( result ) ) {
-        multiply_one_arg( c_car( more ) );
-        more = c_cdr( more );
-    }
-
     debug_print( L"lisp_multiply returning: ", DEBUG_ARITH );
     debug_print_object( result, DEBUG_ARITH );
     debug_println( DEBUG_ARITH );
 
-    return result;
+    /* as in `lisp_add` */
+    return owned ? result : inc_ref( result );
 }
 
 /**
@@ -539,7 +536,7 @@ struct cons_pointer negative( struct cons_pointer arg ) {
     struct cons_pointer result = NIL;
     struct cons_space_object cell = pointer2cell( arg );
 
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( arg ).value ) {
         case EXCEPTIONTV:
             result = arg;
             break;
@@ -596,86 +593,93 @@ struct cons_pointer subtract_2( struct stack_frame *frame,
                                 struct cons_pointer arg2 ) {
     struct cons_pointer result = NIL;
 
-    switch ( pointer2cell( arg1 ).tag.value ) {
-        case EXCEPTIONTV:
-            result = arg1;
-            break;
-        case INTEGERTV:
-            switch ( pointer2cell( arg2 ).tag.value ) {
-                case EXCEPTIONTV:
-                    result = arg2;
-                    break;
-                case INTEGERTV:{
-                        struct cons_pointer i = negative( arg2 );
-                        inc_ref( i );
-                        result = add_integers( arg1, i );
-                        dec_ref( i );
-                    }
-                    break;
-                case RATIOTV:{
-                        struct cons_pointer tmp = make_ratio( arg1,
-                                                              make_integer( 1,
-                                                                            NIL ),
-                                                              false );
-                        inc_ref( tmp );
-                        result = subtract_ratio_ratio( tmp, arg2 );
-                        dec_ref( tmp );
-                    }
-                    break;
-                case REALTV:
-                    result =
-                        make_real( to_long_double( arg1 ) -
-                                   to_long_double( arg2 ) );
-                    break;
-                default:
-                    result = throw_exception( c_string_to_lisp_symbol( L"-" ),
-                                              c_string_to_lisp_string
-                                              ( L"Cannot subtract: not a number" ),
-                                              frame_pointer );
-                    break;
-            }
-            break;
-        case RATIOTV:
-            switch ( pointer2cell( arg2 ).tag.value ) {
-                case EXCEPTIONTV:
-                    result = arg2;
-                    break;
-                case INTEGERTV:{
-                        struct cons_pointer tmp = make_ratio( arg2,
-                                                              make_integer( 1,
-                                                                            NIL ),
-                                                              false );
-                        inc_ref( tmp );
-                        result = subtract_ratio_ratio( arg1, tmp );
-                        dec_ref( tmp );
-                    }
-                    break;
-                case RATIOTV:
-                    result = subtract_ratio_ratio( arg1, arg2 );
-                    break;
-                case REALTV:
-                    result =
-                        make_real( to_long_double( arg1 ) -
-                                   to_long_double( arg2 ) );
-                    break;
-                default:
-                    result = throw_exception( c_string_to_lisp_symbol( L"-" ),
-                                              c_string_to_lisp_string
-                                              ( L"Cannot subtract: not a number" ),
-                                              frame_pointer );
-                    break;
-            }
-            break;
-        case REALTV:
-            result = exceptionp( arg2 ) ? arg2 :
-                make_real( to_long_double( arg1 ) - to_long_double( arg2 ) );
-            break;
-        default:
-            result = throw_exception( c_string_to_lisp_symbol( L"-" ),
-                                      c_string_to_lisp_string
-                                      ( L"Cannot subtract: not a number" ),
-                                      frame_pointer );
-            break;
+    if ( numeric_arrayp( arg1 ) || numeric_arrayp( arg2 ) ) {
+        result = array_arithmetic( L'-', arg1, arg2, frame_pointer );
+    } else {
+        switch ( pointer2tag( arg1 ).value ) {
+            case EXCEPTIONTV:
+                result = arg1;
+                break;
+            case INTEGERTV:
+                switch ( pointer2tag( arg2 ).value ) {
+                    case EXCEPTIONTV:
+                        result = arg2;
+                        break;
+                    case INTEGERTV:{
+                            struct cons_pointer i = negative( arg2 );
+                            inc_ref( i );
+                            result = add_integers( arg1, i );
+                            dec_ref( i );
+                        }
+                        break;
+                    case RATIOTV:{
+                            struct cons_pointer tmp = make_ratio( arg1,
+                                                                  make_integer( 1,
+                                                                                NIL ),
+                                                                  false );
+                            inc_ref( tmp );
+                            result = subtract_ratio_ratio( tmp, arg2 );
+                            dec_ref( tmp );
+                        }
+                        break;
+                    case REALTV:
+                        result =
+                            make_real( to_long_double( arg1 ) -
+                                       to_long_double( arg2 ) );
+                        break;
+                    default:
+                        result =
+                            throw_exception( c_string_to_lisp_symbol( L"-" ),
+                                             c_string_to_lisp_string
+                                             ( L"Cannot subtract: not a number" ),
+                                             frame_pointer );
+                        break;
+                }
+                break;
+            case RATIOTV:
+                switch ( pointer2tag( arg2 ).value ) {
+                    case EXCEPTIONTV:
+                        result = arg2;
+                        break;
+                    case INTEGERTV:{
+                            struct cons_pointer tmp = make_ratio( arg2,
+                                                                  make_integer( 1,
+                                                                                NIL ),
+                                                                  false );
+                            inc_ref( tmp );
+                            result = subtract_ratio_ratio( arg1, tmp );
+                            dec_ref( tmp );
+                        }
+                        break;
+                    case RATIOTV:
+                        result = subtract_ratio_ratio( arg1, arg2 );
+                        break;
+                    case REALTV:
+                        result =
+                            make_real( to_long_double( arg1 ) -
+                                       to_long_double( arg2 ) );
+                        break;
+                    default:
+                        result =
+                            throw_exception( c_string_to_lisp_symbol( L"-" ),
+                                             c_string_to_lisp_string
+                                             ( L"Cannot subtract: not a number" ),
+                                             frame_pointer );
+                        break;
+                }
+                break;
+            case REALTV:
+                result = exceptionp( arg2 ) ? arg2 :
+                    make_real( to_long_double( arg1 ) -
+                               to_long_double( arg2 ) );
+                break;
+            default:
+                result = throw_exception( c_string_to_lisp_symbol( L"-" ),
+                                          c_string_to_lisp_string
+                                          ( L"Cannot subtract: not a number" ),
+                                          frame_pointer );
+                break;
+        }
     }
 
     // and if not nilp[frame->arg[2]) we also have an error.
@@ -695,7 +699,12 @@ struct cons_pointer lisp_subtract( struct
                                    stack_frame
                                    *frame, struct cons_pointer frame_pointer, struct
                                    cons_pointer env ) {
-    return subtract_2( frame, frame_pointer, frame->arg[0], frame->arg[1] );
+    struct cons_pointer result =
+        subtract_2( frame, frame_pointer, frame->arg[0], frame->arg[1] );
+
+    /* an exception passed in is given back as it is */
+    return eq( result, frame->arg[0] ) || eq( result, frame->arg[1] ) ?
+        inc_ref( result ) : result;
 }
 
 /**
@@ -711,15 +720,13 @@ struct cons_pointer lisp_divide( struct
                                  *frame, struct cons_pointer frame_pointer, struct
                                  cons_pointer env ) {
     struct cons_pointer result = NIL;
-    struct cons_space_object arg0 = pointer2cell( frame->arg[0] );
-    struct cons_space_object arg1 = pointer2cell( frame->arg[1] );
 
-    switch ( arg0.tag.value ) {
+    switch ( pointer2tag( frame->arg[0] ).value ) {
         case EXCEPTIONTV:
             result = frame->arg[0];
             break;
         case INTEGERTV:
-            switch ( arg1.tag.value ) {
+            switch ( pointer2tag( frame->arg[1] ).value ) {
                 case EXCEPTIONTV:
                     result = frame->arg[1];
                     break;
@@ -751,7 +758,7 @@ struct cons_pointer lisp_divide( struct
             }
             break;
         case RATIOTV:
-            switch ( arg1.tag.value ) {
+            switch ( pointer2tag( frame->arg[1] ).value ) {
                 case EXCEPTIONTV:
                     result = frame->arg[1];
                     break;
@@ -794,7 +801,9 @@ struct cons_pointer lisp_divide( struct
             break;
     }
 
-    return result;
+    /* as in `lisp_subtract` */
+    return eq( result, frame->arg[0] ) || eq( result, frame->arg[1] ) ?
+        inc_ref( result ) : result;
 }
 
 /**
@@ -324,20 +324,23 @@ struct cons_pointer make_ratio( struct cons_pointer dividend,
 
     struct cons_pointer result;
     if ( integerp( dividend ) && integerp( divisor ) ) {
-        inc_ref( dividend );
-        inc_ref( divisor );
         struct cons_pointer unsimplified = allocate_cell( RATIOTV );
-        struct cons_space_object *cell = &pointer2cell( unsimplified );
-        cell->payload.ratio.dividend = dividend;
-        cell->payload.ratio.divisor = divisor;
-
-        if ( simplify ) {
-            result = simplify_ratio( unsimplified );
-            if ( !eq( result, unsimplified ) ) {
-                dec_ref( unsimplified );
-            }
-        } else {
+
+        if ( exceptionp( unsimplified ) ) {
             result = unsimplified;
+        } else {
+            struct cons_space_object *cell = &pointer2cell( unsimplified );
+            cell->payload.ratio.dividend = inc_ref( dividend );
+            cell->payload.ratio.divisor = inc_ref( divisor );
+
+            if ( simplify ) {
+                result = simplify_ratio( unsimplified );
+                if ( !eq( result, unsimplified ) ) {
+                    dec_ref( unsimplified );
+                }
+            } else {
+                result = unsimplified;
+            }
         }
     } else {
         result =
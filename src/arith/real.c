@@ -20,8 +20,10 @@
  */
 struct cons_pointer make_real( long double value ) {
     struct cons_pointer result = allocate_cell( REALTV );
-    struct cons_space_object *cell = &pointer2cell( result );
-    cell->payload.real.value = value;
+
+    if ( !exceptionp( result ) ) {
+        pointer2cell( result ).payload.real.value = value;
+    }
 
     debug_dump_object( result, DEBUG_ARITH );
 
@@ -7,6 +7,7 @@
  * Licensed under GPL version 2.0, or, at your option, any later version.
  */
 
+#include "memory/access.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
 
@@ -18,7 +19,7 @@
 struct cons_pointer authorised( struct cons_pointer target,
                                 struct cons_pointer acl ) {
     if ( nilp( acl ) ) {
-        acl = pointer2cell( target ).access;
+        acl = get_access( target );
     }
     return TRUE;
 }
@@ -20,16 +20,21 @@
 /* libcurl, used for io */
 #include <curl/curl.h>
 
+#include "arith/array.h"
 #include "arith/peano.h"
 #include "arith/ratio.h"
 #include "debug.h"
 #include "io/fopen.h"
 #include "io/io.h"
 #include "io/print.h"
+#include "memory/bytes.h"
+#include "memory/collect.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
 #include "memory/hashmap.h"
+#include "memory/room.h"
 #include "memory/stack.h"
+#include "memory/vector.h"
 #include "ops/intern.h"
 #include "ops/lispops.h"
 #include "ops/meta.h"
@@ -86,6 +91,13 @@ void maybe_bind_init_symbols(  ) {
         privileged_string_memory_exhausted =
             c_string_to_lisp_string( L"Memory exhausted." );
     }
+    // nor this one; and it is locked, since it may be thrown any number of
+    // times.
+    if ( nilp( privileged_exception_memory_exhausted ) ) {
+        privileged_exception_memory_exhausted =
+            make_exception( privileged_string_memory_exhausted, NIL );
+        pointer2count( privileged_exception_memory_exhausted ) = MAXREFERENCE;
+    }
     if ( nilp( privileged_keyword_location ) ) {
         privileged_keyword_location = c_string_to_lisp_keyword( L"location" );
     }
@@ -177,9 +189,7 @@ bind_symbol_value( struct cons_pointer symbol, struct cons_pointer value,
                                              "bind_symbol_value" );
 
     if ( lock && !exceptionp( r ) ) {
-        struct cons_space_object *cell = &pointer2cell( r );
-
-        cell->count = UINT32_MAX;
+        pointer2count( r ) = UINT32_MAX;
     }
 
     return r;
@@ -211,12 +221,41 @@ void print_banner(  ) {
  */
 void print_options( FILE *stream ) {
     fwprintf( stream, L"Expected options are:\n" );
+    fwprintf( stream,
+              L"\t-a PAGES\n\t\tAllocate this number of cons PAGES at startup (default 1);\n" );
+    fwprintf( stream,
+              L"\t-b CELLS\n\t\tReclaim at most this number of freed CELLS per allocation\n\t\t(default 0, meaning reclaim immediately);\n" );
+    fwprintf( stream,
+              L"\t-c CELLS\n\t\tSet the number of CELLS on each cons page (default %d);\n",
+              CONSPAGESIZE );
     fwprintf( stream,
               L"\t-d\tDump memory to standard out at end of run (copious!);\n" );
+    fwprintf( stream,
+              L"\t-g PAGES\n\t\tCollect cycles when cons space first grows to this number of\n\t\tPAGES, and again each time it doubles (default %d; 0 never);\n",
+              DFLT_CYCLE_COLLECTION_PAGES );
     fwprintf( stream, L"\t-h\tPrint this message and exit;\n" );
+    fwprintf( stream,
+              L"\t-H\tAsk for cons space to be backed by transparent huge pages;\n" );
+#ifndef MARK_SWEEP
+    fwprintf( stream,
+              L"\t-M\tManage memory by mark-sweep collection rather than by reference\n\t\tcounting; -g then sets when the first collection happens;\n" );
+#endif
+    fwprintf( stream,
+              L"\t-l PAGES\n\t\tWhen more than this number of cons PAGES are resident, shed\n\t\tmemory between top level forms (default 0, meaning no limit);\n" );
+    fwprintf( stream,
+              L"\t-m PAGES\n\t\tAllow at most this number of cons PAGES (default %d,\n\t\tincluding %d reserve page(s) held against exhaustion);\n",
+              MAXCONSPAGES, CONS_PAGES_RESERVED );
+    fwprintf( stream,
+              L"\t-n PAGES\n\t\tUnder -M, collect only the cells allocated since the last\n\t\tcollection each time this number of PAGES of them have been\n\t\tallocated (default %d; 0 never);\n",
+              DFLT_NURSERY_PAGES );
     fwprintf( stream, L"\t-p\tShow a prompt (default is no prompt);\n" );
+    fwprintf( stream,
+              L"\t-r PAGES\n\t\tKeep this number of empty cons PAGES resident, returning the\n\t\tmemory of any more to the operating system (default %d);\n",
+              DFLT_CONS_PAGES_RETAINED );
     fwprintf( stream,
               L"\t-s LIMIT\n\t\tSet the maximum stack depth to this LIMIT (int)\n" );
+    fwprintf( stream,
+              L"\t-S\tPrint memory management statistics at end of run;\n" );
 #ifdef DEBUG
     fwprintf( stream,
               L"\t-v LEVEL\n\t\tSet verbosity to the specified level (0...512)\n" );
@@ -242,6 +281,7 @@ int main( int argc, char *argv[] ) {
     int option;
     bool dump_at_end = false;
     bool show_prompt = false;
+    bool show_statistics = false;
     char *infilename = NULL;
 
     setlocale( LC_ALL, "" );
@@ -250,25 +290,60 @@ int main( int argc, char *argv[] ) {
         exit( 1 );
     }
 
-    while ( ( option = getopt( argc, argv, "dhi:ps:v:" ) ) != -1 ) {
+    while ( ( option = getopt( argc, argv, "a:b:c:dg:hHi:l:Mm:n:pr:s:Sv:" ) ) != -1 ) {
         switch ( option ) {
+            case 'a':
+                cons_pages_initial = atoi( optarg );
+                break;
+            case 'b':
+                reclamation_budget = atoi( optarg );
+                break;
+            case 'c':
+                cons_page_size = atoi( optarg );
+                break;
             case 'd':
                 dump_at_end = true;
                 break;
+            case 'g':
+                cycle_collection_pages = atoi( optarg );
+                break;
             case 'h':
                 print_banner(  );
                 print_options( stdout );
                 exit( 0 );
                 break;
+            case 'H':
+                cons_space_huge_pages = true;
+                break;
             case 'i':
                 infilename = optarg;
                 break;
+            case 'l':
+                cons_pages_soft_limit = atoi( optarg );
+                break;
+#ifndef MARK_SWEEP
+            case 'M':
+                reference_counting = false;
+                break;
+#endif
+            case 'm':
+                cons_pages_max = atoi( optarg );
+                break;
+            case 'n':
+                nursery_pages = atoi( optarg );
+                break;
             case 'p':
                 show_prompt = true;
                 break;
+            case 'r':
+                cons_pages_retained = atoi( optarg );
+                break;
             case 's':
                 stack_limit = atoi( optarg );
                 break;
+            case 'S':
+                show_statistics = true;
+                break;
             case 'v':
                 verbosity = atoi( optarg );
                 break;
@@ -376,9 +451,36 @@ int main( int argc, char *argv[] ) {
     bind_function( L"apply",
                    L"`(apply f args)`: If `f` is usable as a function, and `args` is a collection, apply `f` to `args` and return the value.",
                    &lisp_apply );
+    bind_function( L"array-dot",
+                   L"`(array-dot a b)`: Return the sum of the products, pairwise, of the elements of the numeric arrays `a` and `b`, which must be of the same length.",
+                   &lisp_array_dot );
+    bind_function( L"array-max",
+                   L"`(array-max a)`: Return the greatest element of the numeric array `a`, or `nil` if it is empty.",
+                   &lisp_array_max );
+    bind_function( L"array-min",
+                   L"`(array-min a)`: Return the least element of the numeric array `a`, or `nil` if it is empty.",
+                   &lisp_array_min );
+    bind_function( L"array-sum",
+                   L"`(array-sum a)`: Return the sum of the elements of the numeric array `a`.",
+                   &lisp_array_sum );
+    bind_function( L"array<",
+                   L"`(array< a b)`: Return an integer array with 1 where the element of the numeric array `a` is less than `b`, or than the element of `b` at the same index if `b` is an array, and 0 elsewhere.",
+                   &lisp_array_less );
+    bind_function( L"array=",
+                   L"`(array= a b)`: As `array<`, but 1 where the elements are equal.",
+                   &lisp_array_equal );
+    bind_function( L"array>",
+                   L"`(array> a b)`: As `array<`, but 1 where the element of `a` is the greater.",
+                   &lisp_array_greater );
     bind_function( L"assoc",
                    L"`(assoc key store)`: Return the value associated with this `key` in this `store`.",
                    &lisp_assoc );
+    bind_function( L"byte-slice",
+                   L"`(byte-slice buffer offset length)`: Return the `length` bytes of the byte buffer `buffer` from `offset`, counting from zero, or all those to its end if `length` is not given. The slice shares the bytes of `buffer` rather than copying them.",
+                   &lisp_byte_slice );
+    bind_function( L"bytes->string",
+                   L"`(bytes->string buffer)`: Return the string of which the byte buffer `buffer` is the UTF-8 encoding.",
+                   &lisp_bytes_to_string );
     bind_function( L"car",
                    L"`(car arg)`: If `arg` is a sequence, return the item which is the head of that sequence.",
                    &lisp_car );
@@ -388,11 +490,14 @@ int main( int argc, char *argv[] ) {
     bind_function( L"close",
                    L"`(close stream)`: If `stream` is a stream, close that stream.",
                    &lisp_close );
+    bind_function( L"collect-cycles",
+                   L"`(collect-cycles)`: Find and reclaim structures which refer to themselves but are not otherwise referenced; return the number of cells recovered.",
+                   &lisp_collect_cycles );
     bind_function( L"cons",
                    L"`(cons a b)`: Return a cons cell whose `car` is `a` and whose `cdr` is `b`.",
                    &lisp_cons );
     bind_function( L"count",
-                   L"`(count s)`: Return the number of items in the sequence `s`.",
+                   L"`(count s)`: Return the number of items in the sequence `s`, which may be a list, a string, a vector, a numeric array or a byte buffer.",
                    &lisp_count );
     bind_function( L"divide",
                    L"`(/ a b)`: If `a` and `b` are both numbers, return the numeric result of dividing `a` by `b`.",
@@ -411,11 +516,14 @@ int main( int argc, char *argv[] ) {
                    L"`(get-hash arg)`: returns the natural number hash value of `arg`.",
                    &lisp_get_hash );
     bind_function( L"hashmap",
-                   L"`(hashmap n-buckets hashfn store acl)`: Return a new hashmap, with `n-buckets` buckets and this `hashfn`, containing the content of this `store`.",
+                   L"`(hashmap n-slots hashfn store acl)`: Return a new hashmap, with at least `n-slots` slots and this `hashfn`, containing the content of this `store`. If there is no `acl`, the hashmap is persistent, and `n-slots` is ignored.",
                    lisp_make_hashmap );
     bind_function( L"inspect",
                    L"`(inspect object ouput-stream)`: Print details of this `object` to this `output-stream` or `*out*`.",
                    &lisp_inspect );
+    bind_function( L"integer-array",
+                   L"`(integer-array sequence)`: Return an integer array of the elements of `sequence`, a list or vector of integers. Arithmetic on it is element by element.",
+                   &lisp_intarray );
     bind_function( L"interned?",
                    L"`(interned? key store)`: Return `t` if the symbol or keyword `key` is bound in this `store`, else `nil`.",
                    &lisp_internedp );
@@ -426,7 +534,7 @@ int main( int argc, char *argv[] ) {
                    L"`(list args...)`: Return a list of these `args`.",
                    &lisp_list );
     bind_function( L"mapcar",
-                   L"`(mapcar function sequence)`: Apply `function` to each element of `sequence` in turn, and return a sequence of the results.",
+                   L"`(mapcar function sequence)`: Apply `function` to each element of `sequence` in turn, and return a sequence of the results; a vector if `sequence` is a vector, else a list.",
                    &lisp_mapcar );
     bind_function( L"meta",
                    L"`(meta symbol)`: If the binding of `symbol` has metadata, return that metadata, else `nil`.",
@@ -443,6 +551,9 @@ int main( int argc, char *argv[] ) {
     bind_function( L"not",
                    L"`(not arg)`: Return`t` only if `arg` is `nil`, else `nil`.",
                    &lisp_not );
+    bind_function( L"nth",
+                   L"`(nth n sequence)`: Return the `n`th member of `sequence`, counting from one, or `nil` if it has none. Takes constant time if `sequence` is a vector, a numeric array, a byte buffer or a string read by the reader or by `slurp`.",
+                   &lisp_nth );
     bind_function( L"oblist",
                    L"`(oblist)`: Return the current symbol bindings, as a map.",
                    &lisp_oblist );
@@ -468,15 +579,24 @@ int main( int argc, char *argv[] ) {
     bind_function( L"read",
                    L"`(read stream)`: read one complete lisp form and return it. If `stream` is specified and is a read stream, then read from that stream, else the stream which is the value of  `*in*` in the environment.",
                    &lisp_read );
+    bind_function( L"read-bytes",
+                   L"`(read-bytes stream n)`: Return a byte buffer of up to `n` raw bytes read from the read stream `stream`, or of all those to its end if `n` is not given; or `nil` if there are none.",
+                   &lisp_read_bytes );
     bind_function( L"read-char",
                    L"`(read-char stream)`: Return the next character. If `stream` is specified and is a read stream, then read from that stream, else the stream which is the value of  `*in*` in the environment.",
                    &lisp_read_char );
+    bind_function( L"real-array",
+                   L"`(real-array sequence)`: Return a real array of the elements of `sequence`, a list or vector of numbers. Arithmetic on it is element by element.",
+                   &lisp_realarray );
     bind_function( L"repl",
                    L"`(repl prompt input output)`: Starts a new read-eval-print-loop. All arguments are optional.",
                    &lisp_repl );
     bind_function( L"reverse",
                    L"`(reverse sequence)` Returns a sequence of the top level elements of this `sequence`, which may be a list or a string, in the reverse order.",
                    &lisp_reverse );
+    bind_function( L"room",
+                   L"`(room)`: Return a hashmap describing the use of memory: the number of objects allocated, freed and live, their high water mark, the bytes they occupy and the rate of allocation since `room` was last called; and the same figures by type.",
+                   &lisp_room );
     bind_function( L"set", L"", &lisp_set );
     bind_function( L"slurp",
                    L"`(slurp read-stream)` Read all the characters from `read-stream` to the end of stream, and return them as a string.",
@@ -484,6 +604,9 @@ int main( int argc, char *argv[] ) {
     bind_function( L"source",
                    L"`(source  object)`: If `object` is an interpreted function or interpreted special form, returns the source code; else nil.",
                    &lisp_source );
+    bind_function( L"string->bytes",
+                   L"`(string->bytes string)`: Return a byte buffer of the UTF-8 encoding of `string`.",
+                   &lisp_string_to_bytes );
     bind_function( L"subtract",
                    L"`(- a b)`: Subtracts `b` from `a` and returns the result. Expects both arguments to be numbers.",
                    &lisp_subtract );
@@ -496,6 +619,12 @@ int main( int argc, char *argv[] ) {
     bind_function( L"type",
                    L"`(type object)`: returns the type of the specified `object`. Currently (0.0.6) the type is returned as a four character string; this may change.",
                    &lisp_type );
+    bind_function( L"vector",
+                   L"`(vector args...)`: Return a vector of these `args`.",
+                   &lisp_vector );
+    bind_function( L"write-bytes",
+                   L"`(write-bytes buffer stream)`: Write the raw bytes of the byte buffer `buffer` to the write stream `stream`, and return the number written.",
+                   &lisp_write_bytes );
     bind_function( L"+",
                    L"`(+ args...)`: If `args` are all numbers, return the sum of those numbers.",
                    &lisp_add );
@@ -543,14 +672,15 @@ int main( int argc, char *argv[] ) {
     debug_print( L"Initialised oblist\n", DEBUG_BOOTSTRAP );
     debug_dump_object( oblist, DEBUG_BOOTSTRAP );
 
+    allocation_may_fail = true;
     repl( show_prompt );
 
     debug_dump_object( oblist, DEBUG_BOOTSTRAP );
 
     debug_print( L"Freeing oblist\n", DEBUG_BOOTSTRAP );
-    while ( ( pointer2cell( oblist ) ).count > 0 ) {
+    while ( reference_counting && pointer2count( oblist ) > 0 ) {
         fprintf( stderr, "Dangling refs on oblist: %d\n",
-                 ( pointer2cell( oblist ) ).count );
+                 pointer2count( oblist ) );
         dec_ref( oblist );
     }
 
@@ -560,6 +690,14 @@ int main( int argc, char *argv[] ) {
         dump_pages( file_to_url_file( stdout ) );
     }
 
+    if ( show_statistics ) {
+        reclaim_pending_cells( 0 );
+        summarise_reclamation( file_to_url_file( stderr ) );
+        summarise_collection( file_to_url_file( stderr ) );
+        summarise_cons_pages( file_to_url_file( stderr ) );
+        summarise_memory_by_tag( file_to_url_file( stderr ) );
+    }
+
     summarise_allocation(  );
     curl_global_cleanup(  );
     return ( 0 );
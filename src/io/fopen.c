@@ -62,6 +62,8 @@ URL_FILE *url_fopen( const char *url, const char *operation );
 int url_fclose( URL_FILE * file );
 int url_feof( URL_FILE * file );
 size_t url_fread( void *ptr, size_t size, size_t nmemb, URL_FILE * file );
+size_t url_fwrite( const void *ptr, size_t size, size_t nmemb,
+                   URL_FILE * file );
 char *url_fgets( char *ptr, size_t size, URL_FILE * file );
 void url_rewind( URL_FILE * file );
 
@@ -343,6 +345,25 @@ size_t url_fread( void *ptr, size_t size, size_t nmemb, URL_FILE *file ) {
     return want;
 }
 
+/* writing is only possible to files; curl handles are read only */
+size_t url_fwrite( const void *ptr, size_t size, size_t nmemb,
+                   URL_FILE *file ) {
+    size_t result;
+
+    switch ( file->type ) {
+        case CFTYPE_FILE:
+            result = fwrite( ptr, size, nmemb, file->handle.file );
+            break;
+
+        default:               /* curl, unknown or unsupported type */
+            result = 0;
+            errno = EBADF;
+            break;
+    }
+
+    return result;
+}
+
 char *url_fgets( char *ptr, size_t size, URL_FILE *file ) {
     size_t want = size - 1;     /* always need to leave room for zero termination */
     size_t loop;
@@ -32,8 +32,10 @@
 #include "debug.h"
 #include "io/fopen.h"
 #include "io/io.h"
+#include "memory/bytes.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
+#include "memory/pstring.h"
 #include "ops/intern.h"
 #include "ops/lispops.h"
 #include "utils.h"
@@ -95,7 +97,16 @@ int io_init(  ) {
 char *lisp_string_to_c_string( struct cons_pointer s ) {
     char *result = NULL;
 
-    if ( stringp( s ) || symbolp( s ) ) {
+    if ( pstringp( s ) ) {
+        uint64_t len = pstring_length( s );
+        wchar_t *buffer = calloc( len + 1, sizeof( wchar_t ) );
+
+        wmemcpy( buffer, pstring_payload( s )->characters, len );
+        /* worst case, one wide char = four utf bytes */
+        result = calloc( ( len * 4 ) + 1, sizeof( char ) );
+        wcstombs( result, buffer, len * 4 );
+        free( buffer );
+    } else if ( stringp( s ) || symbolp( s ) ) {
         int len = 0;
 
         for ( struct cons_pointer c = s; !nilp( c );
@@ -309,8 +320,8 @@ static size_t write_meta_callback( char *string, size_t size, size_t nmemb,
 
     strcpy( s, string );
 
-    if ( strncmp( &cell->tag.bytes[0], READTAG, 4 ) ||
-         strncmp( &cell->tag.bytes[0], WRITETAG, 4 ) ) {
+    if ( strncmp( &pointer2tag( stream ).bytes[0], READTAG, 4 ) ||
+         strncmp( &pointer2tag( stream ).bytes[0], WRITETAG, 4 ) ) {
         int offset = index_of( ':', s );
 
         if ( offset != -1 ) {
@@ -438,7 +449,7 @@ lisp_open( struct stack_frame *frame, struct cons_pointer frame_pointer,
            struct cons_pointer env ) {
     struct cons_pointer result = NIL;
 
-    if ( stringp( frame->arg[0] ) ) {
+    if ( any_stringp( frame->arg[0] ) ) {
         char *url = lisp_string_to_c_string( frame->arg[0] );
 
         if ( nilp( frame->arg[1] ) ) {
@@ -515,6 +526,133 @@ lisp_read_char( struct stack_frame *frame, struct cons_pointer frame_pointer,
     return result;
 }
 
+/**
+ * The size of the chunks in which `read-bytes` reads a stream to its end.
+ */
+#define READ_BYTES_CHUNK 65536
+
+/**
+ * Function: return a byte buffer of raw bytes read from the stream
+ * indicated by arg 0: as many as arg 1, if it is given, else all those to
+ * the end of the stream. The bytes are not decoded as characters, so a
+ * stream should be read either by this or by the functions which read
+ * characters, not both.
+ *
+ * * (read-bytes stream)
+ * * (read-bytes stream n)
+ *
+ * @param frame my stack_frame.
+ * @param frame_pointer a pointer to my stack_frame.
+ * @param env my environment.
+ * @return a byte buffer of the bytes read, which may be fewer than `n`,
+ * or NIL if there were none to read.
+ * @exception if `stream` is not a read stream, or `n` is not a non-negative
+ * integer.
+ */
+struct cons_pointer
+lisp_read_bytes( struct stack_frame *frame, struct cons_pointer frame_pointer,
+                 struct cons_pointer env ) {
+    struct cons_pointer result = NIL;
+    struct cons_pointer n = frame->arg[1];
+    bool counted = integerp( n ) &&
+        nilp( pointer2cell( n ).payload.integer.more ) &&
+        pointer2cell( n ).payload.integer.value >= 0;
+
+    if ( !readp( frame->arg[0] ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"read-bytes" ),
+                                  c_string_to_lisp_string
+                                  ( L"Expected a read stream" ),
+                                  frame_pointer );
+    } else if ( !( counted || nilp( n ) ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"read-bytes" ),
+                                  c_string_to_lisp_string
+                                  ( L"Number of bytes must be a non-negative integer" ),
+                                  frame_pointer );
+    } else {
+        URL_FILE *stream = pointer2cell( frame->arg[0] ).payload.stream.stream;
+        uint64_t limit = counted ? pointer2cell( n ).payload.integer.value :
+            UINT64_MAX;
+        uint64_t length = 0;
+        /* read in chunks, so that asking for more bytes than there are
+         * costs no more memory than the bytes there are */
+        uint64_t capacity = READ_BYTES_CHUNK;
+        uint8_t *buffer = malloc( capacity );
+        bool exhausted = buffer == NULL;
+
+        for ( size_t got = 1; !exhausted && got > 0 && length < limit;
+              length += got ) {
+            if ( capacity - length < READ_BYTES_CHUNK ) {
+                uint8_t *grown = realloc( buffer, capacity * 2 );
+
+                if ( grown == NULL ) {
+                    exhausted = true;
+                    break;
+                }
+                buffer = grown;
+                capacity *= 2;
+            }
+            got = url_fread( buffer + length, 1,
+                             limit - length < READ_BYTES_CHUNK ?
+                             limit - length : READ_BYTES_CHUNK, stream );
+        }
+
+        if ( exhausted ) {
+            result =
+                make_exception( privileged_string_memory_exhausted, NIL );
+        } else if ( length > 0 ) {
+            result = make_bytes( length );
+            if ( bytesp( result ) ) {
+                memcpy( bytes_data( result ), buffer, length );
+            }
+        }
+        free( buffer );
+
+        debug_printf( DEBUG_IO, L"read-bytes: read %lu bytes\n", length );
+    }
+
+    return result;
+}
+
+/**
+ * Function: write the raw bytes of the byte buffer which is arg 0 to the
+ * write stream indicated by arg 1.
+ *
+ * * (write-bytes buffer stream)
+ *
+ * @param frame my stack_frame.
+ * @param frame_pointer a pointer to my stack_frame.
+ * @param env my environment.
+ * @return the number of bytes written.
+ * @exception if `buffer` is not a byte buffer, or `stream` is not a write
+ * stream.
+ */
+struct cons_pointer
+lisp_write_bytes( struct stack_frame *frame, struct cons_pointer frame_pointer,
+                  struct cons_pointer env ) {
+    struct cons_pointer result = NIL;
+
+    if ( !bytesp( frame->arg[0] ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"write-bytes" ),
+                                  c_string_to_lisp_string
+                                  ( L"Expected a byte buffer" ),
+                                  frame_pointer );
+    } else if ( !writep( frame->arg[1] ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"write-bytes" ),
+                                  c_string_to_lisp_string
+                                  ( L"Expected a write stream" ),
+                                  frame_pointer );
+    } else {
+        result =
+            acquire_integer( url_fwrite
+                             ( bytes_data( frame->arg[0] ), 1,
+                               bytes_length( frame->arg[0] ),
+                               pointer2cell( frame->arg[1] ).payload.
+                               stream.stream ), NIL );
+    }
+
+    return result;
+}
+
 /**
  * Function: return a string representing all characters from the stream
  * indicated by arg 0; further arguments are ignored.
@@ -526,8 +664,8 @@ lisp_read_char( struct stack_frame *frame, struct cons_pointer frame_pointer,
  * @param frame my stack_frame.
  * @param frame_pointer a pointer to my stack_frame.
  * @param env my environment.
- * @return a string of one character, namely the next available character
- * on my stream, if any, else NIL.
+ * @return a packed string of all the characters remaining on my stream, if
+ * it is a read stream, else NIL.
  */
 struct cons_pointer
 lisp_slurp( struct stack_frame *frame, struct cons_pointer frame_pointer,
@@ -536,21 +674,22 @@ lisp_slurp( struct stack_frame *frame, struct cons_pointer frame_pointer,
 
     if ( readp( frame->arg[0] ) ) {
         URL_FILE *stream = pointer2cell( frame->arg[0] ).payload.stream.stream;
-        struct cons_pointer cursor = make_string( url_fgetwc( stream ), NIL );
-        result = cursor;
+        uint64_t capacity = 4096;
+        uint64_t length = 0;
+        wchar_t *buffer = malloc( capacity * sizeof( wchar_t ) );
 
         for ( wint_t c = url_fgetwc( stream ); !url_feof( stream ) && c != 0;
               c = url_fgetwc( stream ) ) {
-            debug_print( L"slurp: cursor is: ", DEBUG_IO );
-            debug_dump_object( cursor, DEBUG_IO );
-            debug_print( L"; result is: ", DEBUG_IO );
-            debug_dump_object( result, DEBUG_IO );
-            debug_println( DEBUG_IO );
-
-            struct cons_space_object *cell = &pointer2cell( cursor );
-            cursor = make_string( ( wchar_t ) c, NIL );
-            cell->payload.string.cdr = cursor;
+            if ( length == capacity ) {
+                capacity *= 2;
+                buffer = realloc( buffer, capacity * sizeof( wchar_t ) );
+            }
+            buffer[length++] = ( wchar_t ) c;
         }
+
+        debug_printf( DEBUG_IO, L"slurp: read %lu characters\n", length );
+        result = make_pstring( buffer, length );
+        free( buffer );
     }
 
     return result;
@@ -39,8 +39,15 @@ struct cons_pointer
 lisp_read_char( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 struct cons_pointer env );
 struct cons_pointer
+lisp_read_bytes( struct stack_frame *frame, struct cons_pointer frame_pointer,
+                 struct cons_pointer env );
+struct cons_pointer
 lisp_slurp( struct stack_frame *frame, struct cons_pointer frame_pointer,
             struct cons_pointer env );
 
+struct cons_pointer
+lisp_write_bytes( struct stack_frame *frame, struct cons_pointer frame_pointer,
+                  struct cons_pointer env );
+
 char *lisp_string_to_c_string( struct cons_pointer s );
 #endif
@@ -17,14 +17,19 @@
 #include <wchar.h>
 #include <wctype.h>
 
+#include "arith/array.h"
 #include "arith/integer.h"
 #include "debug.h"
 #include "io/io.h"
 #include "io/print.h"
+#include "memory/bytes.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
+#include "memory/hamt.h"
 #include "memory/hashmap.h"
+#include "memory/pstring.h"
 #include "memory/stack.h"
+#include "memory/vector.h"
 #include "memory/vectorspace.h"
 #include "ops/intern.h"
 #include "time/psse_time.h"
@@ -35,6 +40,14 @@
  * don't print anything but just return.
  */
 void print_string_contents( URL_FILE *output, struct cons_pointer pointer ) {
+    if ( pstringp( pointer ) ) {
+        struct pstring_payload *payload = pstring_payload( pointer );
+
+        for ( uint64_t i = 0; i < payload->length; i++ ) {
+            url_fputwc( payload->characters[i], output );
+        }
+    }
+
     while ( stringp( pointer ) || symbolp( pointer ) || keywordp( pointer ) ) {
         struct cons_space_object *cell = &pointer2cell( pointer );
         wchar_t c = cell->payload.string.character;
@@ -67,7 +80,7 @@ print_list_contents( URL_FILE *output, struct cons_pointer pointer,
                      bool initial_space ) {
     struct cons_space_object *cell = &pointer2cell( pointer );
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( pointer ).value ) {
         case CONSTV:
             if ( initial_space ) {
                 url_fputwc( btowc( ' ' ), output );
@@ -92,19 +105,24 @@ void print_list( URL_FILE *output, struct cons_pointer pointer ) {
 
 void print_map( URL_FILE *output, struct cons_pointer map ) {
     if ( hashmapp( map ) ) {
-        struct vector_space_object *vso = pointer_to_vso( map );
+        struct hashmap_payload *payload =
+            &pointer_to_vso( map )->payload.hashmap;
+        bool first = true;
 
         url_fputwc( btowc( '{' ), output );
 
-        for ( struct cons_pointer ks = hashmap_keys( map ); !nilp( ks );
-              ks = c_cdr( ks ) ) {
-            struct cons_pointer key = c_car( ks );
-            print( output, key );
-            url_fputwc( btowc( ' ' ), output );
-            print( output, hashmap_get( map, key, false ) );
+        for ( uint32_t i = 0; i < payload->n_slots; i++ ) {
+            struct hashmap_slot *slot = &payload->slots[i];
 
-            if ( !nilp( c_cdr( ks ) ) ) {
-                url_fputws( L", ", output );
+            if ( !nilp( slot->key ) ) {
+                if ( !first ) {
+                    url_fputws( L", ", output );
+                }
+                first = false;
+
+                print( output, slot->key );
+                url_fputwc( btowc( ' ' ), output );
+                print( output, slot->value );
             }
         }
 
@@ -112,15 +130,46 @@ void print_map( URL_FILE *output, struct cons_pointer map ) {
     }
 }
 
+void print_vector( URL_FILE *output, struct cons_pointer vector ) {
+    uint64_t length = vector_length( vector );
+
+    url_fputwc( btowc( '[' ), output );
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        if ( i > 0 ) {
+            url_fputwc( btowc( ' ' ), output );
+        }
+        print( output, vector_get( vector, i ) );
+    }
+
+    url_fputwc( btowc( ']' ), output );
+}
+
 void print_vso( URL_FILE *output, struct cons_pointer pointer ) {
     struct vector_space_object *vso = pointer_to_vso( pointer );
     switch ( vso->header.tag.value ) {
+        case BYTESTV:
+            print_bytes( output, pointer );
+            break;
+        case HAMTTV:
+            print_hamt( output, pointer );
+            break;
         case HASHTV:
             print_map( output, pointer );
             break;
+        case INTARRAYTV:
+        case REALARRAYTV:
+            print_numeric_array( output, pointer );
+            break;
+        case PSTRINGTV:
+            print_string( output, pointer );
+            break;
         case STACKFRAMETV:
             dump_stack_trace( output, pointer );
             break;
+        case VECTORTV:
+            print_vector( output, pointer );
+            break;
             // \todo: others.
         default:
             fwprintf( stderr, L"Unrecognised vector-space type '%d'\n",
@@ -161,7 +210,7 @@ struct cons_pointer print( URL_FILE *output, struct cons_pointer pointer ) {
      * Because tags have values as well as bytes, this if ... else if
      * statement can ultimately be replaced by a switch, which will be neater.
      */
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( pointer ).value ) {
         case CONSTV:
             print_list( output, pointer );
             break;
@@ -270,7 +319,8 @@ struct cons_pointer print( URL_FILE *output, struct cons_pointer pointer ) {
         default:
             fwprintf( stderr,
                       L"Error: Unrecognised tag value %d (%4.4s)\n",
-                      cell.tag.value, &cell.tag.bytes[0] );
+                      pointer2tag( pointer ).value,
+                      &pointer2tag( pointer ).bytes[0] );
             // dump_object( stderr, pointer);
             break;
     }
@@ -312,7 +362,8 @@ lisp_print( struct stack_frame *frame, struct cons_pointer frame_pointer,
     debug_print( L"lisp_print: about to print\n", DEBUG_IO );
     debug_dump_object( frame->arg[0], DEBUG_IO );
 
-    result = print( output, frame->arg[0] );
+    /* `print` gives back its argument, which the caller must own */
+    result = inc_ref( print( output, frame->arg[0] ) );
 
     debug_print( L"lisp_print returning\n", DEBUG_IO );
     debug_dump_object( result, DEBUG_IO );
@@ -11,6 +11,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 /*
  * wide characters
  */
@@ -20,7 +21,9 @@
 #include "memory/consspaceobject.h"
 #include "debug.h"
 #include "memory/dump.h"
+#include "memory/hamt.h"
 #include "memory/hashmap.h"
+#include "memory/pstring.h"
 #include "arith/integer.h"
 #include "ops/intern.h"
 #include "io/io.h"
@@ -30,6 +33,7 @@
 #include "arith/ratio.h"
 #include "io/read.h"
 #include "arith/real.h"
+#include "memory/vector.h"
 #include "memory/vectorspace.h"
 
 // We can't, I think, use libreadline, because we read character by character, 
@@ -48,6 +52,7 @@
  * * numbers - either integer, ratio or real
  * * lists 
  * * maps
+ * * vectors
  * * keywords
  * * atoms
  */
@@ -64,6 +69,10 @@ struct cons_pointer read_map( struct stack_frame *frame,
                               struct cons_pointer frame_pointer,
                               struct cons_pointer env,
                               URL_FILE * input, wint_t initial );
+struct cons_pointer read_vector( struct stack_frame *frame,
+                                 struct cons_pointer frame_pointer,
+                                 struct cons_pointer env,
+                                 URL_FILE * input, wint_t initial );
 struct cons_pointer read_string( URL_FILE * input, wint_t initial );
 struct cons_pointer read_symbol_or_key( URL_FILE * input, uint32_t tag,
                                         wint_t initial );
@@ -198,6 +207,10 @@ struct cons_pointer read_continuation( struct stack_frame *frame,
                 result = read_map( frame, frame_pointer, env, input,
                                    url_fgetwc( input ) );
                 break;
+            case '[':
+                result = read_vector( frame, frame_pointer, env, input,
+                                      url_fgetwc( input ) );
+                break;
             case '"':
                 result = read_string( input, url_fgetwc( input ) );
                 break;
@@ -447,9 +460,9 @@ struct cons_pointer read_map( struct stack_frame *frame,
                               struct cons_pointer frame_pointer,
                               struct cons_pointer env,
                               URL_FILE *input, wint_t initial ) {
-    // set write ACL to true whilst creating to prevent GC churn
-    struct cons_pointer result =
-        make_hashmap( DFLT_HASHMAP_BUCKETS, NIL, TRUE );
+    // a map read has no write ACL, so is persistent: see hamt.c. It is
+    // filled in place, since nothing else yet holds it.
+    struct cons_pointer result = make_hamt( NIL, NIL );
     wint_t c = initial;
 
     while ( c != LCBRACE ) {
@@ -468,42 +481,99 @@ struct cons_pointer read_map( struct stack_frame *frame,
               c == LCOMMA || iswblank( c ) || iswcntrl( c );
               c = url_fgetwc( input ) );
 
-        result =
-            hashmap_put( result, key,
-                         eval_form( frame, frame_pointer, value, env ) );
+        struct cons_pointer val = eval_form( frame, frame_pointer, value, env );
+
+        result = hamt_fill( result, key, val );
+        dec_ref( val );
     }
 
-    // default write ACL for maps should be NIL.
-    pointer_to_vso( result )->payload.hashmap.write_acl = NIL;
+    return result;
+}
+
+/**
+ * Read a vector from this input stream, which no longer contains the
+ * opening left bracket. As with the values in a map, each element is
+ * evaluated as it is read.
+ */
+struct cons_pointer read_vector( struct stack_frame *frame,
+                                 struct cons_pointer frame_pointer,
+                                 struct cons_pointer env,
+                                 URL_FILE *input, wint_t initial ) {
+    struct cons_pointer elements = NIL;
+    struct cons_pointer result = NIL;
+    wint_t c;
+
+    for ( c = initial; iswblank( c ) || iswcntrl( c );
+          c = url_fgetwc( input ) );
+
+    while ( c != LRBRACKET && nilp( result ) ) {
+        struct cons_pointer element =
+            eval_form( frame, frame_pointer,
+                       read_continuation( frame, frame_pointer, env, input,
+                                          c ), env );
+
+        if ( exceptionp( element ) ) {
+            result = element;
+        } else {
+            struct cons_pointer more = make_cons( element, elements );
+
+            dec_ref( element );
+            dec_ref( elements );
+            elements = more;
+
+            /* skip whitespace */
+            for ( c = url_fgetwc( input ); iswblank( c ) || iswcntrl( c );
+                  c = url_fgetwc( input ) );
+        }
+    }
+
+    if ( nilp( result ) ) {
+        /* the elements were consed up in reverse order */
+        result = make_vector( c_length( elements ) );
+
+        if ( vectorp( result ) ) {
+            struct vector_payload *payload = vector_payload( result );
+            uint64_t i = payload->length;
+
+            for ( struct cons_pointer c = elements; !nilp( c );
+                  c = c_cdr( c ) ) {
+                payload->elements[--i] = inc_ref( c_car( c ) );
+            }
+        }
+    }
+    dec_ref( elements );
 
     return result;
 }
 
 /**
- * Read a string. This means either a string delimited by double quotes
- * (is_quoted == true), in which case it may contain whitespace but may
- * not contain a double quote character (unless escaped), or one not
- * so delimited in which case it may not contain whitespace (unless escaped)
- * but may contain a double quote character (probably not a good idea!)
+ * Read a string delimited by double quotes, of which the opening one has
+ * already been read, and `initial` is the character following it. It may
+ * contain whitespace but may not contain a double quote character.
+ *
+ * The characters are gathered into a buffer, and the string made from that
+ * is packed, rather than one character to a cell.
  */
 struct cons_pointer read_string( URL_FILE *input, wint_t initial ) {
-    struct cons_pointer cdr = NIL;
-    struct cons_pointer result;
-    switch ( initial ) {
-        case '\0':
-            result = NIL;
-            break;
-        case '"':
-            /* making a string of the null character means we can have an empty
-             * string. Just returning NIL here would make an empty string
-             * impossible. */
-            result = make_string( '\0', NIL );
-            break;
-        default:
-            result =
-                make_string( initial,
-                             read_string( input, url_fgetwc( input ) ) );
-            break;
+    struct cons_pointer result = NIL;
+
+    if ( initial != '\0' ) {
+        uint64_t capacity = 64;
+        uint64_t length = 0;
+        wchar_t *buffer = malloc( capacity * sizeof( wchar_t ) );
+
+        for ( wint_t c = initial; c != '"' && c != '\0' && c != WEOF;
+              c = url_fgetwc( input ) ) {
+            if ( length == capacity ) {
+                capacity *= 2;
+                buffer = realloc( buffer, capacity * sizeof( wchar_t ) );
+            }
+            buffer[length++] = ( wchar_t ) c;
+        }
+
+        /* an empty string is a packed string of no characters, not NIL */
+        result = make_pstring( buffer, length );
+        free( buffer );
     }
 
     return result;
@@ -521,11 +591,12 @@ struct cons_pointer read_symbol_or_key( URL_FILE *input, uint32_t tag,
         case '\'':
             /* unwise to allow embedded quotation marks in symbols */
         case ')':
+        case ']':
         case ':':
         case '/':
             /*
-             * symbols and keywords may not include right-parenthesis,
-             * slashes or colons.
+             * symbols and keywords may not include right-parentheses,
+             * right-brackets, slashes or colons.
              */
             result = NIL;
             /*
@@ -19,6 +19,8 @@
 #define LSLASH L'/'
 /* ... used in map representations */
 #define LCBRACE L'}'
+/* ... used in vector representations */
+#define LRBRACKET L']'
 /* ... used in path representations */
 #define LSESSION L'§'
 
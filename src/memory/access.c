@@ -0,0 +1,256 @@
+/*
+ * access.c
+ *
+ * The access control lists of cons space objects, held in a sparse side
+ * table keyed by the address of the cell. The table is an open addressed
+ * hash table with linear probing; a slot is empty if its access control
+ * list is NIL, so NIL is never stored.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "debug.h"
+#include "io/fopen.h"
+#include "memory/access.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * A slot in the access table.
+ */
+struct access_slot {
+    /** the cell whose access control list this is */
+    struct cons_pointer cell;
+    /** its access control list, or NIL if the slot is empty */
+    struct cons_pointer acl;
+};
+
+/**
+ * The number of cells which have access control lists. Read without the
+ * lock, so that the common case of a cell with none costs only this test.
+ */
+uint32_t access_entries = 0;
+
+/**
+ * The table itself; `access_slots` is always zero or a power of two.
+ */
+static struct access_slot *access_table = NULL;
+
+static uint32_t access_slots = 0;
+
+static pthread_mutex_t access_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @return the slot at which a search for the cell at this `pointer` should
+ * start.
+ */
+static uint32_t access_home( struct cons_pointer pointer ) {
+    uint64_t key = ( ( uint64_t ) pointer.page << 32 ) | pointer.offset;
+
+    return ( uint32_t ) ( ( key * 0x9E3779B97F4A7C15ULL ) >> 32 ) &
+        ( access_slots - 1 );
+}
+
+/**
+ * @return the index of the slot holding the access control list of the
+ * cell at this `pointer`, or of the empty slot at which it would be
+ * stored. The caller must hold the lock, and the table must exist.
+ */
+static uint32_t access_find( struct cons_pointer pointer ) {
+    uint32_t i = access_home( pointer );
+
+    while ( !nilp( access_table[i].acl ) &&
+            !( access_table[i].cell.page == pointer.page &&
+               access_table[i].cell.offset == pointer.offset ) ) {
+        i = ( i + 1 ) & ( access_slots - 1 );
+    }
+
+    return i;
+}
+
+/**
+ * Ensure that there is room in the table for one more entry, keeping the
+ * load factor at or below three quarters. The caller must hold the lock.
+ *
+ * @return true if there is room, else false.
+ */
+static bool access_ensure_room(  ) {
+    bool result = true;
+
+    if ( ( access_entries + 1 ) * 4 > access_slots * 3 ) {
+        struct access_slot *old_table = access_table;
+        uint32_t old_slots = access_slots;
+        uint32_t slots = old_slots == 0 ? ACCESS_TABLE_INITIAL_SLOTS :
+            old_slots * 2;
+        struct access_slot *table =
+            calloc( slots, sizeof( struct access_slot ) );
+
+        if ( table == NULL ) {
+            result = false;
+        } else {
+            access_table = table;
+            access_slots = slots;
+
+            for ( uint32_t i = 0; i < old_slots; i++ ) {
+                if ( !nilp( old_table[i].acl ) ) {
+                    access_table[access_find( old_table[i].cell )] =
+                        old_table[i];
+                }
+            }
+
+            free( old_table );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Remove the entry in this slot, closing up the run of entries after it so
+ * that no search is cut short. The caller must hold the lock.
+ */
+static void access_remove_slot( uint32_t i ) {
+    uint32_t j = i;
+
+    access_table[i].acl = NIL;
+
+    while ( true ) {
+        j = ( j + 1 ) & ( access_slots - 1 );
+
+        if ( nilp( access_table[j].acl ) ) {
+            break;
+        }
+
+        uint32_t home = access_home( access_table[j].cell );
+
+        /* move the entry at `j` back to `i` unless its home lies
+         * cyclically in ( i, j ] */
+        if ( ( j > i && ( home <= i || home > j ) ) ||
+             ( j < i && ( home <= i && home > j ) ) ) {
+            access_table[i] = access_table[j];
+            access_table[j].acl = NIL;
+            i = j;
+        }
+    }
+
+    access_entries--;
+}
+
+/**
+ * @return the access control list of the cell at this `pointer`, or NIL if
+ * it has none.
+ */
+struct cons_pointer get_access( struct cons_pointer pointer ) {
+    struct cons_pointer result = NIL;
+
+    if ( access_entries > 0 ) {
+        pthread_mutex_lock( &access_lock );
+
+        if ( access_slots > 0 ) {
+            result = access_table[access_find( pointer )].acl;
+        }
+
+        pthread_mutex_unlock( &access_lock );
+    }
+
+    return result;
+}
+
+/**
+ * Set the access control list of the cell at this `pointer` to this `acl`,
+ * or, if `acl` is NIL, remove any it has. The table holds a reference to
+ * `acl`, which is given up when the list is replaced or the cell is freed.
+ */
+void set_access( struct cons_pointer pointer, struct cons_pointer acl ) {
+    struct cons_pointer old = NIL;
+
+    pthread_mutex_lock( &access_lock );
+
+    if ( nilp( acl ) ) {
+        if ( access_entries > 0 ) {
+            uint32_t i = access_find( pointer );
+
+            old = access_table[i].acl;
+            if ( !nilp( old ) ) {
+                access_remove_slot( i );
+            }
+        }
+    } else if ( access_ensure_room(  ) ) {
+        uint32_t i = access_find( pointer );
+
+        old = access_table[i].acl;
+        if ( nilp( old ) ) {
+            access_entries++;
+        }
+        access_table[i].cell = pointer;
+        access_table[i].acl = inc_ref( acl );
+    }
+
+    pthread_mutex_unlock( &access_lock );
+
+    dec_ref( old );
+}
+
+/**
+ * Remove any access control list of the cell at this `pointer` from the
+ * table, without giving up the table's reference to it; for use when the
+ * cell is being freed.
+ *
+ * @return the access control list the cell had, or NIL.
+ */
+struct cons_pointer forget_access( struct cons_pointer pointer ) {
+    struct cons_pointer result = NIL;
+
+    if ( access_entries > 0 ) {
+        pthread_mutex_lock( &access_lock );
+
+        if ( access_entries > 0 ) {
+            uint32_t i = access_find( pointer );
+
+            result = access_table[i].acl;
+            if ( !nilp( result ) ) {
+                access_remove_slot( i );
+            }
+        }
+
+        pthread_mutex_unlock( &access_lock );
+    }
+
+    return result;
+}
+
+/**
+ * Apply this function `fn` to each access control list in the table,
+ * passing it also this `data`. The function must not change the table.
+ */
+void for_each_access( void ( *fn ) ( struct cons_pointer, void * ),
+                      void *data ) {
+    if ( access_entries > 0 ) {
+        pthread_mutex_lock( &access_lock );
+
+        for ( uint32_t i = 0; i < access_slots; i++ ) {
+            if ( !nilp( access_table[i].acl ) ) {
+                fn( access_table[i].acl, data );
+            }
+        }
+
+        pthread_mutex_unlock( &access_lock );
+    }
+}
+
+/**
+ * Print the size of the access table to this `output` stream.
+ */
+void summarise_access( URL_FILE *output ) {
+    url_fwprintf( output,
+                  L"Access control lists: %u cells have them; table of %u slots, %lu bytes.\n",
+                  access_entries, access_slots,
+                  ( unsigned long ) access_slots *
+                  sizeof( struct access_slot ) );
+}
@@ -0,0 +1,39 @@
+/*
+ * access.h
+ *
+ * The access control lists of cons space objects. Very few cells will
+ * ever have an access control list of their own, so rather than each
+ * cell carrying a pointer to one, they are held in a sparse side table
+ * keyed by the address of the cell.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_access_h
+#define __psse_access_h
+
+#include <stdint.h>
+
+#include "io/fopen.h"
+#include "memory/consspaceobject.h"
+
+/**
+ * The initial number of slots in the access table; always a power of two.
+ */
+#define ACCESS_TABLE_INITIAL_SLOTS 64
+
+extern uint32_t access_entries;
+
+struct cons_pointer get_access( struct cons_pointer pointer );
+
+void set_access( struct cons_pointer pointer, struct cons_pointer acl );
+
+struct cons_pointer forget_access( struct cons_pointer pointer );
+
+void for_each_access( void ( *fn ) ( struct cons_pointer, void * ),
+                      void *data );
+
+void summarise_access( URL_FILE * output );
+
+#endif
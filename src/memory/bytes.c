@@ -0,0 +1,424 @@
+/*
+ * bytes.c
+ *
+ * Byte buffers: runs of raw bytes held contiguously in vector space, at a
+ * cost of one object however many bytes there are, rather than one cell
+ * to each character as a cell string would cost. They are made by
+ * `read-bytes` and written by `write-bytes`, which see io.c, and converted
+ * to and from strings as UTF-8.
+ *
+ * A slice of a byte buffer copies nothing: it points into the bytes of
+ * the buffer it was cut from, and holds a reference to that buffer so that
+ * those bytes live as long as it does. A slice of a slice points into the
+ * original buffer. Byte buffers, like packed strings, are not changed once
+ * made, so a slice always sees the same bytes as its buffer.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#include "arith/integer.h"
+#include "debug.h"
+#include "io/io.h"
+#include "memory/bytes.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/pstring.h"
+#include "memory/vectorspace.h"
+#include "ops/lispops.h"
+
+/**
+ * The character put in place of any sequence of bytes which is not UTF-8.
+ */
+#define REPLACEMENT_CHARACTER 0xfffd
+
+/**
+ * Make a byte buffer with room for this `length` of bytes, all zero.
+ *
+ * @return the buffer, or an exception if memory is exhausted.
+ */
+struct cons_pointer make_bytes( uint64_t length ) {
+    struct cons_pointer result =
+        make_vso( BYTESTV, sizeof( struct bytes_payload ) + length );
+
+    if ( nilp( result ) ) {
+        result = make_exception( privileged_string_memory_exhausted, NIL );
+    } else {
+        /* make_vso has zeroed the bytes, and `base` is NIL */
+        struct bytes_payload *payload = bytes_payload( result );
+
+        payload->length = length;
+        payload->bytes = payload->data;
+    }
+
+    return result;
+}
+
+/**
+ * Give up the reference which the byte buffer indicated by this `pointer`
+ * holds to the buffer it is a slice of, if it is a slice.
+ */
+void free_bytes( struct cons_pointer pointer ) {
+    if ( bytesp( pointer ) ) {
+        dec_ref( bytes_payload( pointer )->base );
+    } else {
+        debug_printf( DEBUG_ALLOC,
+                      L"Non-byte-buffer passed to `free_bytes`\n" );
+    }
+}
+
+/**
+ * @return the number of bytes in the byte buffer indicated by this
+ * `pointer`, or zero if it is not a byte buffer.
+ */
+uint64_t bytes_length( struct cons_pointer pointer ) {
+    return bytesp( pointer ) ? bytes_payload( pointer )->length : 0;
+}
+
+/**
+ * @return the first byte of the byte buffer indicated by this `pointer`,
+ * or NULL if it is not a byte buffer.
+ */
+uint8_t *bytes_data( struct cons_pointer pointer ) {
+    return bytesp( pointer ) ? bytes_payload( pointer )->bytes : NULL;
+}
+
+/**
+ * @return the byte at this zero-based `index` of the byte buffer indicated
+ * by this `pointer`, as an integer; or `NIL` if it is not a byte buffer or
+ * has no such byte.
+ */
+struct cons_pointer bytes_get( struct cons_pointer pointer, uint64_t index ) {
+    return index < bytes_length( pointer ) ?
+        acquire_integer( bytes_data( pointer )[index], NIL ) : NIL;
+}
+
+/**
+ * Make a slice of this `length` of the byte buffer indicated by this
+ * `pointer`, starting at this zero-based `offset`, which shares its bytes
+ * rather than copying them. The caller must see that the slice lies
+ * within the buffer.
+ *
+ * @return the slice, or an exception if memory is exhausted.
+ */
+struct cons_pointer bytes_slice( struct cons_pointer pointer,
+                                 uint64_t offset, uint64_t length ) {
+    struct cons_pointer result = make_vso( BYTESTV,
+                                           sizeof( struct bytes_payload ) );
+
+    if ( nilp( result ) ) {
+        result = make_exception( privileged_string_memory_exhausted, NIL );
+    } else {
+        struct bytes_payload *from = bytes_payload( pointer );
+        struct bytes_payload *payload = bytes_payload( result );
+        /* a slice of a slice shares the bytes of the original */
+        struct cons_pointer base = nilp( from->base ) ? pointer : from->base;
+
+        payload->length = length;
+        payload->bytes = from->bytes + offset;
+        payload->base = base;
+        inc_ref( base );
+    }
+
+    return result;
+}
+
+/**
+ * Encode this `character` as UTF-8 into `out`, if `out` is not NULL.
+ *
+ * @return the number of bytes the encoding takes.
+ */
+static int encode_character( wchar_t character, uint8_t *out ) {
+    uint32_t c = ( uint32_t ) character;
+    int result;
+
+    if ( c > 0x10ffff || ( c >= 0xd800 && c <= 0xdfff ) ) {
+        c = REPLACEMENT_CHARACTER;
+    }
+
+    if ( c < 0x80 ) {
+        result = 1;
+        if ( out != NULL ) {
+            out[0] = c;
+        }
+    } else if ( c < 0x800 ) {
+        result = 2;
+        if ( out != NULL ) {
+            out[0] = 0xc0 | ( c >> 6 );
+            out[1] = 0x80 | ( c & 0x3f );
+        }
+    } else if ( c < 0x10000 ) {
+        result = 3;
+        if ( out != NULL ) {
+            out[0] = 0xe0 | ( c >> 12 );
+            out[1] = 0x80 | ( ( c >> 6 ) & 0x3f );
+            out[2] = 0x80 | ( c & 0x3f );
+        }
+    } else {
+        result = 4;
+        if ( out != NULL ) {
+            out[0] = 0xf0 | ( c >> 18 );
+            out[1] = 0x80 | ( ( c >> 12 ) & 0x3f );
+            out[2] = 0x80 | ( ( c >> 6 ) & 0x3f );
+            out[3] = 0x80 | ( c & 0x3f );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Encode the characters of this `string`, whether packed or made of cells,
+ * but not the null character which ends a cell string read by the reader,
+ * as UTF-8 into `out`, if `out` is not NULL.
+ *
+ * @return the number of bytes the encoding takes.
+ */
+static uint64_t encode_string( struct cons_pointer string, uint8_t *out ) {
+    uint64_t result = 0;
+    uint64_t length = pstring_length( string );
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        result += encode_character( pstring_payload( string )->characters[i],
+                                    out == NULL ? NULL : out + result );
+    }
+
+    for ( struct cons_pointer c = string; stringp( c );
+          c = pointer2cell( c ).payload.string.cdr ) {
+        wchar_t character = pointer2cell( c ).payload.string.character;
+
+        if ( character != L'\0' ) {
+            result += encode_character( character,
+                                        out == NULL ? NULL : out + result );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a new byte buffer of the characters of this `string`, whether
+ * packed or made of cells, encoded as UTF-8; or an exception if memory is
+ * exhausted.
+ */
+struct cons_pointer string_to_bytes( struct cons_pointer string ) {
+    struct cons_pointer result = make_bytes( encode_string( string, NULL ) );
+
+    if ( bytesp( result ) ) {
+        encode_string( string, bytes_data( result ) );
+    }
+
+    return result;
+}
+
+/**
+ * Decode one character from the `n` bytes at `in`, as UTF-8, into
+ * `character`. A byte which does not start a well formed sequence, or
+ * which starts one which is cut short, decodes as the replacement
+ * character.
+ *
+ * @return the number of bytes used, which is at least one.
+ */
+static int decode_character( const uint8_t *in, uint64_t n,
+                             wchar_t *character ) {
+    uint32_t c = in[0];
+    int length = c < 0x80 ? 1 : c < 0xc2 ? 0 : c < 0xe0 ? 2 :
+        c < 0xf0 ? 3 : c < 0xf5 ? 4 : 0;
+    int result = 1;
+
+    *character = REPLACEMENT_CHARACTER;
+
+    if ( length == 1 ) {
+        *character = c;
+    } else if ( length > 1 && length <= n ) {
+        c &= 0x7f >> length;
+        for ( result = 1; result < length && ( in[result] & 0xc0 ) == 0x80;
+              result++ ) {
+            c = ( c << 6 ) | ( in[result] & 0x3f );
+        }
+
+        if ( result == length ) {
+            /* reject overlong encodings, surrogates and those too large */
+            uint32_t least = length == 2 ? 0x80 : length == 3 ? 0x800 :
+                0x10000;
+
+            if ( c >= least && c <= 0x10ffff && !( c >= 0xd800 &&
+                                                  c <= 0xdfff ) ) {
+                *character = c;
+            } else {
+                result = 1;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a new packed string of the bytes of the byte buffer indicated by
+ * this `pointer`, decoded as UTF-8; or an exception if memory is exhausted.
+ */
+struct cons_pointer bytes_to_string( struct cons_pointer pointer ) {
+    uint64_t n = bytes_length( pointer );
+    const uint8_t *in = bytes_data( pointer );
+    /* there cannot be more characters than bytes */
+    wchar_t *characters = malloc( ( n + 1 ) * sizeof( wchar_t ) );
+    uint64_t length = 0;
+    struct cons_pointer result = NIL;
+
+    if ( characters == NULL ) {
+        result = make_exception( privileged_string_memory_exhausted, NIL );
+    } else {
+        uint64_t i = 0;
+
+        while ( i < n ) {
+            i += decode_character( in + i, n - i, characters + length++ );
+        }
+
+        result = make_pstring( characters, length );
+        free( characters );
+    }
+
+    return result;
+}
+
+/**
+ * @return true if byte buffers `a` and `b` have the same bytes in the same
+ * order, else false.
+ */
+bool equal_bytes( struct cons_pointer a, struct cons_pointer b ) {
+    uint64_t length = bytes_length( a );
+
+    return bytesp( a ) && bytesp( b ) && length == bytes_length( b ) &&
+        memcmp( bytes_data( a ), bytes_data( b ), length ) == 0;
+}
+
+/**
+ * Print the byte buffer indicated by this `pointer` to this `output`
+ * stream, as `#b[104 105]`.
+ */
+void print_bytes( URL_FILE *output, struct cons_pointer pointer ) {
+    uint64_t length = bytes_length( pointer );
+    uint8_t *bytes = bytes_data( pointer );
+
+    url_fputws( L"#b[", output );
+
+    for ( uint64_t i = 0; i < length; i++ ) {
+        if ( i > 0 ) {
+            url_fputwc( L' ', output );
+        }
+        url_fwprintf( output, L"%u", ( unsigned int ) bytes[i] );
+    }
+
+    url_fputwc( L']', output );
+}
+
+/**
+ * @return true if this `pointer` indicates an integer which is neither
+ * negative nor a bignum, else false.
+ */
+static bool indexp( struct cons_pointer pointer ) {
+    return integerp( pointer ) &&
+        nilp( pointer2cell( pointer ).payload.integer.more ) &&
+        pointer2cell( pointer ).payload.integer.value >= 0;
+}
+
+/**
+ * Function: return a slice of a byte buffer, which shares its bytes rather
+ * than copying them.
+ *
+ * * (byte-slice buffer offset)
+ * * (byte-slice buffer offset length)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return the `length` bytes of `buffer` from `offset`, counting from zero,
+ * or all those from `offset` to the end if no `length` is given.
+ * @exception if `buffer` is not a byte buffer, or `offset` or `length` is
+ * not a non-negative integer, or the slice would not lie within `buffer`.
+ */
+struct cons_pointer lisp_byte_slice( struct stack_frame *frame,
+                                     struct cons_pointer frame_pointer,
+                                     struct cons_pointer env ) {
+    struct cons_pointer buffer = frame->arg[0];
+    struct cons_pointer result = NIL;
+
+    if ( !bytesp( buffer ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"byte-slice" ),
+                                  c_string_to_lisp_string
+                                  ( L"Expected a byte buffer" ),
+                                  frame_pointer );
+    } else if ( !indexp( frame->arg[1] ) ||
+                !( nilp( frame->arg[2] ) || indexp( frame->arg[2] ) ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"byte-slice" ),
+                                  c_string_to_lisp_string
+                                  ( L"Offset and length must be non-negative integers" ),
+                                  frame_pointer );
+    } else {
+        uint64_t available = bytes_length( buffer );
+        uint64_t offset = pointer2cell( frame->arg[1] ).payload.integer.value;
+        uint64_t length = nilp( frame->arg[2] ) ?
+            ( offset <= available ? available - offset : 0 ) :
+            pointer2cell( frame->arg[2] ).payload.integer.value;
+
+        if ( offset > available || length > available - offset ) {
+            result =
+                throw_exception( c_string_to_lisp_symbol( L"byte-slice" ),
+                                 c_string_to_lisp_string
+                                 ( L"Slice does not lie within the buffer" ),
+                                 frame_pointer );
+        } else {
+            result = bytes_slice( buffer, offset, length );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Function: return the string of which a byte buffer is the UTF-8 encoding.
+ * Bytes which are not well formed UTF-8 become the replacement character.
+ *
+ * * (bytes->string buffer)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return a packed string.
+ * @exception if `buffer` is not a byte buffer.
+ */
+struct cons_pointer lisp_bytes_to_string( struct stack_frame *frame,
+                                          struct cons_pointer frame_pointer,
+                                          struct cons_pointer env ) {
+    return bytesp( frame->arg[0] ) ? bytes_to_string( frame->arg[0] ) :
+        throw_exception( c_string_to_lisp_symbol( L"bytes->string" ),
+                         c_string_to_lisp_string
+                         ( L"Expected a byte buffer" ), frame_pointer );
+}
+
+/**
+ * Function: return a byte buffer of the UTF-8 encoding of a string.
+ *
+ * * (string->bytes string)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return a byte buffer.
+ * @exception if `string` is not a string.
+ */
+struct cons_pointer lisp_string_to_bytes( struct stack_frame *frame,
+                                          struct cons_pointer frame_pointer,
+                                          struct cons_pointer env ) {
+    return any_stringp( frame->arg[0] ) ? string_to_bytes( frame->arg[0] ) :
+        throw_exception( c_string_to_lisp_symbol( L"string->bytes" ),
+                         c_string_to_lisp_string
+                         ( L"Expected a string" ), frame_pointer );
+}
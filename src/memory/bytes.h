@@ -0,0 +1,61 @@
+/*
+ * bytes.h
+ *
+ * Byte buffers: runs of raw bytes held contiguously in vector space, as
+ * read from and written to streams without being decoded as characters,
+ * and slices of them, which share their bytes.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_bytes_h
+#define __psse_bytes_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "io/fopen.h"
+#include "memory/consspaceobject.h"
+#include "memory/vectorspace.h"
+
+/**
+ * @return the payload of the byte buffer indicated by this `pointer`,
+ * which must be a byte buffer.
+ */
+#define bytes_payload(pointer)(&(pointer_to_vso(pointer)->payload.bytebuffer))
+
+struct cons_pointer make_bytes( uint64_t length );
+
+void free_bytes( struct cons_pointer pointer );
+
+uint64_t bytes_length( struct cons_pointer pointer );
+
+uint8_t *bytes_data( struct cons_pointer pointer );
+
+struct cons_pointer bytes_get( struct cons_pointer pointer, uint64_t index );
+
+struct cons_pointer bytes_slice( struct cons_pointer pointer,
+                                 uint64_t offset, uint64_t length );
+
+struct cons_pointer string_to_bytes( struct cons_pointer string );
+
+struct cons_pointer bytes_to_string( struct cons_pointer pointer );
+
+bool equal_bytes( struct cons_pointer a, struct cons_pointer b );
+
+void print_bytes( URL_FILE * output, struct cons_pointer pointer );
+
+struct cons_pointer lisp_byte_slice( struct stack_frame *frame,
+                                     struct cons_pointer frame_pointer,
+                                     struct cons_pointer env );
+
+struct cons_pointer lisp_bytes_to_string( struct stack_frame *frame,
+                                          struct cons_pointer frame_pointer,
+                                          struct cons_pointer env );
+
+struct cons_pointer lisp_string_to_bytes( struct stack_frame *frame,
+                                          struct cons_pointer frame_pointer,
+                                          struct cons_pointer env );
+
+#endif
@@ -0,0 +1,892 @@
+/*
+ * collect.c
+ *
+ * Garbage collection to complement reference counting. Reference counting
+ * cannot reclaim structures which refer to themselves: environments
+ * captured by lambdas, hashmaps which contain themselves, exceptions which
+ * hold the stack frames in which they were thrown, and so on. This is a
+ * synchronous trial deletion collector over the whole of cons space and
+ * (through vector pointers) vector space, which finds cells whose
+ * references all come from other such cells, and reclaims them.
+ *
+ * Alternatively, memory may be managed by a non-moving mark-sweep collector
+ * alone, in which case reference counts are not maintained at all. The roots
+ * of that collector are the oblist, the privileged globals, locked cells,
+ * and whatever the caller passes, which at the outermost REPL between top
+ * level forms is everything which is live. That collector is generational:
+ * most collections are of the nursery alone, the cells allocated since the
+ * last collection, which are marked and swept without touching the rest of
+ * the heap. Cells are not moved; survivors are promoted by being tenured
+ * where they lie.
+ *
+ * The collectors assume that no other thread is allocating or freeing
+ * while they run.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arith/integer.h"
+#include "debug.h"
+#include "io/fopen.h"
+#include "memory/access.h"
+#include "memory/collect.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/stack.h"
+#include "memory/vectorspace.h"
+#include "io/io.h"
+#include "ops/intern.h"
+#include "ops/lispops.h"
+
+/**
+ * the size the heap must reach, in pages, before allocation pressure next
+ * triggers cycle collection.
+ */
+uint32_t cycle_collection_pages = DFLT_CYCLE_COLLECTION_PAGES;
+
+/**
+ * set when allocation pressure calls for cycle collection, which will then
+ * be done at the next safe point.
+ */
+bool cycle_collection_wanted = false;
+
+/**
+ * the number of collections done, and the number of cells recovered by
+ * them.
+ */
+uint64_t cycle_collections = 0;
+uint64_t cycle_cells_recovered = 0;
+
+/**
+ * the number of mark-sweep collections done, the number of cells recovered
+ * by them, and the time they took; likewise of those which collected only
+ * the nursery; and the number of pages either reset wholesale.
+ */
+uint64_t mark_sweep_collections = 0;
+uint64_t mark_sweep_cells_recovered = 0;
+uint64_t mark_sweep_ns = 0;
+uint64_t nursery_collections = 0;
+uint64_t nursery_cells_recovered = 0;
+uint64_t nursery_ns = 0;
+uint64_t cons_pages_reset = 0;
+
+/**
+ * the number of pages' worth of cells which may be allocated, when memory
+ * is managed by mark-sweep, before the nursery is next collected; 0 if the
+ * nursery is never collected alone.
+ */
+uint32_t nursery_pages = DFLT_NURSERY_PAGES;
+
+/**
+ * set when enough cells have been allocated since the last mark-sweep
+ * collection that the nursery should be collected at the next safe point.
+ */
+bool nursery_collection_wanted = false;
+
+/**
+ * the total number of cells allocated, as last noted, and as it was at the
+ * last mark-sweep collection.
+ */
+uint64_t cells_allocated_noted = 0;
+uint64_t cells_allocated_at_collection = 0;
+
+/**
+ * Per-page working state for a collection: for each cell, its trial
+ * reference count and whether it has been marked as live.
+ */
+struct collection_page {
+    uint32_t *trial;
+    uint8_t *live;
+};
+
+/**
+ * A simple growable stack of cons pointers.
+ */
+struct pointer_stack {
+    struct cons_pointer *pointers;
+    uint64_t count;
+    uint64_t capacity;
+};
+
+/**
+ * Push this `pointer` onto this `stack`.
+ *
+ * @return true if successful, false if we ran out of memory.
+ */
+bool push_pointer( struct pointer_stack *stack, struct cons_pointer pointer ) {
+    bool result = true;
+
+    if ( stack->count == stack->capacity ) {
+        uint64_t capacity = stack->capacity == 0 ? 1024 : stack->capacity * 2;
+        struct cons_pointer *pointers = realloc( stack->pointers,
+                                                 capacity *
+                                                 sizeof( struct
+                                                         cons_pointer ) );
+
+        if ( pointers == NULL ) {
+            result = false;
+        } else {
+            stack->pointers = pointers;
+            stack->capacity = capacity;
+        }
+    }
+
+    if ( result ) {
+        stack->pointers[stack->count++] = pointer;
+    }
+
+    return result;
+}
+
+/**
+ * Apply this function `fn` to each of the cells to which the cell at this
+ * `pointer` holds a counted reference, passing it also this `data`. The
+ * references visited here must be kept in step with those dropped by
+ * `reclaim_cell()` in `conspage.c` (and, for vector space objects, by
+ * `free_vso()`).
+ */
+void for_each_child( struct cons_pointer pointer,
+                     void ( *fn ) ( struct cons_pointer, void * ),
+                     void *data ) {
+    struct cons_space_object *cell = &pointer2cell( pointer );
+    struct cons_pointer acl = get_access( pointer );
+
+    if ( !nilp( acl ) ) {
+        fn( acl, data );
+    }
+
+    switch ( pointer2tag( pointer ).value ) {
+        case CONSTV:
+            fn( cell->payload.cons.car, data );
+            fn( cell->payload.cons.cdr, data );
+            break;
+        case EXCEPTIONTV:
+            fn( cell->payload.exception.payload, data );
+            fn( cell->payload.exception.frame, data );
+            break;
+        case FUNCTIONTV:
+            fn( cell->payload.function.meta, data );
+            break;
+        case INTEGERTV:
+            fn( cell->payload.integer.more, data );
+            break;
+        case LAMBDATV:
+        case NLAMBDATV:
+            fn( cell->payload.lambda.args, data );
+            fn( cell->payload.lambda.body, data );
+            break;
+        case RATIOTV:
+            fn( cell->payload.ratio.dividend, data );
+            fn( cell->payload.ratio.divisor, data );
+            break;
+        case READTV:
+        case WRITETV:
+            fn( cell->payload.stream.meta, data );
+            break;
+        case SPECIALTV:
+            fn( cell->payload.special.meta, data );
+            break;
+        case KEYTV:
+        case STRINGTV:
+        case SYMBOLTV:
+            fn( cell->payload.string.cdr, data );
+            break;
+        case VECTORPOINTTV:{
+                struct vector_space_object *vso =
+                    cell->payload.vectorp.address;
+
+                switch ( vso->header.tag.value ) {
+                    case BYTESTV:
+                        fn( vso->payload.bytebuffer.base, data );
+                        break;
+                    case HAMTTV:
+                        fn( vso->payload.hamt.hash_fn, data );
+                        fn( vso->payload.hamt.write_acl, data );
+                        fn( vso->payload.hamt.root, data );
+                        break;
+                    case HAMTNODETV:
+                        for ( uint32_t i = 0;
+                              i < vso->payload.hamtnode.count; i++ ) {
+                            fn( vso->payload.hamtnode.entries[i].key, data );
+                            fn( vso->payload.hamtnode.entries[i].value, data );
+                        }
+                        break;
+                    case HASHTV:
+                        fn( vso->payload.hashmap.hash_fn, data );
+                        fn( vso->payload.hashmap.write_acl, data );
+                        for ( uint32_t i = 0;
+                              i < vso->payload.hashmap.n_slots; i++ ) {
+                            struct hashmap_slot *slot =
+                                &vso->payload.hashmap.slots[i];
+
+                            if ( !nilp( slot->key ) ) {
+                                fn( slot->key, data );
+                                fn( slot->value, data );
+                            }
+                        }
+                        break;
+                    case PSTRINGTV:
+                        fn( vso->payload.pstring.cells, data );
+                        break;
+                    case STACKFRAMETV:{
+                            struct stack_frame *frame =
+                                ( struct stack_frame * ) &vso->payload;
+
+                            for ( int i = 0; i < frame->slots; i++ ) {
+                                fn( frame->arg[i], data );
+                            }
+                        }
+                        break;
+                    case VECTORTV:
+                        for ( uint64_t i = 0;
+                              i < vso->payload.vector.length; i++ ) {
+                            fn( vso->payload.vector.elements[i], data );
+                        }
+                        break;
+                }
+            }
+            break;
+    }
+}
+
+/**
+ * @return the working state for the cell at this `pointer`.
+ */
+#define trial_count(pages, pointer) (pages[pointer.page].trial[pointer.offset])
+#define livep(pages, pointer) (pages[pointer.page].live[pointer.offset])
+
+/**
+ * @return true if the cell at this `pointer` is one the collector should
+ * consider at all: that is, it is neither free nor locked.
+ */
+bool collectablep( struct cons_pointer pointer ) {
+    return pointer2count( pointer ) != MAXREFERENCE &&
+        pointer2tag( pointer ).value != FREETV;
+}
+
+/**
+ * Child visitor for the first phase: remove from the trial count of this
+ * `child` the reference made to it by its parent.
+ */
+void subtract_internal_reference( struct cons_pointer child, void *data ) {
+    struct collection_page *pages = ( struct collection_page * ) data;
+
+    if ( collectablep( child ) && trial_count( pages, child ) > 0 ) {
+        trial_count( pages, child )--;
+    }
+}
+
+/**
+ * The state shared by the child visitor for the marking phase.
+ */
+struct mark_state {
+    struct collection_page *pages;
+    struct pointer_stack stack;
+    bool failed;
+    /** true if only the nursery is being collected, so that tenured cells
+     * are taken to be live, and are neither marked nor traced. */
+    bool nursery;
+};
+
+/**
+ * Child visitor for the marking phase: if this `child` has not yet been
+ * marked live, mark it and push it to have its own children marked.
+ */
+void mark_child_live( struct cons_pointer child, void *data ) {
+    struct mark_state *state = ( struct mark_state * ) data;
+
+    if ( collectablep( child ) && !( state->nursery && tenuredp( child ) )
+         && !livep( state->pages, child ) ) {
+        livep( state->pages, child ) = 1;
+
+        if ( !push_pointer( &state->stack, child ) ) {
+            state->failed = true;
+        }
+    }
+}
+
+/**
+ * Child visitor for the reclamation phase: note this `child` of a garbage
+ * cell if it is live, since its reference count must then be decremented.
+ */
+void note_live_child( struct cons_pointer child, void *data ) {
+    struct mark_state *state = ( struct mark_state * ) data;
+
+    if ( !collectablep( child ) || livep( state->pages, child ) ) {
+        if ( !push_pointer( &state->stack, child ) ) {
+            state->failed = true;
+        }
+    }
+}
+
+/**
+ * Note that the heap has grown to this number of `pages`; if that exceeds
+ * the threshold, ask for cycle collection at the next safe point, and
+ * double the threshold.
+ */
+void note_heap_growth( uint32_t pages ) {
+    if ( cycle_collection_pages > 0 && pages >= cycle_collection_pages ) {
+        cycle_collection_wanted = true;
+        cycle_collection_pages =
+            pages * 2 > pages ? pages * 2 : cycle_collection_pages;
+    }
+}
+
+/**
+ * Find and reclaim garbage cycles, by trial deletion:
+ *
+ * 1. take each cell's reference count as its trial count;
+ * 2. subtract from the trial count of each cell the references made to it
+ *    by other cells, so that what remains counts only references from
+ *    outside cons space (from C variables, or from locked cells);
+ * 3. mark as live every cell which still has a non-zero trial count, and
+ *    everything reachable from it;
+ * 4. every unmarked cell is garbage: referenced only by other garbage. Free
+ *    each, without cascading into the others, and then decrement the
+ *    counts of the live cells which garbage cells referred to.
+ *
+ * @return the number of cells recovered.
+ */
+uint64_t collect_cycles(  ) {
+    if ( !reference_counting ) {
+        /* without reference counts there are no trial counts to take */
+        return 0;
+    }
+
+    uint64_t recovered = 0;
+    uint32_t n_pages = initialised_cons_pages;
+    struct collection_page *pages =
+        calloc( n_pages, sizeof( struct collection_page ) );
+    struct mark_state state = { pages, { NULL, 0, 0 }, false };
+    bool ok = pages != NULL;
+
+    /* anything still waiting to be freed must be, first */
+    reclaim_pending_cells( 0 );
+
+    for ( uint32_t p = 0; ok && p < n_pages; p++ ) {
+        uint32_t n = conspages[p]->high_water;
+
+        pages[p].trial = malloc( n * sizeof( uint32_t ) + 1 );
+        pages[p].live = calloc( n + 1, sizeof( uint8_t ) );
+        ok = pages[p].trial != NULL && pages[p].live != NULL;
+
+        if ( ok ) {
+            struct cons_pointer first = { p, 0 };
+
+            memcpy( pages[p].trial, &pointer2count( first ),
+                    n * sizeof( uint32_t ) );
+        }
+    }
+
+    for ( uint32_t p = 0; ok && p < n_pages; p++ ) {
+        for ( uint32_t o = next_cell_in_use( p, 0 );
+              o < conspages[p]->high_water;
+              o = next_cell_in_use( p, o + 1 ) ) {
+            struct cons_pointer pointer = { p, o };
+
+            if ( collectablep( pointer ) ) {
+                for_each_child( pointer, &subtract_internal_reference,
+                                pages );
+            }
+        }
+    }
+
+    for ( uint32_t p = 0; ok && p < n_pages; p++ ) {
+        for ( uint32_t o = next_cell_in_use( p, 0 );
+              o < conspages[p]->high_water;
+              o = next_cell_in_use( p, o + 1 ) ) {
+            struct cons_pointer pointer = { p, o };
+
+            if ( collectablep( pointer ) && pages[p].trial[o] > 0
+                 && !pages[p].live[o] ) {
+                pages[p].live[o] = 1;
+                ok = push_pointer( &state.stack, pointer );
+
+                while ( ok && state.stack.count > 0 ) {
+                    for_each_child( state.stack.pointers
+                                    [--state.stack.count],
+                                    &mark_child_live, &state );
+                    ok = !state.failed;
+                }
+            }
+        }
+    }
+
+    if ( ok ) {
+        /* the live children of garbage cells; the stack is empty now */
+        for ( uint32_t p = 0; ok && p < n_pages; p++ ) {
+            for ( uint32_t o = next_cell_in_use( p, 0 );
+                  o < conspages[p]->high_water;
+                  o = next_cell_in_use( p, o + 1 ) ) {
+                struct cons_pointer pointer = { p, o };
+
+                if ( collectablep( pointer ) && !pages[p].live[o] ) {
+                    for_each_child( pointer, &note_live_child, &state );
+                    ok = !state.failed;
+                }
+            }
+        }
+    }
+
+    if ( ok ) {
+        for ( uint32_t p = 0; p < n_pages; p++ ) {
+            for ( uint32_t o = next_cell_in_use( p, 0 );
+                  o < conspages[p]->high_water;
+                  o = next_cell_in_use( p, o + 1 ) ) {
+                struct cons_pointer pointer = { p, o };
+
+                if ( collectablep( pointer ) && !pages[p].live[o] ) {
+                    struct cons_space_object *cell = &pointer2cell( pointer );
+
+                    debug_printf( DEBUG_ALLOC,
+                                  L"Collecting garbage cell of type %4.4s at %u, %u\n",
+                                  pointer2tag( pointer ).bytes, p, o );
+
+                    if ( readp( pointer ) || writep( pointer ) ) {
+                        url_fclose( cell->payload.stream.stream );
+                    } else if ( vectorpointp( pointer ) ) {
+                        release_vso( cell->payload.vectorp.address );
+                    }
+
+                    release_cell( pointer );
+                    recovered++;
+                }
+            }
+        }
+
+        for ( uint64_t i = 0; i < state.stack.count; i++ ) {
+            dec_ref( state.stack.pointers[i] );
+        }
+        reclaim_pending_cells( 0 );
+    } else {
+        debug_print( L"WARNING: out of memory while collecting cycles\n",
+                     DEBUG_ALLOC );
+    }
+
+    for ( uint32_t p = 0; pages != NULL && p < n_pages; p++ ) {
+        free( pages[p].trial );
+        free( pages[p].live );
+    }
+    free( pages );
+    free( state.stack.pointers );
+
+    cycle_collections++;
+    cycle_cells_recovered += recovered;
+    cycle_collection_wanted = false;
+
+    debug_printf( DEBUG_ALLOC, L"Cycle collection recovered %lu cells\n",
+                  recovered );
+
+    return recovered;
+}
+
+/**
+ * If allocation pressure has asked for cycle collection, do it now. To be
+ * called only at safe points.
+ */
+void maybe_collect_cycles(  ) {
+    if ( reference_counting && cycle_collection_wanted ) {
+        collect_cycles(  );
+    }
+}
+
+/**
+ * Mark as live everything reachable from this `root`, including the
+ * previous frames of stack frames, to which frames do not hold counted
+ * references. If the root is itself locked, or is tenured and only the
+ * nursery is being collected, it is not marked, but what it refers to is.
+ */
+void mark_reachable( struct cons_pointer root, struct mark_state *state ) {
+    struct pointer_stack *stack = &state->stack;
+
+    if ( collectablep( root ) && !( state->nursery && tenuredp( root ) ) ) {
+        mark_child_live( root, state );
+    } else if ( !check_tag( root, FREETV ) ) {
+        state->failed = !push_pointer( stack, root );
+    }
+
+    while ( !state->failed && stack->count > 0 ) {
+        struct cons_pointer next = stack->pointers[--stack->count];
+
+        for_each_child( next, &mark_child_live, state );
+
+        if ( check_tag( next, STACKFRAMETV ) ) {
+            mark_child_live( get_stack_frame( next )->previous, state );
+        }
+    }
+}
+
+/**
+ * Tenured cells which may since have been changed to refer to cells in the
+ * nursery: locked cells, and those of the few types which are changed after
+ * they are made (exceptions, streams, and vector pointers, whose vector
+ * space objects, such as hashmaps, may be changed at will). These are roots
+ * of a collection of the nursery. The list is rebuilt by each full
+ * collection, and added to by each collection of the nursery; an entry
+ * whose cell has since been freed, or reused, is harmless.
+ */
+struct pointer_stack remembered_cells = { NULL, 0, 0 };
+
+/**
+ * @return true if the cell at this `pointer` is one which, once tenured,
+ * must be remembered as a root of collections of the nursery.
+ */
+bool rememberedp( struct cons_pointer pointer ) {
+    switch ( pointer2tag( pointer ).value ) {
+        case EXCEPTIONTV:
+        case READTV:
+        case WRITETV:
+        case VECTORPOINTTV:
+            return true;
+    }
+
+    return pointer2count( pointer ) == MAXREFERENCE;
+}
+
+/**
+ * Child visitor to mark access control lists, which may be given to any
+ * cell at any time, as roots.
+ */
+void mark_access_root( struct cons_pointer acl, void *data ) {
+    mark_reachable( acl, ( struct mark_state * ) data );
+}
+
+/**
+ * Close or free whatever the garbage cell at this `pointer` holds outside
+ * cons space.
+ */
+void finalise_cell( struct cons_pointer pointer ) {
+    struct cons_space_object *cell = &pointer2cell( pointer );
+
+    debug_printf( DEBUG_ALLOC, L"Sweeping cell of type %4.4s at %u, %u\n",
+                  pointer2tag( pointer ).bytes, pointer.page,
+                  pointer.offset );
+
+    if ( readp( pointer ) || writep( pointer ) ) {
+        url_fclose( cell->payload.stream.stream );
+    } else if ( vectorpointp( pointer ) ) {
+        free_vso( pointer );
+    }
+}
+
+/**
+ * Sweep the page with this `index`, given the marks in `pages`: free every
+ * unmarked cell which is neither locked nor (if `nursery` is true) tenured,
+ * and tenure every marked cell, remembering those which must be. If every
+ * cell in use on the page is garbage, and the page is not owned by any
+ * thread, it is reset wholesale rather than freed cell by cell.
+ *
+ * @return the number of cells recovered.
+ */
+uint64_t sweep_cons_page( uint32_t index, struct collection_page *pages,
+                          bool nursery, uint64_t *live ) {
+    struct cons_page *page = conspages[index];
+    uint64_t recovered = 0;
+    bool wholesale = page->owner == 0 && index != 0;
+
+    for ( uint32_t o = next_cell_in_use( index, 0 );
+          wholesale && o < page->high_water;
+          o = next_cell_in_use( index, o + 1 ) ) {
+        struct cons_pointer pointer = { index, o };
+
+        wholesale = collectablep( pointer ) && !pages[index].live[o] &&
+            !( nursery && tenuredp( pointer ) );
+    }
+
+    for ( uint32_t o = next_cell_in_use( index, 0 ); o < page->high_water;
+          o = next_cell_in_use( index, o + 1 ) ) {
+        struct cons_pointer pointer = { index, o };
+
+        if ( !collectablep( pointer ) ) {
+            /* locked cells on pages which stay young are found by the
+             * next collection anyway */
+            if ( page->owner == 0
+                 && !push_pointer( &remembered_cells, pointer ) ) {
+                debug_print( L"WARNING: could not remember locked cell\n",
+                             DEBUG_ALLOC );
+            }
+        } else if ( pages[index].live[o] ) {
+            if ( !tenuredp( pointer ) ) {
+                pointer2count( pointer ) = TENURED;
+            }
+            if ( rememberedp( pointer )
+                 && !push_pointer( &remembered_cells, pointer ) ) {
+                debug_print( L"WARNING: could not remember cell\n",
+                             DEBUG_ALLOC );
+            }
+            ( *live )++;
+        } else if ( nursery && tenuredp( pointer ) ) {
+            ( *live )++;
+        } else {
+            finalise_cell( pointer );
+            if ( !wholesale ) {
+                release_cell( pointer );
+            }
+            recovered++;
+        }
+    }
+
+    if ( wholesale && recovered > 0 ) {
+        reset_cons_page( index );
+        cons_pages_reset++;
+    }
+
+    return recovered;
+}
+
+/**
+ * Mark everything reachable from the global roots, from locked cells, and
+ * from these `n_roots` `roots`, then sweep every unmarked cell onto the
+ * free lists, tenuring the survivors. If `nursery` is true, collect only
+ * the nursery: that is, the cells allocated since the last collection,
+ * which are all on pages marked young. Tenured cells are then taken to be
+ * live, and are neither marked nor swept; and the remembered cells, which
+ * may refer to cells in the nursery, are roots too. Only safe when memory
+ * is not being managed by reference counting, and when every live object
+ * is reachable from the roots; that is, at the outermost REPL between top
+ * level forms.
+ *
+ * @return the number of cells recovered.
+ */
+uint64_t collect_marked( struct cons_pointer roots[], int n_roots,
+                         bool nursery ) {
+    uint64_t start = reclamation_clock(  );
+    uint64_t recovered = 0;
+    uint64_t live = 0;
+    uint32_t n_pages = initialised_cons_pages;
+    struct collection_page *pages =
+        calloc( n_pages, sizeof( struct collection_page ) );
+    struct mark_state state = { pages, { NULL, 0, 0 }, false, nursery };
+    struct cons_pointer globals[] = {
+        oblist, lisp_io_in, lisp_io_out, prompt_name,
+        privileged_symbol_nil, privileged_string_memory_exhausted,
+        privileged_exception_memory_exhausted,
+        privileged_keyword_location, privileged_keyword_payload,
+        privileged_keyword_cause, privileged_keyword_documentation,
+        privileged_keyword_name, privileged_keyword_primitive
+    };
+    bool ok = pages != NULL && !reference_counting;
+
+    /* in the nursery, only young pages have cells to mark */
+    for ( uint32_t p = 0; ok && p < n_pages; p++ ) {
+        if ( !nursery || conspages[p]->young ) {
+            pages[p].live = calloc( conspages[p]->high_water + 1,
+                                    sizeof( uint8_t ) );
+            ok = pages[p].live != NULL;
+        }
+    }
+
+    for ( int i = 0; ok && i < sizeof( globals ) / sizeof( globals[0] );
+          i++ ) {
+        mark_reachable( globals[i], &state );
+        ok = !state.failed;
+    }
+
+    for ( int i = 0; ok && i < n_roots; i++ ) {
+        mark_reachable( roots[i], &state );
+        ok = !state.failed;
+    }
+
+    if ( nursery ) {
+        for ( uint64_t i = 0; ok && i < remembered_cells.count; i++ ) {
+            struct cons_pointer pointer = remembered_cells.pointers[i];
+
+            if ( !check_tag( pointer, FREETV ) ) {
+                mark_reachable( pointer, &state );
+                ok = !state.failed;
+            }
+        }
+        for_each_access( &mark_access_root, &state );
+        ok = ok && !state.failed;
+    }
+
+    /* locked cells are never collected, so are roots themselves */
+    for ( uint32_t p = 0; ok && p < n_pages; p++ ) {
+        for ( uint32_t o = next_cell_in_use( p, 0 );
+              ok && pages[p].live != NULL && o < conspages[p]->high_water;
+              o = next_cell_in_use( p, o + 1 ) ) {
+            struct cons_pointer pointer = { p, o };
+
+            if ( pointer2count( pointer ) == MAXREFERENCE ) {
+                mark_reachable( pointer, &state );
+                ok = !state.failed;
+            }
+        }
+    }
+
+    if ( ok ) {
+        if ( !nursery ) {
+            remembered_cells.count = 0;
+        }
+
+        for ( uint32_t p = 0; p < n_pages; p++ ) {
+            if ( pages[p].live != NULL ) {
+                recovered += sweep_cons_page( p, pages, nursery, &live );
+            }
+            /* pages still owned will go on being allocated from */
+            conspages[p]->young = conspages[p]->owner != 0;
+        }
+
+        if ( !nursery ) {
+            /* let the heap grow by as much again as is live before the
+             * next full collection */
+            uint32_t live_pages = live / cons_page_size;
+            cycle_collection_pages =
+                initialised_cons_pages + ( live_pages > 0 ? live_pages : 1 );
+        }
+        cells_allocated_at_collection = cells_allocated_noted;
+    } else {
+        debug_print( L"WARNING: could not mark and sweep\n", DEBUG_ALLOC );
+    }
+
+    for ( uint32_t p = 0; pages != NULL && p < n_pages; p++ ) {
+        free( pages[p].live );
+    }
+    free( pages );
+    free( state.stack.pointers );
+
+    if ( nursery ) {
+        nursery_collections++;
+        nursery_cells_recovered += recovered;
+        nursery_ns += reclamation_clock(  ) - start;
+    } else {
+        mark_sweep_collections++;
+        mark_sweep_cells_recovered += recovered;
+        mark_sweep_ns += reclamation_clock(  ) - start;
+        cycle_collection_wanted = false;
+    }
+    nursery_collection_wanted = false;
+
+    debug_printf( DEBUG_ALLOC, L"%s recovered %lu cells\n",
+                  nursery ? L"Nursery collection" : L"Mark-sweep",
+                  recovered );
+
+    return recovered;
+}
+
+/**
+ * Collect the whole heap by mark-sweep, from these `n_roots` `roots`; see
+ * `collect_marked()`.
+ *
+ * @return the number of cells recovered.
+ */
+uint64_t mark_sweep( struct cons_pointer roots[], int n_roots ) {
+    return collect_marked( roots, n_roots, false );
+}
+
+/**
+ * Collect only the nursery by mark-sweep, from these `n_roots` `roots`; see
+ * `collect_marked()`.
+ *
+ * @return the number of cells recovered.
+ */
+uint64_t mark_sweep_nursery( struct cons_pointer roots[], int n_roots ) {
+    return collect_marked( roots, n_roots, true );
+}
+
+/**
+ * Note that this number of cells have now been `allocated` in all; if
+ * memory is managed by mark-sweep and the nursery is full, ask for it to
+ * be collected at the next safe point.
+ */
+void note_cells_allocated( uint64_t allocated ) {
+    cells_allocated_noted = allocated;
+
+    if ( !reference_counting && nursery_pages > 0 &&
+         allocated - cells_allocated_at_collection >=
+         ( uint64_t ) nursery_pages * cons_page_size ) {
+        nursery_collection_wanted = true;
+    }
+}
+
+/**
+ * If memory is managed by mark-sweep and allocation pressure has asked for
+ * a collection, do it now, from these `n_roots` `roots`: of the whole heap
+ * if it has grown enough, else of the nursery if that is full. To be
+ * called only at safe points at which everything live is reachable from
+ * the roots.
+ */
+void maybe_mark_sweep( struct cons_pointer roots[], int n_roots ) {
+    if ( !reference_counting ) {
+        if ( cycle_collection_wanted ) {
+            mark_sweep( roots, n_roots );
+        } else if ( nursery_collection_wanted ) {
+            mark_sweep_nursery( roots, n_roots );
+        }
+    }
+}
+
+/**
+ * If memory is under pressure, because more cons pages are resident than
+ * the soft limit allows or because the emergency reserve has been drawn
+ * on, shed what we can: reclaim everything waiting to be freed, collect
+ * (cycles if reference counting, else everything, from these `n_roots`
+ * `roots`), and return every empty page to the operating system. Then try
+ * to replenish the reserve; once it is full again, cons space is no longer
+ * exhausted. To be called only at safe points at which everything live is
+ * reachable from the roots.
+ */
+void relieve_memory_pressure( struct cons_pointer roots[], int n_roots ) {
+    if ( memory_pressure ) {
+        debug_printf( DEBUG_ALLOC,
+                      L"Relieving memory pressure: %u cons pages resident\n",
+                      resident_cons_pages );
+
+        reclaim_pending_cells( 0 );
+
+        if ( reference_counting ) {
+            collect_cycles(  );
+        } else {
+            mark_sweep( roots, n_roots );
+        }
+
+        release_empty_cons_pages_keeping( 0 );
+
+        if ( replenish_cons_reserve(  ) ) {
+            cons_space_exhausted = false;
+        }
+        memory_pressure = cons_space_exhausted;
+    }
+}
+
+/**
+ * Print statistics on cycle collection to this `output` stream.
+ */
+void summarise_collection( URL_FILE *output ) {
+    if ( reference_counting ) {
+        url_fwprintf( output,
+                      L"Cycle collection summary: collections %lu; cells recovered %lu.\n",
+                      cycle_collections, cycle_cells_recovered );
+    } else {
+        url_fwprintf( output,
+                      L"Mark-sweep summary: collections %lu; cells recovered %lu; time %lu ns; pages reset %lu.\n",
+                      mark_sweep_collections, mark_sweep_cells_recovered,
+                      mark_sweep_ns, cons_pages_reset );
+        url_fwprintf( output,
+                      L"Nursery summary: collections %lu; cells recovered %lu; time %lu ns.\n",
+                      nursery_collections, nursery_cells_recovered,
+                      nursery_ns );
+    }
+}
+
+/**
+ * Function: find and reclaim garbage cycles in cons space and vector space.
+ *
+ * * (collect-cycles)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return the number of cells recovered.
+ */
+struct cons_pointer lisp_collect_cycles( struct stack_frame *frame,
+                                         struct cons_pointer frame_pointer,
+                                         struct cons_pointer env ) {
+    return acquire_integer( ( int64_t ) collect_cycles(  ), NIL );
+}
@@ -0,0 +1,75 @@
+/*
+ * collect.h
+ *
+ * Garbage collection to complement, or replace, reference counting.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_collect_h
+#define __psse_collect_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "memory/consspaceobject.h"
+
+/**
+ * the default number of cons pages the heap must reach before allocation
+ * pressure triggers cycle collection.
+ */
+#define DFLT_CYCLE_COLLECTION_PAGES 64
+
+/**
+ * the default number of pages' worth of cells which may be allocated, when
+ * memory is managed by mark-sweep, before the nursery is collected.
+ */
+#define DFLT_NURSERY_PAGES 16
+
+/**
+ * When memory is managed by mark-sweep, reference counts are not kept, and
+ * the count of a cell records instead its generation: a cell is allocated
+ * (into the nursery) with a count of one, and is tenured by the first
+ * collection it survives.
+ */
+#define TENURED 2
+
+/**
+ * true if the cell at this `pointer` has survived a mark-sweep collection.
+ */
+#define tenuredp(pointer) (pointer2count(pointer) == TENURED)
+
+extern uint32_t cycle_collection_pages;
+
+extern bool cycle_collection_wanted;
+
+extern uint32_t nursery_pages;
+
+void for_each_child( struct cons_pointer pointer,
+                     void ( *fn ) ( struct cons_pointer, void * ),
+                     void *data );
+
+void note_heap_growth( uint32_t pages );
+
+void note_cells_allocated( uint64_t allocated );
+
+uint64_t collect_cycles(  );
+
+void maybe_collect_cycles(  );
+
+uint64_t mark_sweep( struct cons_pointer roots[], int n_roots );
+
+uint64_t mark_sweep_nursery( struct cons_pointer roots[], int n_roots );
+
+void maybe_mark_sweep( struct cons_pointer roots[], int n_roots );
+
+void relieve_memory_pressure( struct cons_pointer roots[], int n_roots );
+
+void summarise_collection( URL_FILE * output );
+
+struct cons_pointer lisp_collect_cycles( struct stack_frame *frame,
+                                         struct cons_pointer frame_pointer,
+                                         struct cons_pointer env );
+
+#endif
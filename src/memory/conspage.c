@@ -3,23 +3,37 @@
  *
  * Setup and tear down cons pages, and (FOR NOW) do primitive
  * allocation/deallocation of cells.
- * NOTE THAT before we go multi-threaded, these functions must be
- * aggressively
- * thread safe.
+ *
+ * Each thread allocates from a cons page which it owns privately, so that
+ * allocation needs no synchronisation; cells freed by a thread which does
+ * not own their page are pushed, lock free, onto that page's remote free
+ * list. The global lock is taken only when a thread exhausts its page and
+ * must return it and acquire another.
  *
  * (c) 2017 Simon Brooke <simon@journeyman.cc>
  * Licensed under GPL version 2.0, or, at your option, any later version.
  */
 
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "memory/consspaceobject.h"
 #include "memory/conspage.h"
 #include "debug.h"
+#include "memory/access.h"
+#include "memory/collect.h"
 #include "memory/dump.h"
+#include "memory/room.h"
 #include "memory/stack.h"
 #include "memory/vectorspace.h"
 
@@ -28,22 +42,333 @@
  */
 bool conspageinitihasbeencalled = false;
 
+/**
+ * The lock which guards the directory of cons pages, the bands, and the
+ * totals of cells allocated and freed.
+ */
+pthread_mutex_t cons_space_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * keep track of total cells allocated and freed to check for leakage.
+ * Each thread counts locally, and adds its counts to these totals when it
+ * takes the lock.
  */
 uint64_t total_cells_allocated = 0;
 uint64_t total_cells_freed = 0;
 
+_Thread_local uint64_t thread_cells_allocated = 0;
+_Thread_local uint64_t thread_cells_freed = 0;
+
+/**
+ * The last thread identifier handed out; identifiers start from 1, since
+ * an owner of 0 means a page is not owned by any thread.
+ */
+uint32_t last_cons_thread_id = 0;
+
+/**
+ * The identifier of this thread, as an owner of cons pages; 0 until the
+ * thread first needs one.
+ */
+_Thread_local uint32_t cons_thread_id = 0;
+
 /**
  * the number of cons pages which have thus far been initialised.
  */
-int initialised_cons_pages = 0;
+uint32_t initialised_cons_pages = 0;
+
+/**
+ * the number of cells on each cons page; may be set at startup, but must
+ * not be changed once the first page has been made.
+ */
+uint32_t cons_page_size = CONSPAGESIZE;
+
+/**
+ * the number of cons pages to make when cons space is initialised.
+ */
+uint32_t cons_pages_initial = 1;
+
+/**
+ * the maximum number of cons pages we will make.
+ */
+uint32_t cons_pages_max = MAXCONSPAGES;
+
+/**
+ * the number of wholly empty cons pages to keep resident; empty pages
+ * beyond this number are returned to the operating system.
+ */
+uint32_t cons_pages_retained = DFLT_CONS_PAGES_RETAINED;
+
+/**
+ * the number of cons pages which may be resident before memory is
+ * considered to be under pressure, or 0 for no such limit.
+ */
+uint32_t cons_pages_soft_limit = 0;
+
+/**
+ * the number of cons pages which have had cells allocated from them and
+ * have not since been released.
+ */
+uint32_t resident_cons_pages = 0;
 
 /**
- * The (global) pointer to the (global) freelist. Not sure whether this ultimately
- * belongs in this file.
+ * true once the emergency reserve has been drawn on, until it has been
+ * replenished. While this is so, evaluation returns
+ * `privileged_exception_memory_exhausted`.
  */
-struct cons_pointer freelist = NIL;
+bool cons_space_exhausted = false;
+
+/**
+ * true once the system has started, after which, if cons space and its
+ * emergency reserve are wholly exhausted, `allocate_cell` returns
+ * `privileged_exception_memory_exhausted` and evaluation unwinds to the
+ * REPL. Until then there is nothing to unwind to, so exhaustion is fatal.
+ */
+bool allocation_may_fail = false;
+
+/**
+ * true if the soft limit has been passed or the emergency reserve drawn on,
+ * so that memory should be shed at the next safe point; see
+ * `relieve_memory_pressure()` in `collect.c`.
+ */
+bool memory_pressure = false;
+
+/**
+ * the number of times an empty cons page has been returned to the
+ * operating system.
+ */
+uint64_t cons_pages_released = 0;
+
+/**
+ * the number of cons pages the directory of cons pages currently has room
+ * for.
+ */
+uint32_t conspages_capacity = 0;
+
+/**
+ * The index of the page this thread is currently allocating from, which
+ * it owns; that is, the page this thread most recently used.
+ */
+_Thread_local uint32_t current_cons_page = NOCONSPAGE;
+
+/**
+ * The maximum number of pending cells to reclaim on each allocation, or 0
+ * to reclaim every cell as soon as its reference count reaches zero.
+ */
+uint32_t reclamation_budget = 0;
+
+/**
+ * This thread's work list of cells whose reference counts have reached
+ * zero, but which have not yet been reclaimed; a stack, which grows as
+ * needed.
+ */
+_Thread_local struct cons_pointer *pending_cells = NULL;
+_Thread_local uint64_t pending_cells_count = 0;
+_Thread_local uint64_t pending_cells_capacity = 0;
+
+/**
+ * true while this thread is working through its work list, so that cells
+ * freed as a consequence are queued rather than reclaimed recursively.
+ */
+_Thread_local bool reclaiming = false;
+
+/**
+ * Statistics on this thread's reclamation pauses.
+ */
+_Thread_local struct reclamation_stats reclamation_stats = { 0, 0, 0, 0, 0 };
+
+/**
+ * The head of a (lock free) stack of pages which have had cells freed
+ * onto their remote free lists since they were last looked at, linked
+ * through their `dirty_next` fields.
+ */
+uint32_t dirty_cons_pages = NOCONSPAGE;
+
+/**
+ * The heads of the lists of pages which have free cells, banded by the
+ * number of free cells they have: band 0 holds the busiest pages, band
+ * `NCONSPAGEBANDS - 1` the emptiest. Pages owned by a thread are never
+ * listed. Guarded by `cons_space_lock`.
+ */
+uint32_t cons_page_bands[NCONSPAGEBANDS] = {
+    NOCONSPAGE, NOCONSPAGE, NOCONSPAGE, NOCONSPAGE,
+    NOCONSPAGE, NOCONSPAGE, NOCONSPAGE, NOCONSPAGE
+};
+
+/**
+ * @return the band in which a page with this many `free` cells should be
+ * listed, or -1 if it should not be listed because it is full.
+ */
+int32_t cons_page_band( uint32_t free ) {
+    int32_t result = -1;
+
+    if ( free > 0 ) {
+        uint32_t width = cons_page_size / NCONSPAGEBANDS;
+        result = ( free - 1 ) / ( width > 0 ? width : 1 );
+
+        if ( result >= NCONSPAGEBANDS ) {
+            result = NCONSPAGEBANDS - 1;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Remove the page with this `index` from whichever band it is listed in.
+ */
+void unlist_cons_page( uint32_t index ) {
+    struct cons_page *page = conspages[index];
+
+    if ( page->band >= 0 ) {
+        if ( page->band_prev == NOCONSPAGE ) {
+            cons_page_bands[page->band] = page->band_next;
+        } else {
+            conspages[page->band_prev]->band_next = page->band_next;
+        }
+        if ( page->band_next != NOCONSPAGE ) {
+            conspages[page->band_next]->band_prev = page->band_prev;
+        }
+
+        page->band = -1;
+        page->band_next = NOCONSPAGE;
+        page->band_prev = NOCONSPAGE;
+    }
+}
+
+/**
+ * (Re)list the page with this `index` in the band appropriate to the
+ * number of free cells it now has, unless it is owned by a thread.
+ */
+void list_cons_page( uint32_t index ) {
+    struct cons_page *page = conspages[index];
+    int32_t band = page->owner != 0 ? -1 :
+        cons_page_band( page->size - page->occupancy );
+
+    if ( band != page->band ) {
+        unlist_cons_page( index );
+
+        if ( band >= 0 ) {
+            page->band = band;
+            page->band_prev = NOCONSPAGE;
+            page->band_next = cons_page_bands[band];
+            if ( page->band_next != NOCONSPAGE ) {
+                conspages[page->band_next]->band_prev = index;
+            }
+            cons_page_bands[band] = index;
+        }
+    }
+}
+
+/**
+ * @return the identifier of this thread as an owner of cons pages.
+ */
+uint32_t get_cons_thread_id(  ) {
+    if ( cons_thread_id == 0 ) {
+        cons_thread_id =
+            __atomic_add_fetch( &last_cons_thread_id, 1, __ATOMIC_RELAXED );
+    }
+
+    return cons_thread_id;
+}
+
+/**
+ * Pack this `pointer` into a single word, so that it can be updated
+ * atomically; NIL packs to zero.
+ */
+uint64_t pack_cons_pointer( struct cons_pointer pointer ) {
+    return ( ( uint64_t ) pointer.page << 32 ) | pointer.offset;
+}
+
+/**
+ * The inverse of `pack_cons_pointer`.
+ */
+struct cons_pointer unpack_cons_pointer( uint64_t packed ) {
+    return ( struct cons_pointer ) {
+    ( uint32_t ) ( packed >> 32 ), ( uint32_t ) packed};
+}
+
+/**
+ * Move any cells which other threads have freed onto the remote free list
+ * of the page with this `index` onto its own free list. Must only be
+ * called by the thread which owns the page, or with `cons_space_lock`
+ * held if no thread owns it.
+ */
+void reclaim_remote_frees( uint32_t index ) {
+    struct cons_page *page = conspages[index];
+    uint64_t head =
+        __atomic_exchange_n( &page->remote_freelist, 0, __ATOMIC_ACQUIRE );
+
+    if ( head != 0 ) {
+        struct cons_pointer first = unpack_cons_pointer( head );
+        struct cons_pointer last = first;
+        uint32_t n = 1;
+
+        while ( !nilp( pointer2cell( last ).payload.free.cdr ) ) {
+            last = pointer2cell( last ).payload.free.cdr;
+            n++;
+        }
+
+        pointer2cell( last ).payload.free.cdr = page->freelist;
+        page->freelist = first;
+        page->occupancy -= n;
+    }
+}
+
+/**
+ * Note that the page with this `index` has cells on its remote free list,
+ * by pushing it onto the stack of dirty pages if it isn't there already.
+ */
+void mark_cons_page_dirty( uint32_t index ) {
+    struct cons_page *page = conspages[index];
+
+    if ( __atomic_exchange_n( &page->dirty, 1, __ATOMIC_ACQ_REL ) == 0 ) {
+        uint32_t head = __atomic_load_n( &dirty_cons_pages, __ATOMIC_RELAXED );
+
+        do {
+            page->dirty_next = head;
+        } while ( !__atomic_compare_exchange_n( &dirty_cons_pages, &head,
+                                                index, true,
+                                                __ATOMIC_RELEASE,
+                                                __ATOMIC_RELAXED ) );
+    }
+}
+
+/**
+ * Reclaim the remote frees of every page on the stack of dirty pages which
+ * is not owned by a thread, and relist it accordingly. Pages which are
+ * owned will be dealt with by their owners. Must be called with
+ * `cons_space_lock` held.
+ */
+void clean_dirty_cons_pages(  ) {
+    uint32_t index = __atomic_exchange_n( &dirty_cons_pages, NOCONSPAGE,
+                                          __ATOMIC_ACQUIRE );
+
+    while ( index != NOCONSPAGE ) {
+        struct cons_page *page = conspages[index];
+        uint32_t next = page->dirty_next;
+
+        __atomic_store_n( &page->dirty, 0, __ATOMIC_RELEASE );
+
+        if ( page->owner == 0 ) {
+            reclaim_remote_frees( index );
+            list_cons_page( index );
+        }
+
+        index = next;
+    }
+}
+
+/**
+ * Add this thread's counts of cells allocated and freed to the totals.
+ * Must be called with `cons_space_lock` held.
+ */
+void flush_cell_counts(  ) {
+    total_cells_allocated += thread_cells_allocated;
+    total_cells_freed += thread_cells_freed;
+    thread_cells_allocated = 0;
+    thread_cells_freed = 0;
+    flush_tag_counters(  );
+}
 
 /**
  * The exception message printed when the world blows up, initialised in
@@ -52,116 +377,761 @@ struct cons_pointer freelist = NIL;
 struct cons_pointer privileged_string_memory_exhausted;
 
 /**
- * An array of pointers to cons pages.
+ * The exception returned when cons space is exhausted, made in advance for
+ * the same reason, and locked.
+ */
+struct cons_pointer privileged_exception_memory_exhausted;
+
+/**
+ * The directory of cons pages: an array of pointers to cons pages, which
+ * grows on demand.
+ */
+struct cons_page **conspages = NULL;
+
+/**
+ * The region of address space reserved for cons space, or NULL until the
+ * first page is made. The cells of page `n`, followed by their tags and
+ * then their reference counts, lie `n * cons_page_stride` bytes from its
+ * start, so that finding a cell is arithmetic rather than a look up in a
+ * directory.
+ */
+char *cons_space = NULL;
+
+/**
+ * the number of bytes between the starts of successive pages in
+ * `cons_space`; a whole number of operating system pages.
+ */
+size_t cons_page_stride = 0;
+
+/**
+ * the offsets, from the start of a page in `cons_space`, of its tags and of
+ * its reference counts.
+ */
+size_t cons_tags_offset = 0;
+
+size_t cons_counts_offset = 0;
+
+/**
+ * true if the kernel should be asked to back `cons_space` with transparent
+ * huge pages; must be set, if at all, before the first page is made.
+ */
+bool cons_space_huge_pages = false;
+
+/**
+ * Ensure the directory of cons pages has room for at least one more page,
+ * growing it by doubling (up to `cons_pages_max`) if necessary. Must be
+ * called with `cons_space_lock` held.
+ *
+ * @return true if there is room for another page, else false.
+ */
+bool ensure_conspages_capacity(  ) {
+    bool result = initialised_cons_pages < conspages_capacity;
+
+    if ( !result && conspages_capacity < cons_pages_max ) {
+        uint32_t capacity =
+            conspages_capacity == 0 ? NCONSPAGES : conspages_capacity * 2;
+
+        if ( capacity > cons_pages_max || capacity < conspages_capacity ) {
+            capacity = cons_pages_max;
+        }
+
+        /* other threads may be reading the old directories without the
+         * lock, so we copy them rather than reallocating them, and never
+         * free them; the directories sum to less than twice the final
+         * size. */
+        struct cons_page **directory =
+            malloc( capacity * sizeof( struct cons_page * ) );
+
+        if ( directory != NULL ) {
+            for ( uint32_t i = 0; i < capacity; i++ ) {
+                directory[i] = i < conspages_capacity ? conspages[i] : NULL;
+            }
+            debug_printf( DEBUG_ALLOC,
+                          L"Grew cons page directory from %u to %u pages\n",
+                          conspages_capacity, capacity );
+
+            __atomic_store_n( &conspages, directory, __ATOMIC_RELEASE );
+            conspages_capacity = capacity;
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Initialise the cells at offsets 0 and 1 of this `page`, which must be
+ * page zero, as NIL and T respectively.
+ */
+void make_nil_and_t( struct cons_page *page ) {
+    struct cons_space_object *cell = &pointer2cell( NIL );
+
+    /*
+     * initialise cell as NIL
+     */
+    strncpy( &pointer2tag( NIL ).bytes[0], NILTAG, TAGLENGTH );
+    pointer2count( NIL ) = MAXREFERENCE;
+    cell->payload.free.car = NIL;
+    cell->payload.free.cdr = NIL;
+    debug_printf( DEBUG_ALLOC, L"Allocated special cell NIL\n" );
+
+    /*
+     * initialise cell as T
+     */
+    cell = &pointer2cell( TRUE );
+    strncpy( &pointer2tag( TRUE ).bytes[0], TRUETAG, TAGLENGTH );
+    pointer2count( TRUE ) = MAXREFERENCE;
+    cell->payload.free.car = ( struct cons_pointer ) {
+        0, 1
+    };
+    cell->payload.free.cdr = ( struct cons_pointer ) {
+        0, 1
+    };
+    debug_printf( DEBUG_ALLOC, L"Allocated special cell T\n" );
+
+    page->occupancy = 2;
+    page->high_water = 2;
+}
+
+/**
+ * @return the number of bytes of memory the cells of a cons page, with
+ * their tags and reference counts, occupy, rounded up to a whole number of
+ * operating system pages.
  */
-struct cons_page *conspages[NCONSPAGES];
+size_t cons_page_bytes(  ) {
+    size_t os_page = ( size_t ) sysconf( _SC_PAGESIZE );
+    size_t bytes = ( size_t ) cons_page_size *
+        ( sizeof( struct cons_space_object ) + sizeof( union cell_tag ) +
+          sizeof( uint32_t ) );
+
+    return ( ( bytes + os_page - 1 ) / os_page ) * os_page;
+}
 
 /**
- * Make a cons page. Initialise all cells and prepend each to the freelist;
- * if `initialised_cons_pages` is zero, do not prepend cells 0 and 1 to the
- * freelist but initialise them as NIL and T respectively.
- * \todo we ought to handle cons space exhaustion more gracefully than just
- * crashing; should probably return an exception instead, although obviously
- * that exception would have to have been pre-built.
+ * @return the address of the memory of the page at this `index` in cons
+ * space.
+ */
+static char *cons_page_memory( uint32_t index ) {
+    return cons_space + ( size_t ) index * cons_page_stride;
+}
+
+/**
+ * Reserve address space for `cons_pages_max` pages, if it has not been
+ * reserved already. No memory is committed until cells are allocated; if
+ * so much address space cannot be had, `cons_pages_max` is halved until it
+ * can. Must be called with `cons_space_lock` held.
+ *
+ * @return true if cons space has been reserved, else false.
+ */
+bool reserve_cons_space(  ) {
+    size_t align = cons_space_huge_pages ? CONS_SPACE_ALIGNMENT : 1;
+
+    cons_page_stride = cons_page_bytes(  );
+    cons_tags_offset =
+        ( size_t ) cons_page_size * sizeof( struct cons_space_object );
+    cons_counts_offset = cons_tags_offset +
+        ( size_t ) cons_page_size * sizeof( union cell_tag );
+
+    while ( cons_space == NULL && cons_pages_max > 0 ) {
+        size_t bytes = cons_page_stride * cons_pages_max + align - 1;
+        char *region = mmap( NULL, bytes, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                             -1, 0 );
+
+        if ( region == MAP_FAILED ) {
+            debug_printf( DEBUG_ALLOC,
+                          L"Failed to reserve %lu bytes for %u cons pages\n",
+                          ( unsigned long ) bytes, cons_pages_max );
+            cons_pages_max /= 2;
+        } else {
+            cons_space = ( char * )
+                ( ( ( uintptr_t ) region + align - 1 ) & ~( align - 1 ) );
+
+#ifdef MADV_HUGEPAGE
+            if ( cons_space_huge_pages ) {
+                madvise( cons_space, cons_page_stride * cons_pages_max,
+                         MADV_HUGEPAGE );
+            }
+#endif
+            debug_printf( DEBUG_ALLOC,
+                          L"Reserved %lu bytes for %u cons pages at %p\n",
+                          ( unsigned long ) bytes, cons_pages_max,
+                          cons_space );
+        }
+    }
+
+    return cons_space != NULL;
+}
+
+/**
+ * Make a cons page. The cells of a new page are not initialised: they are
+ * handed out in order by bumping the page's `high_water` mark, and only
+ * cells which have been freed go onto the page's freelist. If
+ * `initialised_cons_pages` is zero, initialise cells 0 and 1 as NIL and T
+ * respectively. The new page is neither owned nor listed. Must be called
+ * with `cons_space_lock` held.
+ *
+ * @return the index of the new page, or `NOCONSPAGE` if no more pages may
+ * be made, or memory for one cannot be had.
  */
-void make_cons_page(  ) {
+uint32_t make_cons_page(  ) {
     struct cons_page *result = NULL;
 
-    if ( initialised_cons_pages < NCONSPAGES ) {
+    /* the cells are in address space reserved in advance, rather than
+     * malloced, so that if the page is ever wholly empty their memory can
+     * be handed back */
+    if ( ( cons_space != NULL || reserve_cons_space(  ) )
+         && initialised_cons_pages < cons_pages_max
+         && ensure_conspages_capacity(  ) ) {
         result = malloc( sizeof( struct cons_page ) );
     }
 
     if ( result != NULL ) {
         conspages[initialised_cons_pages] = result;
+        result->size = cons_page_size;
+        result->occupancy = 0;
+        result->high_water = 0;
+        result->freelist = NIL;
+        result->band = -1;
+        result->band_next = NOCONSPAGE;
+        result->band_prev = NOCONSPAGE;
+        result->owner = 0;
+        result->remote_freelist = 0;
+        result->dirty = 0;
+        result->dirty_next = NOCONSPAGE;
+        result->reserved = false;
+        result->young = false;
+        result->resident = false;
 
-        for ( int i = 0; i < CONSPAGESIZE; i++ ) {
-            struct cons_space_object *cell =
-                &conspages[initialised_cons_pages]->cell[i];
-            if ( initialised_cons_pages == 0 && i < 2 ) {
-                switch ( i ) {
-                    case 0:
-                        /*
-                         * initialise cell as NIL
-                         */
-                        strncpy( &cell->tag.bytes[0], NILTAG, TAGLENGTH );
-                        cell->count = MAXREFERENCE;
-                        cell->payload.free.car = NIL;
-                        cell->payload.free.cdr = NIL;
-                        debug_printf( DEBUG_ALLOC,
-                                      L"Allocated special cell NIL\n" );
-                        break;
-                    case 1:
-                        /*
-                         * initialise cell as T
-                         */
-                        strncpy( &cell->tag.bytes[0], TRUETAG, TAGLENGTH );
-                        cell->count = MAXREFERENCE;
-                        cell->payload.free.car = ( struct cons_pointer ) {
-                            0, 1
-                        };
-                        cell->payload.free.cdr = ( struct cons_pointer ) {
-                            0, 1
-                        };
-                        debug_printf( DEBUG_ALLOC,
-                                      L"Allocated special cell T\n" );
-                        break;
-                }
-            } else {
-                /*
-                 * otherwise, standard initialisation
-                 */
-                strncpy( &cell->tag.bytes[0], FREETAG, TAGLENGTH );
-                cell->payload.free.car = NIL;
-                cell->payload.free.cdr = freelist;
-                freelist.page = initialised_cons_pages;
-                freelist.offset = i;
-            }
+        if ( initialised_cons_pages == 0 ) {
+            make_nil_and_t( result );
+            result->resident = true;
+            resident_cons_pages++;
         }
 
         initialised_cons_pages++;
+        note_heap_growth( initialised_cons_pages );
     } else {
-        fwide( stderr, 1 );
-        fwprintf( stderr,
-                  L"FATAL: Failed to allocate memory for cons page %d\n",
-                  initialised_cons_pages );
-        exit( 1 );
+        debug_printf( DEBUG_ALLOC,
+                      L"Failed to allocate memory for cons page %u\n",
+                      initialised_cons_pages );
+    }
+
+    return result == NULL ? NOCONSPAGE : initialised_cons_pages - 1;
+}
+
+/**
+ * Take a page from the emergency reserve, noting that cons space is
+ * exhausted. Must be called with `cons_space_lock` held.
+ *
+ * @return the index of the page taken, or `NOCONSPAGE` if the reserve is
+ * empty.
+ */
+uint32_t take_cons_reserve(  ) {
+    uint32_t result = NOCONSPAGE;
+
+    for ( uint32_t i = 0; i < initialised_cons_pages && result == NOCONSPAGE;
+          i++ ) {
+        if ( conspages[i]->reserved ) {
+            conspages[i]->reserved = false;
+            result = i;
+        }
+    }
+
+    if ( result != NOCONSPAGE ) {
+        cons_space_exhausted = true;
+        memory_pressure = true;
+        debug_printf( DEBUG_ALLOC,
+                      L"Cons space exhausted; allocating from reserve page %u\n",
+                      result );
     }
+
+    return result;
+}
+
+/**
+ * Bring the emergency reserve back up to `CONS_PAGES_RESERVED` pages,
+ * preferably by setting aside pages which are empty, else by making new
+ * ones. Must not be called with `cons_space_lock` held.
+ *
+ * @return true if the reserve is full.
+ */
+bool replenish_cons_reserve(  ) {
+    uint32_t reserved = 0;
+
+    pthread_mutex_lock( &cons_space_lock );
+
+    clean_dirty_cons_pages(  );
+
+    for ( uint32_t i = 0; i < initialised_cons_pages; i++ ) {
+        if ( conspages[i]->reserved ) {
+            reserved++;
+        }
+    }
+
+    for ( uint32_t i = 1;
+          i < initialised_cons_pages && reserved < CONS_PAGES_RESERVED;
+          i++ ) {
+        struct cons_page *page = conspages[i];
+
+        if ( !page->reserved && page->owner == 0 && page->occupancy == 0 ) {
+            unlist_cons_page( i );
+            page->reserved = true;
+            reserved++;
+        }
+    }
+
+    while ( reserved < CONS_PAGES_RESERVED ) {
+        uint32_t i = make_cons_page(  );
+
+        if ( i == NOCONSPAGE ) {
+            break;
+        }
+        conspages[i]->reserved = true;
+        reserved++;
+    }
+
+    pthread_mutex_unlock( &cons_space_lock );
+
+    return reserved >= CONS_PAGES_RESERVED;
+}
+
+/**
+ * Select a page for this thread to allocate from, now that its current
+ * page is full. We prefer the busiest page which still has a reasonable
+ * number (a quarter of a page) of free cells, because filling up nearly
+ * full pages leaves the less busy ones free to empty; failing that, the
+ * page with the most free cells; and failing that, if there are no free
+ * cells at all, a new page. If no new page can be made, we draw on the
+ * emergency reserve; only if that is empty too do we give up. Must be
+ * called with `cons_space_lock` held.
+ *
+ * @return the index of the page selected, which is not yet owned, or
+ * `NOCONSPAGE` if there is none to be had, not even from the reserve.
+ */
+uint32_t select_cons_page(  ) {
+    uint32_t selected = NOCONSPAGE;
+
+    clean_dirty_cons_pages(  );
+
+    for ( int32_t band = NCONSPAGEBANDS / 4;
+          band < NCONSPAGEBANDS && selected == NOCONSPAGE; band++ ) {
+        selected = cons_page_bands[band];
+    }
+    for ( int32_t band = NCONSPAGEBANDS / 4 - 1;
+          band >= 0 && selected == NOCONSPAGE; band-- ) {
+        selected = cons_page_bands[band];
+    }
+
+    if ( selected == NOCONSPAGE ) {
+        selected = make_cons_page(  );
+    }
+    if ( selected == NOCONSPAGE ) {
+        selected = take_cons_reserve(  );
+    }
+    if ( selected != NOCONSPAGE && !conspages[selected]->resident ) {
+        /* we are about to fault its memory in */
+        conspages[selected]->resident = true;
+        resident_cons_pages++;
+
+        if ( cons_pages_soft_limit > 0
+             && resident_cons_pages > cons_pages_soft_limit ) {
+            memory_pressure = true;
+        }
+    }
+
+    return selected;
+}
+
+/**
+ * Return this thread's current page, if it has one, to the common pool,
+ * and take another one. Called when the current page is full; this is the
+ * only point on the allocation path which takes the global lock. If there
+ * is no other page to be had, this thread is left with none, that is,
+ * `current_cons_page` is `NOCONSPAGE`.
+ */
+void refill_cons_page(  ) {
+    pthread_mutex_lock( &cons_space_lock );
+
+    flush_cell_counts(  );
+
+    if ( current_cons_page != NOCONSPAGE ) {
+        conspages[current_cons_page]->owner = 0;
+        reclaim_remote_frees( current_cons_page );
+        list_cons_page( current_cons_page );
+    }
+
+    current_cons_page = select_cons_page(  );
+
+    if ( current_cons_page != NOCONSPAGE ) {
+        unlist_cons_page( current_cons_page );
+        conspages[current_cons_page]->owner = get_cons_thread_id(  );
+        conspages[current_cons_page]->young = true;
+        reclaim_remote_frees( current_cons_page );
+    }
+
+    pthread_mutex_unlock( &cons_space_lock );
+
+    note_cells_allocated( total_cells_allocated );
+
+    debug_printf( DEBUG_ALLOC, L"Now allocating from cons page %u\n",
+                  current_cons_page );
+}
+
+/**
+ * Return this thread's current page, if any, to the common pool, and add
+ * its counts of cells allocated and freed to the totals; and give up its
+ * pool of stack frames. Threads other than the main thread should call
+ * this before they exit.
+ */
+void release_cons_pages(  ) {
+    reclaim_pending_cells( 0 );
+    drain_frame_pool(  );
+
+    pthread_mutex_lock( &cons_space_lock );
+
+    flush_cell_counts(  );
+
+    if ( current_cons_page != NOCONSPAGE ) {
+        conspages[current_cons_page]->owner = 0;
+        reclaim_remote_frees( current_cons_page );
+        list_cons_page( current_cons_page );
+        current_cons_page = NOCONSPAGE;
+    }
+
+    pthread_mutex_unlock( &cons_space_lock );
+}
+
+/**
+ * Return the memory of wholly empty cons pages to the operating system,
+ * keeping `keep` of them resident so that a heap which is merely
+ * fluctuating does not repeatedly give memory back and fault it in again.
+ * A released page keeps its place in the directory, and its header, but
+ * its cells are discarded: it is reset to look like a new page, and memory
+ * is faulted back in only as cells are allocated from it again. Pages in
+ * the emergency reserve are left alone. Must not be called with
+ * `cons_space_lock` held.
+ *
+ * @return the number of pages released.
+ */
+uint32_t release_empty_cons_pages_keeping( uint32_t keep ) {
+    uint32_t released = 0;
+    uint32_t retained = 0;
+
+    pthread_mutex_lock( &cons_space_lock );
+
+    clean_dirty_cons_pages(  );
+
+    for ( uint32_t i = 0; i < initialised_cons_pages; i++ ) {
+        struct cons_page *page = conspages[i];
+
+        if ( page->owner == 0 && page->occupancy == 0
+             && page->resident && !page->reserved ) {
+            if ( retained < keep ) {
+                retained++;
+            } else {
+                madvise( cons_page_memory( i ), cons_page_stride,
+                         MADV_DONTNEED );
+
+                page->high_water = 0;
+                page->freelist = NIL;
+                page->resident = false;
+                resident_cons_pages--;
+                released++;
+            }
+        }
+    }
+
+    cons_pages_released += released;
+
+    pthread_mutex_unlock( &cons_space_lock );
+
+    if ( released > 0 ) {
+        debug_printf( DEBUG_ALLOC,
+                      L"Released %u empty cons pages; retained %u\n",
+                      released, retained );
+    }
+
+    return released;
+}
+
+/**
+ * Return the memory of wholly empty cons pages to the operating system,
+ * keeping `cons_pages_retained` of them resident.
+ *
+ * @return the number of pages released.
+ */
+uint32_t release_empty_cons_pages(  ) {
+    return release_empty_cons_pages_keeping( cons_pages_retained );
+}
+
+/**
+ * Print statistics on cons pages to this `output` stream.
+ */
+void summarise_cons_pages( URL_FILE *output ) {
+    uint32_t resident = 0;
+    uint32_t empty = 0;
+
+    pthread_mutex_lock( &cons_space_lock );
+
+    for ( uint32_t i = 0; i < initialised_cons_pages; i++ ) {
+        if ( conspages[i]->resident ) {
+            resident++;
+            if ( conspages[i]->occupancy == 0 ) {
+                empty++;
+            }
+        }
+    }
+
+    pthread_mutex_unlock( &cons_space_lock );
+
+    url_fwprintf( output,
+                  L"Cons page summary: pages %u; resident %u, of which empty %u; releases %lu.\n",
+                  initialised_cons_pages, resident, empty,
+                  cons_pages_released );
+}
+
+/**
+ * The tally of the memory used by objects of one type, for
+ * `summarise_memory_by_tag()`.
+ */
+struct tag_tally {
+    union cell_tag tag;
+    uint64_t objects;
+    uint64_t bytes;
+};
+
+/**
+ * Add an object of this `tag`, using this many `bytes`, to these `tallies`,
+ * of which there are `*n` in use out of `max`.
+ */
+static void tally_object( struct tag_tally *tallies, uint32_t *n,
+                          uint32_t max, uint32_t tag, uint64_t bytes ) {
+    uint32_t i = 0;
+
+    while ( i < *n && tallies[i].tag.value != tag ) {
+        i++;
+    }
+
+    if ( i == *n && *n < max ) {
+        tallies[i].tag.value = tag;
+        tallies[i].objects = 0;
+        tallies[i].bytes = 0;
+        ( *n )++;
+    }
+
+    if ( i < *n ) {
+        tallies[i].objects++;
+        tallies[i].bytes += bytes;
+    }
+}
+
+/**
+ * Print, to this `output` stream, the number of live objects of each type
+ * and the memory they occupy. A cons space object costs its cell, its tag
+ * and its count; a vector space object costs its header and its payload,
+ * in addition to the cell which points to it.
+ */
+void summarise_memory_by_tag( URL_FILE *output ) {
+    struct tag_tally tallies[64];
+    uint32_t max = sizeof( tallies ) / sizeof( struct tag_tally );
+    uint32_t n = 0;
+    uint64_t cell_bytes = sizeof( struct cons_space_object ) +
+        sizeof( union cell_tag ) + sizeof( uint32_t );
+    uint64_t total = 0;
+
+    pthread_mutex_lock( &cons_space_lock );
+
+    for ( uint32_t p = 0; p < initialised_cons_pages; p++ ) {
+        for ( uint32_t o = next_cell_in_use( p, 0 );
+              o < conspages[p]->high_water;
+              o = next_cell_in_use( p, o + 1 ) ) {
+            struct cons_pointer pointer = { p, o };
+
+            tally_object( tallies, &n, max, pointer2tag( pointer ).value,
+                          cell_bytes );
+
+            if ( vectorpointp( pointer ) ) {
+                struct vector_space_object *vso =
+                    pointer2cell( pointer ).payload.vectorp.address;
+
+                tally_object( tallies, &n, max, vso->header.tag.value,
+                              sizeof( struct vector_space_header ) +
+                              vso->header.size );
+            }
+        }
+    }
+
+    pthread_mutex_unlock( &cons_space_lock );
+
+    url_fwprintf( output, L"Memory by type (%lu bytes per cell):\n",
+                  cell_bytes );
+
+    for ( uint32_t i = 0; i < n; i++ ) {
+        url_fwprintf( output, L"\t%4.4s %12lu objects %14lu bytes\n",
+                      tallies[i].tag.bytes, tallies[i].objects,
+                      tallies[i].bytes );
+        total += tallies[i].bytes;
+    }
+
+    url_fwprintf( output, L"\tTotal %34lu bytes\n", total );
+    summarise_vector_space( output );
+    summarise_access( output );
+}
+
+/**
+ * Return the offset of the first cell at or after this `offset` in this
+ * `page` which is not free, or the page's high water mark if there is none.
+ * Because tags are held in a dense array, where SSE2 is available four tags
+ * are compared at a time, so that heap walks skip runs of free cells
+ * cheaply.
+ *
+ * @param page the index of the page to scan.
+ * @param offset the offset at which to start.
+ * @return the offset of the next cell in use, or the high water mark.
+ */
+uint32_t next_cell_in_use( uint32_t page, uint32_t offset ) {
+    uint32_t limit = conspages[page]->high_water;
+    union cell_tag *tags =
+        ( union cell_tag * ) ( cons_page_memory( page ) + cons_tags_offset );
+
+#ifdef __SSE2__
+    const __m128i free_tags = _mm_set1_epi32( FREETV );
+
+    while ( offset + 4 <= limit ) {
+        __m128i four =
+            _mm_loadu_si128( ( const __m128i * ) &tags[offset] );
+        int free_bytes =
+            _mm_movemask_epi8( _mm_cmpeq_epi32( four, free_tags ) );
+
+        if ( free_bytes != 0xffff ) {
+            return offset + __builtin_ctz( ~free_bytes ) / 4;
+        }
+        offset += 4;
+    }
+#endif
+
+    while ( offset < limit && tags[offset].value == FREETV ) {
+        offset++;
+    }
+
+    return offset;
 }
 
 /**
  * dump the allocated pages to this `output` stream.
  */
 void dump_pages( URL_FILE *output ) {
-    for ( int i = 0; i < initialised_cons_pages; i++ ) {
-        url_fwprintf( output, L"\nDUMPING PAGE %d\n", i );
-
-        for ( int j = 0; j < CONSPAGESIZE; j++ ) {
-            struct cons_pointer pointer = ( struct cons_pointer ) { i, j };
-            if ( !freep( pointer ) ) {
-                dump_object( output, ( struct cons_pointer ) {
-                             i, j
-                             } );
-            }
+    for ( uint32_t i = 0; i < initialised_cons_pages; i++ ) {
+        url_fwprintf( output, L"\nDUMPING PAGE %u\n", i );
+
+        for ( uint32_t j = next_cell_in_use( i, 0 );
+              j < conspages[i]->high_water;
+              j = next_cell_in_use( i, j + 1 ) ) {
+            dump_object( output, ( struct cons_pointer ) {
+                         i, j
+                         } );
         }
     }
 }
 
 /**
- * Frees the cell at the specified `pointer`; for all the types of cons-space
- * object which point to other cons-space objects, cascade the decrement.
- * Dangerous, primitive, low level.
+ * Return the cell at this `pointer`, whose contents have already been dealt
+ * with, to its page: onto the page's free list if this thread owns the
+ * page, else onto its remote free list. Dangerous, primitive, low level.
  *
- * @pointer the cell to free
+ * @pointer the cell to release
  */
-void free_cell( struct cons_pointer pointer ) {
+void release_cell( struct cons_pointer pointer ) {
+    struct cons_space_object *cell = &pointer2cell( pointer );
+    struct cons_page *page = conspages[pointer.page];
+
+    forget_access( pointer );
+    tag_counter( thread_cell_counters, pointer2tag( pointer ).value )->freed++;
+    strncpy( &pointer2tag( pointer ).bytes[0], FREETAG, TAGLENGTH );
+    pointer2count( pointer ) = 0;
+    cell->payload.free.car = NIL;
+    thread_cells_freed++;
+
+    if ( pointer.page == current_cons_page ) {
+        cell->payload.free.cdr = page->freelist;
+        page->freelist = pointer;
+        page->occupancy--;
+    } else {
+        /* not our page: push it onto the page's remote free list */
+        uint64_t head = __atomic_load_n( &page->remote_freelist,
+                                         __ATOMIC_RELAXED );
+
+        do {
+            cell->payload.free.cdr = unpack_cons_pointer( head );
+        } while ( !__atomic_compare_exchange_n
+                  ( &page->remote_freelist, &head,
+                    pack_cons_pointer( pointer ), true,
+                    __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+
+        if ( head == 0 ) {
+            mark_cons_page_dirty( pointer.page );
+        }
+    }
+}
+
+/**
+ * Return every cell on the page with this `index` to the page at once, by
+ * resetting it to look like a new page, rather than freeing the cells one
+ * by one; the caller must have found every cell in use on the page to be
+ * garbage, and have closed or freed whatever they held outside cons space.
+ * The cells themselves are not touched: only their tags are read, to keep
+ * the counts by type. The page's memory stays resident, to be reused or
+ * released like that of any other empty page. The page must not be owned
+ * by any thread. Must not be called with `cons_space_lock` held.
+ */
+void reset_cons_page( uint32_t index ) {
+    struct cons_page *page = conspages[index];
+
+    for ( uint32_t o = next_cell_in_use( index, 0 ); o < page->high_water;
+          o = next_cell_in_use( index, o + 1 ) ) {
+        struct cons_pointer pointer = { index, o };
+
+        forget_access( pointer );
+        tag_counter( thread_cell_counters,
+                     pointer2tag( pointer ).value )->freed++;
+        thread_cells_freed++;
+    }
+
+    pthread_mutex_lock( &cons_space_lock );
+
+    /* anything on the remote free list is discarded with the rest */
+    __atomic_store_n( &page->remote_freelist, 0, __ATOMIC_RELEASE );
+    unlist_cons_page( index );
+    page->high_water = 0;
+    page->occupancy = 0;
+    page->freelist = NIL;
+    list_cons_page( index );
+
+    pthread_mutex_unlock( &cons_space_lock );
+}
+
+/**
+ * Reclaims the cell at the specified `pointer`; for all the types of
+ * cons-space object which point to other cons-space objects, cascade the
+ * decrement. Cells whose counts thereby reach zero are queued on the work
+ * list, not reclaimed recursively. The references dropped here must be
+ * kept in step with `for_each_child()` in `collect.c`, q.v. Dangerous,
+ * primitive, low level.
+ *
+ * @pointer the cell to reclaim
+ */
+void reclaim_cell( struct cons_pointer pointer ) {
     struct cons_space_object *cell = &pointer2cell( pointer );
 
     debug_printf( DEBUG_ALLOC, L"Freeing cell " );
     debug_dump_object( pointer, DEBUG_ALLOC );
 
     if ( !check_tag( pointer, FREETV ) ) {
-        if ( cell->count == 0 ) {
-            switch ( cell->tag.value ) {
+        if ( pointer2count( pointer ) == 0 ) {
+            dec_ref( forget_access( pointer ) );
+
+            switch ( pointer2tag( pointer ).value ) {
                 case CONSTV:
                     dec_ref( cell->payload.cons.car );
                     dec_ref( cell->payload.cons.cdr );
@@ -193,6 +1163,7 @@ void free_cell( struct cons_pointer pointer ) {
                 case SPECIALTV:
                     dec_ref( cell->payload.special.meta );
                     break;
+                case KEYTV:
                 case STRINGTV:
                 case SYMBOLTV:
                     dec_ref( cell->payload.string.cdr );
@@ -201,19 +1172,16 @@ void free_cell( struct cons_pointer pointer ) {
                     free_vso( pointer );
                     break;
                 default:
-                    fprintf( stderr, "WARNING: Freeing object of type %s!",
-                             ( char * ) &( cell->tag.bytes ) );
+                    fprintf( stderr, "WARNING: Freeing object of type %4.4s!",
+                             ( char * ) &( pointer2tag( pointer ).bytes ) );
             }
 
-            strncpy( &cell->tag.bytes[0], FREETAG, TAGLENGTH );
-            cell->payload.free.car = NIL;
-            cell->payload.free.cdr = freelist;
-            freelist = pointer;
-            total_cells_freed++;
+            release_cell( pointer );
         } else {
             debug_printf( DEBUG_ALLOC,
                           L"ERROR: Attempt to free cell with %d dangling references at page %d, offset %d\n",
-                          cell->count, pointer.page, pointer.offset );
+                          pointer2count( pointer ), pointer.page,
+                          pointer.offset );
         }
     } else {
         debug_printf( DEBUG_ALLOC,
@@ -222,46 +1190,200 @@ void free_cell( struct cons_pointer pointer ) {
     }
 }
 
+/**
+ * @return the current value of the monotonic clock, in nanoseconds.
+ */
+uint64_t reclamation_clock(  ) {
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Reclaim up to `limit` cells from this thread's work list, or all of them
+ * if `limit` is zero, recording the pause in the reclamation statistics.
+ * Pauses which reclaim only a single cell are counted but not timed, since
+ * there are very many of them and they are very short.
+ *
+ * @return the number of cells reclaimed.
+ */
+uint64_t reclaim_pending_cells( uint64_t limit ) {
+    uint64_t n = 0;
+    uint64_t start = 0;
+
+    if ( !reclaiming && pending_cells_count > 0 ) {
+        reclaiming = true;
+
+        while ( pending_cells_count > 0 && ( limit == 0 || n < limit ) ) {
+            reclaim_cell( pending_cells[--pending_cells_count] );
+            n++;
+
+            if ( n == 1 && pending_cells_count > 0 ) {
+                start = reclamation_clock(  );
+            }
+        }
+
+        reclaiming = false;
+
+        reclamation_stats.pauses++;
+        reclamation_stats.cells_reclaimed += n;
+
+        if ( start != 0 ) {
+            uint64_t pause = reclamation_clock(  ) - start;
+
+            reclamation_stats.total_pause_ns += pause;
+            if ( pause > reclamation_stats.max_pause_ns ) {
+                reclamation_stats.max_pause_ns = pause;
+            }
+        }
+    }
+
+    return n;
+}
+
+/**
+ * Frees the cell at the specified `pointer`, whose reference count has
+ * reached zero: that is, pushes it onto this thread's work list and, unless
+ * we are already working through that list or reclamation is incremental
+ * (`reclamation_budget` is non-zero), reclaims everything on it. Because
+ * the list is worked through iteratively, freeing a long list or string
+ * does not recurse once per element.
+ *
+ * @pointer the cell to free
+ */
+void free_cell( struct cons_pointer pointer ) {
+    if ( pending_cells_count == pending_cells_capacity ) {
+        uint64_t capacity =
+            pending_cells_capacity == 0 ? 1024 : pending_cells_capacity * 2;
+        struct cons_pointer *cells = realloc( pending_cells,
+                                              capacity *
+                                              sizeof( struct cons_pointer ) );
+
+        if ( cells == NULL ) {
+            /* can't queue it; the best we can do is reclaim it now */
+            debug_printf( DEBUG_ALLOC,
+                          L"WARNING: failed to grow work list; reclaiming recursively\n" );
+            bool was_reclaiming = reclaiming;
+            reclaiming = true;
+            reclaim_cell( pointer );
+            reclaiming = was_reclaiming;
+            return;
+        }
+
+        pending_cells = cells;
+        pending_cells_capacity = capacity;
+    }
+
+    pending_cells[pending_cells_count++] = pointer;
+
+    if ( pending_cells_count > reclamation_stats.max_pending ) {
+        reclamation_stats.max_pending = pending_cells_count;
+    }
+
+    if ( reclamation_budget == 0 ) {
+        reclaim_pending_cells( 0 );
+    }
+}
+
+/**
+ * @return the reclamation statistics for this thread.
+ */
+struct reclamation_stats get_reclamation_stats(  ) {
+    return reclamation_stats;
+}
+
+/**
+ * Reset the reclamation statistics for this thread.
+ */
+void reset_reclamation_stats(  ) {
+    reclamation_stats = ( struct reclamation_stats ) {
+    0, 0, 0, 0, 0};
+}
+
 /**
  * Allocates a cell with the specified `tag`. Dangerous, primitive, low
  * level.
  *
  * @param tag the tag of the cell to allocate - must be a valid cons space tag.
- * @return the cons pointer which refers to the cell allocated.
- * \todo handle the case where another cons_page cannot be allocated;
- * return an exception. Which, as we cannot create such an exception when
- * cons space is exhausted, means we must construct it at init time.
+ * @return the cons pointer which refers to the cell allocated; or, if cons
+ * space and its emergency reserve are both exhausted, so that there is no
+ * cell to be had, `privileged_exception_memory_exhausted`, which was made
+ * at startup for the purpose; but see `allocation_may_fail`. Callers must
+ * not write to that, so must check for it.
  */
 struct cons_pointer allocate_cell( uint32_t tag ) {
-    struct cons_pointer result = freelist;
+    if ( reclamation_budget > 0 ) {
+        reclaim_pending_cells( reclamation_budget );
+    }
 
+    struct cons_page *page = current_cons_page == NOCONSPAGE ? NULL :
+        conspages[current_cons_page];
 
-    if ( result.page == NIL.page && result.offset == NIL.offset ) {
-        make_cons_page(  );
-        result = allocate_cell( tag );
-    } else {
-        struct cons_space_object *cell = &pointer2cell( result );
+    if ( page != NULL && nilp( page->freelist )
+         && page->high_water >= page->size ) {
+        reclaim_remote_frees( current_cons_page );
+    }
+    if ( page == NULL || ( nilp( page->freelist )
+                           && page->high_water >= page->size ) ) {
+        refill_cons_page(  );
+
+        if ( current_cons_page == NOCONSPAGE ) {
+            if ( !allocation_may_fail ) {
+                fwide( stderr, 1 );
+                fwprintf( stderr,
+                          L"FATAL: Failed to allocate memory for cons page %u\n",
+                          initialised_cons_pages );
+                exit( 1 );
+            }
 
-        if ( strncmp( &cell->tag.bytes[0], FREETAG, TAGLENGTH ) == 0 ) {
-            freelist = cell->payload.free.cdr;
+            /* evaluation will unwind to the REPL, which sheds memory */
+            cons_space_exhausted = true;
+            memory_pressure = true;
 
-            cell->tag.value = tag;
+            return privileged_exception_memory_exhausted;
+        }
+        page = conspages[current_cons_page];
+    }
 
-            cell->count = 1;
-            cell->payload.cons.car = NIL;
-            cell->payload.cons.cdr = NIL;
+    struct cons_pointer result;
+    struct cons_space_object *cell;
 
-            total_cells_allocated++;
+    if ( nilp( page->freelist ) ) {
+        /* never used: take the next cell above the high water mark */
+        result = ( struct cons_pointer ) {
+            current_cons_page, page->high_water++
+        };
+        cell = &pointer2cell( result );
+    } else {
+        /* recycled */
+        result = page->freelist;
+        cell = &pointer2cell( result );
 
+        if ( pointer2tag( result ).value != FREETV ) {
             debug_printf( DEBUG_ALLOC,
-                          L"Allocated cell of type %4.4s at %u, %u \n",
-                          ( ( char * ) cell->tag.bytes ), result.page,
-                          result.offset );
-        } else {
-            debug_printf( DEBUG_ALLOC, L"WARNING: Allocating non-free cell!" );
+                          L"WARNING: Allocating non-free cell!" );
         }
+
+        page->freelist = cell->payload.free.cdr;
     }
 
+    page->occupancy++;
+
+    pointer2tag( result ).value = tag;
+    pointer2count( result ) = 1;
+    cell->payload.cons.car = NIL;
+    cell->payload.cons.cdr = NIL;
+
+    thread_cells_allocated++;
+    tag_counter( thread_cell_counters, tag )->allocated++;
+
+    debug_printf( DEBUG_ALLOC,
+                  L"Allocated cell of type %4.4s at %u, %u \n",
+                  ( ( char * ) pointer2tag( result ).bytes ), result.page,
+                  result.offset );
+
     return result;
 }
 
@@ -270,11 +1392,34 @@ struct cons_pointer allocate_cell( uint32_t tag ) {
  */
 void initialise_cons_pages(  ) {
     if ( conspageinitihasbeencalled == false ) {
-        for ( int i = 0; i < NCONSPAGES; i++ ) {
-            conspages[i] = ( struct cons_page * ) NULL;
+        if ( cons_page_size < 2 ) {
+            /* page zero must at least have room for NIL and T */
+            cons_page_size = 2;
+        }
+        if ( cons_pages_max < 1 ) {
+            cons_pages_max = 1;
         }
+        if ( cons_pages_initial < 1 ) {
+            cons_pages_initial = 1;
+        } else if ( cons_pages_initial > cons_pages_max ) {
+            cons_pages_initial = cons_pages_max;
+        }
+
+        pthread_mutex_lock( &cons_space_lock );
+        for ( uint32_t i = 0; i < cons_pages_initial; i++ ) {
+            uint32_t page = make_cons_page(  );
 
-        make_cons_page(  );
+            if ( page != NOCONSPAGE ) {
+                list_cons_page( page );
+            } else if ( i == 0 ) {
+                fwide( stderr, 1 );
+                fwprintf( stderr,
+                          L"FATAL: Failed to allocate memory for cons space\n" );
+                exit( 1 );
+            }
+        }
+        pthread_mutex_unlock( &cons_space_lock );
+        replenish_cons_reserve(  );
         conspageinitihasbeencalled = true;
     } else {
         debug_printf( DEBUG_ALLOC,
@@ -283,8 +1428,29 @@ void initialise_cons_pages(  ) {
 }
 
 void summarise_allocation(  ) {
+    reclaim_pending_cells( 0 );
+
+    pthread_mutex_lock( &cons_space_lock );
+    flush_cell_counts(  );
+    pthread_mutex_unlock( &cons_space_lock );
+
     fwprintf( stderr,
               L"Allocation summary: allocated %lld; deallocated %lld; not deallocated %lld.\n",
               total_cells_allocated, total_cells_freed,
               total_cells_allocated - total_cells_freed );
 }
+
+/**
+ * Print this thread's reclamation statistics to this `output` stream.
+ */
+void summarise_reclamation( URL_FILE *output ) {
+    url_fwprintf( output,
+                  L"Reclamation summary: pauses %lu; cells reclaimed %lu; "
+                  L"total timed pause %lu ns; longest pause %lu ns; "
+                  L"longest work list %lu.\n",
+                  reclamation_stats.pauses,
+                  reclamation_stats.cells_reclaimed,
+                  reclamation_stats.total_pause_ns,
+                  reclamation_stats.max_pause_ns,
+                  reclamation_stats.max_pending );
+}
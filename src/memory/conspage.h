@@ -2,10 +2,8 @@
  * conspage.h
  *
  * Setup and tear down cons pages, and (FOR NOW) do primitive
- * allocation/deallocation of cells.
- * NOTE THAT before we go multi-threaded, these functions must be
- * aggressively
- * thread safe.
+ * allocation/deallocation of cells. Allocation and freeing are thread
+ * safe: each thread allocates from a page it owns privately.
  *
  * (c) 2017 Simon Brooke <simon@journeyman.cc>
  * Licensed under GPL version 2.0, or, at your option, any later version.
@@ -16,19 +14,18 @@
 #include "memory/consspaceobject.h"
 
 /**
- * the number of cons cells on a cons page. The maximum value this can
- * be (and consequently, the size which, by version 1, it will default
+ * the default number of cons cells on a cons page. The maximum value this
+ * can be (and consequently, the size which, by version 1, it will default
  * to) is the maximum value of an unsigned 32 bit integer, which is to
- * say 4294967296. However, we'll start small.
+ * say 4294967296. However, we'll start small. The value actually used is
+ * held in `cons_page_size`, which may be set at startup.
  */
 #define CONSPAGESIZE 1024
 
 /**
- * the number of cons pages we will initially allow for. For
- * convenience we'll set up an array of cons pages this big; however,
- * later we will want a mechanism for this to be able to grow
- * dynamically to the maximum we can currently allow, which is
- * 4294967296.
+ * the default number of cons pages the directory of cons pages initially
+ * has room for. The directory grows (by doubling) on demand, up to
+ * `cons_pages_max`.
  *
  * Note that this means the total number of addressable cons cells is
  * 1.8e19, each of 20 bytes; or 3e20 bytes in total; and there are
@@ -40,29 +37,188 @@
 #define NCONSPAGES 64
 
 /**
- * a cons page is essentially just an array of cons space objects. It
- * might later have a local free list (i.e. list of free cells on this
- * page) and a pointer to the next cons page, but my current view is
- * that that's probably unneccessary.
+ * the default maximum number of cons pages we will allow for; with the
+ * default page size, that's 64 million cells.
+ */
+#define MAXCONSPAGES 65536
+
+/**
+ * the default number of wholly empty cons pages to keep resident, rather
+ * than returning their memory to the operating system.
+ */
+#define DFLT_CONS_PAGES_RETAINED 8
+
+/**
+ * The number of empty cons pages held in reserve, to be allocated from only
+ * when cons space is otherwise exhausted, so that the interpreter can
+ * report the exhaustion, and recover from it, rather than dying.
+ */
+#define CONS_PAGES_RESERVED 1
+
+/**
+ * the alignment of the start of cons space when it is to be backed by
+ * transparent huge pages: the size of a huge page on x86-64.
+ */
+#define CONS_SPACE_ALIGNMENT (2 * 1024 * 1024)
+
+/**
+ * the number of bands into which we sort pages which have free cells,
+ * according to how many free cells they have, so that we can find a busy
+ * page to allocate from without scanning every page.
+ */
+#define NCONSPAGEBANDS 8
+
+/**
+ * marker for 'no page', used in the band lists.
+ */
+#define NOCONSPAGE UINT32_MAX
+
+/**
+ * a cons page is essentially just an array of cons space objects. Its
+ * length is `cons_page_size`, which is fixed once the first page has been
+ * made. The cells, with their tags and reference counts, are held apart
+ * from the page's header, at a fixed place in `cons_space`, a region of
+ * address space reserved at startup, so that a cell is found by arithmetic
+ * on its cons pointer, and so that when the page is empty all of their
+ * memory can be handed back to the operating system. Cells which have
+ * never been used are handed out in order from the page's `high_water`
+ * mark. Each page also keeps its own free list (i.e.
+ * list of cells on this page which have been freed) and a count of the
+ * cells on it which are in use, so that we can allocate from the currently
+ * most active page, and keep the cells of a structure built at one time
+ * close together in memory. See `docs/Free-list.md`.
  */
 struct cons_page {
-    struct cons_space_object cell[CONSPAGESIZE];
+    /** the number of cells on this page. */
+    uint32_t size;
+    /** the number of cells on this page which are currently in use. */
+    uint32_t occupancy;
+    /** the offset of the first cell on this page which has never been
+     * used; cells above this are not initialised. */
+    uint32_t high_water;
+    /** the free cells on this page which have been used and then freed,
+     * consed together. */
+    struct cons_pointer freelist;
+    /** the band this page is listed in, or -1 if it is not listed. */
+    int32_t band;
+    /** the next page in the same band, or `NOCONSPAGE`. */
+    uint32_t band_next;
+    /** the previous page in the same band, or `NOCONSPAGE`. */
+    uint32_t band_prev;
+    /** the identifier of the thread which owns this page, and is
+     * allocating from it, or 0 if none. */
+    uint32_t owner;
+    /** non-zero while this page is on the stack of dirty pages. */
+    uint32_t dirty;
+    /** the next page on the stack of dirty pages, or `NOCONSPAGE`. */
+    uint32_t dirty_next;
+    /** cells on this page freed by threads other than its owner, consed
+     * together; a cons pointer packed into one word, updated atomically. */
+    uint64_t remote_freelist;
+    /** true if this page is empty and held in the emergency reserve. */
+    bool reserved;
+    /** true if cells have been allocated from this page since it was made
+     * or last released, so that its memory is resident. */
+    bool resident;
+    /** true if cells may have been allocated on this page since the last
+     * mark-sweep collection; only such pages are swept when only the
+     * nursery is collected. */
+    bool young;
 };
 
+/**
+ * statistics on the pauses spent reclaiming cells whose reference counts
+ * have reached zero.
+ */
+struct reclamation_stats {
+    /** the number of times we have worked through the work list. */
+    uint64_t pauses;
+    /** the total number of cells reclaimed. */
+    uint64_t cells_reclaimed;
+    /** the total time spent in (timed) pauses, in nanoseconds. */
+    uint64_t total_pause_ns;
+    /** the longest single pause, in nanoseconds. */
+    uint64_t max_pause_ns;
+    /** the greatest number of cells ever waiting on the work list. */
+    uint64_t max_pending;
+};
+
+extern uint32_t cons_page_size;
+
+extern uint32_t cons_pages_initial;
+
+extern uint32_t cons_pages_max;
+
+extern uint32_t cons_pages_retained;
+
+extern uint32_t cons_pages_soft_limit;
+
+extern uint32_t resident_cons_pages;
+
+extern bool cons_space_exhausted;
+
+extern bool allocation_may_fail;
+
+extern bool memory_pressure;
+
 extern struct cons_pointer privileged_string_memory_exhausted;
 
-extern struct cons_pointer freelist;
+extern struct cons_pointer privileged_exception_memory_exhausted;
+
+extern struct cons_page **conspages;
+
+extern char *cons_space;
+
+extern size_t cons_page_stride;
+
+extern size_t cons_tags_offset;
+
+extern size_t cons_counts_offset;
+
+extern bool cons_space_huge_pages;
+
+extern uint32_t initialised_cons_pages;
+
+extern uint64_t total_cells_allocated;
+
+extern uint32_t reclamation_budget;
 
-extern struct cons_page *conspages[NCONSPAGES];
+void release_cell( struct cons_pointer pointer );
 
 void free_cell( struct cons_pointer pointer );
 
+uint64_t reclamation_clock(  );
+
+uint64_t reclaim_pending_cells( uint64_t limit );
+
+struct reclamation_stats get_reclamation_stats(  );
+
+void reset_reclamation_stats(  );
+
 struct cons_pointer allocate_cell( uint32_t tag );
 
 void initialise_cons_pages(  );
 
+void release_cons_pages(  );
+
+uint32_t release_empty_cons_pages_keeping( uint32_t keep );
+
+uint32_t release_empty_cons_pages(  );
+
+bool replenish_cons_reserve(  );
+
+void reset_cons_page( uint32_t index );
+
+uint32_t next_cell_in_use( uint32_t page, uint32_t offset );
+
 void dump_pages( URL_FILE * output );
 
 void summarise_allocation(  );
 
+void summarise_reclamation( URL_FILE * output );
+
+void summarise_cons_pages( URL_FILE * output );
+
+void summarise_memory_by_tag( URL_FILE * output );
+
 #endif
@@ -22,9 +22,11 @@
 #include "debug.h"
 #include "io/print.h"
 #include "memory/conspage.h"
+#include "memory/pstring.h"
 #include "memory/consspaceobject.h"
 #include "memory/stack.h"
 #include "memory/vectorspace.h"
+#include "ops/equal.h"
 #include "ops/intern.h"
 
 /**
@@ -73,11 +75,10 @@ struct cons_pointer privileged_keyword_primitive = NIL;
 bool check_tag( struct cons_pointer pointer, uint32_t value ) {
     bool result = false;
 
-    struct cons_space_object *cell = &pointer2cell( pointer );
-    result = cell->tag.value == value;
+    result = pointer2tag( pointer ).value == value;
 
     if ( result == false ) {
-        if ( cell->tag.value == VECTORPOINTTV ) {
+        if ( pointer2tag( pointer ).value == VECTORPOINTTV ) {
             struct vector_space_object *vec = pointer_to_vso( pointer );
 
             if ( vec != NULL ) {
@@ -89,25 +90,34 @@ bool check_tag( struct cons_pointer pointer, uint32_t value ) {
     return result;
 }
 
+#ifndef MARK_SWEEP
+/**
+ * True if memory is managed by reference counting, false if by the
+ * mark-sweep collector.
+ */
+bool reference_counting = true;
+
 /**
  * increment the reference count of the object at this cons pointer.
  *
  * You can't roll over the reference count. Once it hits the maximum
- * value you cannot increment further.
+ * value you cannot increment further. Does nothing if memory is not being
+ * managed by reference counting.
  *
  * Returns the `pointer`.
  */
 struct cons_pointer inc_ref( struct cons_pointer pointer ) {
     struct cons_space_object *cell = &pointer2cell( pointer );
 
-    if ( cell->count < MAXREFERENCE ) {
-        cell->count++;
+    if ( reference_counting && pointer2count( pointer ) < MAXREFERENCE ) {
+        pointer2count( pointer )++;
 #ifdef DEBUG
         debug_printf( DEBUG_ALLOC,
                       L"\nIncremented cell of type %4.4s at page %u, offset %u to count %u",
-                      ( ( char * ) cell->tag.bytes ), pointer.page,
-                      pointer.offset, cell->count );
-        if ( strncmp( cell->tag.bytes, VECTORPOINTTAG, TAGLENGTH ) == 0 ) {
+                      ( ( char * ) pointer2tag( pointer ).bytes ), pointer.page,
+                      pointer.offset, pointer2count( pointer ) );
+        if ( strncmp( pointer2tag( pointer ).bytes, VECTORPOINTTAG, TAGLENGTH )
+             == 0 ) {
             debug_printf( DEBUG_ALLOC,
                           L"; pointer to vector object of type %4.4s.\n",
                           ( ( char * ) ( cell->payload.vectorp.tag.bytes ) ) );
@@ -124,22 +134,24 @@ struct cons_pointer inc_ref( struct cons_pointer pointer ) {
  * Decrement the reference count of the object at this cons pointer.
  *
  * If a count has reached MAXREFERENCE it cannot be decremented.
- * If a count is decremented to zero the cell should be freed.
+ * If a count is decremented to zero the cell should be freed. Does nothing
+ * if memory is not being managed by reference counting.
  *
  * Returns the `pointer`, or, if the cell has been freed, NIL.
  */
 struct cons_pointer dec_ref( struct cons_pointer pointer ) {
     struct cons_space_object *cell = &pointer2cell( pointer );
 
-    if ( cell->count > 0 && cell->count != UINT32_MAX ) {
-        cell->count--;
+    if ( reference_counting && pointer2count( pointer ) > 0
+         && pointer2count( pointer ) != UINT32_MAX ) {
+        pointer2count( pointer )--;
 #ifdef DEBUG
         debug_printf( DEBUG_ALLOC,
                       L"\nDecremented cell of type %4.4s at page %d, offset %d to count %d",
-                      ( ( char * ) cell->tag.bytes ), pointer.page,
-                      pointer.offset, cell->count );
-        if ( strncmp( ( char * ) cell->tag.bytes, VECTORPOINTTAG, TAGLENGTH )
-             == 0 ) {
+                      ( ( char * ) pointer2tag( pointer ).bytes ), pointer.page,
+                      pointer.offset, pointer2count( pointer ) );
+        if ( strncmp( ( char * ) pointer2tag( pointer ).bytes, VECTORPOINTTAG,
+                      TAGLENGTH ) == 0 ) {
             debug_printf( DEBUG_ALLOC,
                           L"; pointer to vector object of type %4.4s.\n",
                           ( ( char * ) ( cell->payload.vectorp.tag.bytes ) ) );
@@ -148,7 +160,7 @@ struct cons_pointer dec_ref( struct cons_pointer pointer ) {
         }
 #endif
 
-        if ( cell->count == 0 ) {
+        if ( pointer2count( pointer ) == 0 ) {
             free_cell( pointer );
             pointer = NIL;
         }
@@ -156,12 +168,13 @@ struct cons_pointer dec_ref( struct cons_pointer pointer ) {
 
     return pointer;
 }
+#endif
 
 /**
  * given a cons_pointer as argument, return the tag.
  */
 uint32_t get_tag_value( struct cons_pointer pointer ) {
-    uint32_t result = pointer2cell( pointer ).tag.value;
+    uint32_t result = pointer2tag( pointer ).value;
 
     if ( result == VECTORPOINTTV ) {
         result = pointer_to_vso( pointer )->header.tag.value;
@@ -182,9 +195,8 @@ struct cons_pointer c_type( struct cons_pointer pointer ) {
      * fixed, and actually that's probably strings read by `read`. However,
      * for now, it was easier to add a null character here. */
     struct cons_pointer result = make_string( ( wchar_t ) 0, NIL );
-    struct cons_space_object *cell = &pointer2cell( pointer );
 
-    if ( cell->tag.value == VECTORPOINTTV ) {
+    if ( pointer2tag( pointer ).value == VECTORPOINTTV ) {
         struct vector_space_object *vec = pointer_to_vso( pointer );
 
         for ( int i = TAGLENGTH - 1; i >= 0; i-- ) {
@@ -193,7 +205,9 @@ struct cons_pointer c_type( struct cons_pointer pointer ) {
         }
     } else {
         for ( int i = TAGLENGTH - 1; i >= 0; i-- ) {
-            result = make_string( ( wchar_t ) cell->tag.bytes[i], result );
+            result =
+                make_string( ( wchar_t ) pointer2tag( pointer ).bytes[i],
+                             result );
         }
     }
 
@@ -224,7 +238,7 @@ struct cons_pointer c_cdr( struct cons_pointer arg ) {
     if ( truep( authorised( arg, NIL ) ) ) {
         struct cons_space_object *cell = &pointer2cell( arg );
 
-        switch ( cell->tag.value ) {
+        switch ( pointer2tag( arg ).value ) {
             case CONSTV:
                 result = cell->payload.cons.cdr;
                 break;
@@ -233,6 +247,13 @@ struct cons_pointer c_cdr( struct cons_pointer arg ) {
             case SYMBOLTV:
                 result = cell->payload.string.cdr;
                 break;
+            case VECTORPOINTTV:
+                if ( pstringp( arg ) ) {
+                    result =
+                        pointer2cell( pstring_cells( arg ) ).payload.string.
+                        cdr;
+                }
+                break;
         }
     }
 
@@ -262,12 +283,14 @@ struct cons_pointer make_cons( struct cons_pointer car,
 
     pointer = allocate_cell( CONSTV );
 
-    struct cons_space_object *cell = &pointer2cell( pointer );
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
 
-    inc_ref( car );
-    inc_ref( cdr );
-    cell->payload.cons.car = car;
-    cell->payload.cons.cdr = cdr;
+        inc_ref( car );
+        inc_ref( cdr );
+        cell->payload.cons.car = car;
+        cell->payload.cons.cdr = cdr;
+    }
 
     return pointer;
 }
@@ -283,11 +306,15 @@ struct cons_pointer make_exception( struct cons_pointer message,
                                     struct cons_pointer frame_pointer ) {
     struct cons_pointer result = NIL;
     struct cons_pointer pointer = allocate_cell( EXCEPTIONTV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
 
-    inc_ref( frame_pointer );
-    cell->payload.exception.payload = message;
-    cell->payload.exception.frame = frame_pointer;
+    /* if memory is exhausted, that is the exception we are given */
+    if ( !eq( pointer, privileged_exception_memory_exhausted ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+
+        inc_ref( frame_pointer );
+        cell->payload.exception.payload = message;
+        cell->payload.exception.frame = frame_pointer;
+    }
 
     result = pointer;
 
@@ -307,11 +334,14 @@ struct cons_pointer make_function( struct cons_pointer meta,
                                                                          cons_pointer ) ) 
 {
     struct cons_pointer pointer = allocate_cell( FUNCTIONTV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
-    inc_ref( meta );
 
-    cell->payload.function.meta = meta;
-    cell->payload.function.executable = executable;
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+        inc_ref( meta );
+
+        cell->payload.function.meta = meta;
+        cell->payload.function.executable = executable;
+    }
 
     return pointer;
 }
@@ -322,12 +352,15 @@ struct cons_pointer make_function( struct cons_pointer meta,
 struct cons_pointer make_lambda( struct cons_pointer args,
                                  struct cons_pointer body ) {
     struct cons_pointer pointer = allocate_cell( LAMBDATV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
 
-    inc_ref( args );
-    inc_ref( body );
-    cell->payload.lambda.args = args;
-    cell->payload.lambda.body = body;
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+
+        inc_ref( args );
+        inc_ref( body );
+        cell->payload.lambda.args = args;
+        cell->payload.lambda.body = body;
+    }
 
     return pointer;
 }
@@ -340,45 +373,43 @@ struct cons_pointer make_nlambda( struct cons_pointer args,
                                   struct cons_pointer body ) {
     struct cons_pointer pointer = allocate_cell( NLAMBDATV );
 
-    struct cons_space_object *cell = &pointer2cell( pointer );
-    inc_ref( args );
-    inc_ref( body );
-    cell->payload.lambda.args = args;
-    cell->payload.lambda.body = body;
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+        inc_ref( args );
+        inc_ref( body );
+        cell->payload.lambda.args = args;
+        cell->payload.lambda.body = body;
+    }
 
     return pointer;
 }
 
 /**
- * Return a hash value for this string like thing.
+ * Return a hash value for the string like thing which is this character `c`
+ * followed by the string `ptr`.
  *
  * What's important here is that two strings with the same characters in the
  * same order should have the same hash value, even if one was created using
- * `"foobar"` and the other by `(append "foo" "bar")`. I *think* this function
- * has that property. I doubt that it's the most efficient hash function to
- * have that property.
- *
- * returns 0 for things which are not string like.
+ * `"foobar"` and the other by `(append "foo" "bar")`, or one is packed and
+ * the other is not; and that strings which differ in the order of their
+ * characters should be unlikely to have the same hash, since the keys of
+ * a hashmap, such as the oblist, are spread over its buckets by their hash.
+ * Since strings are made from the end, the hash is of the characters in
+ * reverse order; see `string_hash_step`.
  */
 uint32_t calculate_hash( wint_t c, struct cons_pointer ptr ) {
     struct cons_space_object *cell = &pointer2cell( ptr );
-    uint32_t result = 0;
+    uint32_t result = STRING_HASH_BASIS;
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( ptr ).value ) {
         case KEYTV:
         case STRINGTV:
         case SYMBOLTV:
-            if ( nilp( cell->payload.string.cdr ) ) {
-                result = ( uint32_t ) c;
-            } else {
-                result =
-                    ( ( uint32_t ) c *
-                      cell->payload.string.hash ) & 0xffffffff;
-            }
+            result = cell->payload.string.hash;
             break;
     }
 
-    return result;
+    return string_hash_step( result, c );
 }
 
 /**
@@ -393,14 +424,17 @@ struct cons_pointer make_string_like_thing( wint_t c, struct cons_pointer tail,
 
     if ( check_tag( tail, tag ) || check_tag( tail, NILTV ) ) {
         pointer = allocate_cell( tag );
-        struct cons_space_object *cell = &pointer2cell( pointer );
 
-        cell->payload.string.character = c;
-        cell->payload.string.cdr = tail;
+        if ( !exceptionp( pointer ) ) {
+            struct cons_space_object *cell = &pointer2cell( pointer );
+
+            cell->payload.string.character = c;
+            cell->payload.string.cdr = tail;
 
-        cell->payload.string.hash = calculate_hash( c, tail );
-        debug_dump_object( pointer, DEBUG_ALLOC );
-        debug_println( DEBUG_ALLOC );
+            cell->payload.string.hash = calculate_hash( c, tail );
+            debug_dump_object( pointer, DEBUG_ALLOC );
+            debug_println( DEBUG_ALLOC );
+        }
     } else {
         // \todo should throw an exception!
         debug_printf( DEBUG_ALLOC,
@@ -471,11 +505,14 @@ struct cons_pointer make_special( struct cons_pointer meta,
                                                                         env ) ) 
 {
     struct cons_pointer pointer = allocate_cell( SPECIALTV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
-    inc_ref( meta );
 
-    cell->payload.special.meta = meta;
-    cell->payload.special.executable = executable;
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+        inc_ref( meta );
+
+        cell->payload.special.meta = meta;
+        cell->payload.special.executable = executable;
+    }
 
     return pointer;
 }
@@ -489,10 +526,13 @@ struct cons_pointer make_special( struct cons_pointer meta,
 struct cons_pointer make_read_stream( URL_FILE *input,
                                       struct cons_pointer metadata ) {
     struct cons_pointer pointer = allocate_cell( READTV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
 
-    cell->payload.stream.stream = input;
-    cell->payload.stream.meta = metadata;
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+
+        cell->payload.stream.stream = input;
+        cell->payload.stream.meta = metadata;
+    }
 
     return pointer;
 }
@@ -506,10 +546,13 @@ struct cons_pointer make_read_stream( URL_FILE *input,
 struct cons_pointer make_write_stream( URL_FILE *output,
                                        struct cons_pointer metadata ) {
     struct cons_pointer pointer = allocate_cell( WRITETV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
 
-    cell->payload.stream.stream = output;
-    cell->payload.stream.meta = metadata;
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
+
+        cell->payload.stream.stream = output;
+        cell->payload.stream.meta = metadata;
+    }
 
     return pointer;
 }
@@ -328,15 +328,30 @@ extern struct cons_pointer privileged_keyword_primitive;
 #define tag2uint(tag) ((uint32_t)*tag)
 
 /**
- * given a cons_pointer as argument, return the cell.
+ * given a cons_pointer as argument, return the cell. Cells are found by
+ * arithmetic on the pointer; see `cons_space` in `conspage.c`.
  */
-#define pointer2cell(pointer) ((conspages[pointer.page]->cell[pointer.offset]))
+#define pointer2cell(pointer) (((struct cons_space_object *)(cons_space + (size_t)(pointer).page * cons_page_stride))[(pointer).offset])
 
 /**
- * true if `conspoint` points to the special cell NIL, else false
- * (there should only be one of these so it's slightly redundant).
+ * given a cons_pointer as argument, return the tag of the cell, as a
+ * `union cell_tag`. Tags are held apart from the cells, in a dense array
+ * for each page, so that checking the type of a cell, or scanning a page
+ * for cells of a type, need not touch the rest of the cell.
  */
-#define nilp(conspoint) (check_tag(conspoint,NILTV))
+#define pointer2tag(pointer) (((union cell_tag *)(cons_space + (size_t)(pointer).page * cons_page_stride + cons_tags_offset))[(pointer).offset])
+
+/**
+ * given a cons_pointer as argument, return the count of the number of
+ * references to the cell. Like tags, counts are held in a dense array for
+ * each page.
+ */
+#define pointer2count(pointer) (((uint32_t *)(cons_space + (size_t)(pointer).page * cons_page_stride + cons_counts_offset))[(pointer).offset])
+
+/**
+ * true if `conspoint` points to the special cell NIL, else false.
+ */
+#define nilp(conspoint) (nil_pointer_p(conspoint))
 
 /**
  * true if `conspoint` points to a cons cell, else false
@@ -448,7 +463,7 @@ extern struct cons_pointer privileged_keyword_primitive;
  * true if `conspoint` points to something that is truthy, i.e.
  * anything but NIL.
  */
-#define truep(conspoint) (!check_tag(conspoint,NILTV))
+#define truep(conspoint) (!nil_pointer_p(conspoint))
 
 /**
  * An indirect pointer to a cons cell
@@ -460,8 +475,18 @@ struct cons_pointer {
     uint32_t offset;
 };
 
+/**
+ * true if `pointer` is the pointer to the special cell NIL. As there is
+ * only one such cell, this need not look at the tag, which is held apart
+ * from the cell; so walking a list touches only the cells of the list.
+ */
+static inline bool nil_pointer_p( struct cons_pointer pointer ) {
+    return pointer.page == 0 && pointer.offset == 0;
+}
+
 /*
- * number of arguments stored in a stack frame
+ * the least number of argument slots in a stack frame; a frame called with
+ * more arguments than this has a slot for each of them.
  */
 #define args_in_frame 8
 
@@ -472,16 +497,16 @@ struct cons_pointer {
 struct stack_frame {
     /** the previous frame. */
     struct cons_pointer previous;
-    /** first 8 arument bindings. */
-    struct cons_pointer arg[args_in_frame];
-    /** list of any further argument bindings. */
-    struct cons_pointer more;
     /** the function to be called. */
     struct cons_pointer function;
     /** the number of arguments provided. */
     int args;
     /** the depth of the stack below this frame */
     int depth;
+    /** the number of argument slots, never fewer than `args_in_frame`. */
+    int slots;
+    /** the argument bindings, one to each slot. */
+    struct cons_pointer arg[];
 };
 
 /**
@@ -578,9 +603,11 @@ struct ratio_payload {
 
 /**
  * payload for a real number cell. Internals of this liable to change to give 128 bits
- * precision, but I'm not sure of the detail.
+ * precision, but I'm not sure of the detail. A `long double` would normally
+ * be aligned to sixteen bytes, which would pad every cell to thirty two;
+ * so the payload is packed to eight byte alignment.
  */
-struct real_payload {
+struct __attribute__( ( packed, aligned( 8 ) ) ) real_payload {
     /** the value of the number */
     long double value;
 };
@@ -633,12 +660,27 @@ struct string_payload {
     struct cons_pointer cdr;
 };
 
+/**
+ * The hash of the empty string, from which those of longer strings are
+ * made, a character at a time from the end, by `string_hash_step`. This
+ * is FNV-1a, over the characters in reverse order.
+ */
+#define STRING_HASH_BASIS 2166136261U
+
+/**
+ * The hash of a string which is this character `c` followed by a string
+ * whose hash is `h`. The null character which ends some strings is not
+ * hashed, so that a string hashes alike with or without it.
+ */
+#define string_hash_step(h, c)((c) == 0 ? (h) : (((h) ^ (uint32_t) (c)) * 16777619U))
+
 /**
  * The payload of a time cell: an unsigned 128 bit value representing micro-
  * seconds since the estimated date of the Big Bang (actually, for
- * convenience, 14Bn years before 1st Jan 1970 (the UNIX epoch))
+ * convenience, 14Bn years before 1st Jan 1970 (the UNIX epoch)). Like the
+ * real payload, packed to eight byte alignment.
  */
-struct time_payload {
+struct __attribute__( ( packed, aligned( 8 ) ) ) time_payload {
     unsigned __int128 value;
 };
 
@@ -664,20 +706,22 @@ struct vectorp_payload {
 };
 
 /**
- * an object in cons space.
+ * the tag (type) of a cell in cons space.
+ */
+union cell_tag {
+    /** the tag considered as bytes */
+    char bytes[TAGLENGTH];
+    /** the tag considered as a number */
+    uint32_t value;
+};
+
+/**
+ * an object in cons space. Its tag and its reference count are held
+ * apart from it; see `pointer2tag` and `pointer2count`. So is its access
+ * control list, if it has one; see `get_access`. So the object is just its
+ * payload, sixteen bytes.
  */
 struct cons_space_object {
-    union {
-        /** the tag (type) of this cell,
-         * considered as bytes */
-        char bytes[TAGLENGTH];
-        /** the tag considered as a number */
-        uint32_t value;
-    } tag;
-    /** the count of the number of references to this cell */
-    uint32_t count;
-    /** cons pointer to the access control list of this cell */
-    struct cons_pointer access;
     union {
         /**
          * if tag == CONSTAG
@@ -744,9 +788,32 @@ struct cons_space_object {
 
 bool check_tag( struct cons_pointer pointer, uint32_t value );
 
+#ifdef MARK_SWEEP
+/**
+ * Built with `-DMARK_SWEEP`, memory is managed only by the mark-sweep
+ * collector in `collect.c`, and reference counts are never maintained.
+ */
+#define reference_counting false
+
+static inline struct cons_pointer inc_ref( struct cons_pointer pointer ) {
+    return pointer;
+}
+
+static inline struct cons_pointer dec_ref( struct cons_pointer pointer ) {
+    return pointer;
+}
+#else
+/**
+ * True if memory is managed by reference counting, false if by the
+ * mark-sweep collector in `collect.c`. Chosen at startup, and never
+ * changed thereafter.
+ */
+extern bool reference_counting;
+
 struct cons_pointer inc_ref( struct cons_pointer pointer );
 
 struct cons_pointer dec_ref( struct cons_pointer pointer );
+#endif
 
 /**
  * given a cons_pointer as argument, return the tag.
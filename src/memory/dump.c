@@ -18,14 +18,19 @@
 #include <wchar.h>
 #include <wctype.h>
 
+#include "arith/array.h"
+#include "memory/bytes.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
 #include "debug.h"
+#include "memory/hamt.h"
 #include "memory/hashmap.h"
+#include "memory/pstring.h"
 #include "ops/intern.h"
 #include "io/io.h"
 #include "io/print.h"
 #include "memory/stack.h"
+#include "memory/vector.h"
 #include "memory/vectorspace.h"
 
 
@@ -37,7 +42,8 @@ void dump_string_cell( URL_FILE *output, wchar_t *prefix,
                       L"\t\t%ls cell: termination; next at page %d offset %d, count %u\n",
                       prefix,
                       cell.payload.string.cdr.page,
-                      cell.payload.string.cdr.offset, cell.count );
+                      cell.payload.string.cdr.offset,
+                      pointer2count( pointer ) );
     } else {
         url_fwprintf( output,
                       L"\t\t%ls cell: character '%lc' (%d) with hash %d; next at page %d offset %d, count %u\n",
@@ -46,7 +52,8 @@ void dump_string_cell( URL_FILE *output, wchar_t *prefix,
                       cell.payload.string.character,
                       cell.payload.string.hash,
                       cell.payload.string.cdr.page,
-                      cell.payload.string.cdr.offset, cell.count );
+                      cell.payload.string.cdr.offset,
+                      pointer2count( pointer ) );
         url_fwprintf( output, L"\t\t value: " );
         print( output, pointer );
         url_fwprintf( output, L"\n" );
@@ -59,10 +66,11 @@ void dump_string_cell( URL_FILE *output, wchar_t *prefix,
 void dump_object( URL_FILE *output, struct cons_pointer pointer ) {
     struct cons_space_object cell = pointer2cell( pointer );
     url_fwprintf( output, L"\t%4.4s (%d) at page %d, offset %d count %u\n",
-                  cell.tag.bytes, cell.tag.value, pointer.page, pointer.offset,
-                  cell.count );
+                  pointer2tag( pointer ).bytes, pointer2tag( pointer ).value,
+                  pointer.page, pointer.offset,
+                  pointer2count( pointer ) );
 
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( pointer ).value ) {
         case CONSTV:
             url_fwprintf( output,
                           L"\t\tCons cell: car at page %d offset %d, cdr at page %d "
@@ -70,7 +78,8 @@ void dump_object( URL_FILE *output, struct cons_pointer pointer ) {
                           cell.payload.cons.car.page,
                           cell.payload.cons.car.offset,
                           cell.payload.cons.cdr.page,
-                          cell.payload.cons.cdr.offset, cell.count );
+                          cell.payload.cons.cdr.offset,
+                          pointer2count( pointer ) );
             print( output, pointer );
             url_fputws( L"\n", output );
             break;
@@ -86,7 +95,8 @@ void dump_object( URL_FILE *output, struct cons_pointer pointer ) {
             break;
         case INTEGERTV:
             url_fwprintf( output, L"\t\tInteger cell: value %ld, count %u\n",
-                          cell.payload.integer.value, cell.count );
+                          cell.payload.integer.value,
+                          pointer2count( pointer ) );
             if ( !nilp( cell.payload.integer.more ) ) {
                 url_fputws( L"\t\tBIGNUM! More at:\n", output );
                 dump_object( output, cell.payload.integer.more );
@@ -117,7 +127,7 @@ void dump_object( URL_FILE *output, struct cons_pointer pointer ) {
                           pointer2cell( cell.payload.ratio.dividend ).
                           payload.integer.value,
                           pointer2cell( cell.payload.ratio.divisor ).
-                          payload.integer.value, cell.count );
+                          payload.integer.value, pointer2count( pointer ) );
             break;
         case READTV:
             url_fputws( L"\t\tInput stream; metadata: ", output );
@@ -126,7 +136,7 @@ void dump_object( URL_FILE *output, struct cons_pointer pointer ) {
             break;
         case REALTV:
             url_fwprintf( output, L"\t\tReal cell: value %Lf, count %u\n",
-                          cell.payload.real.value, cell.count );
+                          cell.payload.real.value, pointer2count( pointer ) );
             break;
         case STRINGTV:
             dump_string_cell( output, L"String", pointer );
@@ -151,9 +161,34 @@ void dump_object( URL_FILE *output, struct cons_pointer pointer ) {
                     case STACKFRAMETV:
                         dump_frame( output, pointer );
                         break;
+                    case HAMTTV:
+                        dump_hamt( output, pointer );
+                        break;
                     case HASHTV:
                         dump_map( output, pointer );
                         break;
+                    case PSTRINGTV:
+                        dump_pstring( output, pointer );
+                        break;
+                    case BYTESTV:
+                        url_fwprintf( output,
+                                      L"\t\tByte buffer of %lu bytes%s: ",
+                                      bytes_length( pointer ),
+                                      nilp( vso->payload.bytebuffer.base ) ?
+                                      "" : ", a slice" );
+                        print_bytes( output, pointer );
+                        url_fputws( L"\n", output );
+                        break;
+                    case INTARRAYTV:
+                    case REALARRAYTV:
+                        url_fwprintf( output, L"\t\tArray of %lu elements: ",
+                                      numeric_array_length( pointer ) );
+                        print_numeric_array( output, pointer );
+                        url_fputws( L"\n", output );
+                        break;
+                    case VECTORTV:
+                        dump_vector( output, pointer );
+                        break;
                 }
             }
             break;
@@ -0,0 +1,714 @@
+/*
+ * hamt.c
+ *
+ * Persistent hashmaps, held as hash array mapped tries. The keys of a map
+ * lie in a tree of nodes, each of which has an entry for each of the
+ * values which the next five bits of the hashes of the keys below it take;
+ * an entry is either a key and its value, or a branch to a further node.
+ *
+ * Nodes are never changed once made. A map with a key added, changed or
+ * removed is made by copying the nodes on the path from the root to that
+ * key, which are few however many keys there are, and sharing every other
+ * node with the map it was made from. So a hashmap which may not be
+ * written, to which `put!` must give a new map rather than change the old,
+ * costs no more to `put!` to than one which may be written. A map with no
+ * write access control list, as maps read are, may be written by nobody.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "authorise.h"
+#include "debug.h"
+#include "io/print.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/hamt.h"
+#include "memory/vectorspace.h"
+#include "ops/equal.h"
+#include "ops/intern.h"
+
+/**
+ * @return the payload of the node of a trie indicated by this `pointer`.
+ */
+#define hamt_node(pointer)(&(pointer_to_vso(pointer)->payload.hamtnode))
+
+/**
+ * @return the index, among the 32 a node might have, of the entry for this
+ * `hash` in a node at this `shift`, i.e. depth times `HAMT_BITS`.
+ */
+#define hamt_index(hash, shift)(((hash) >> (shift)) & ((1 << HAMT_BITS) - 1))
+
+/**
+ * Make a node with this `bitmap` and room for this `count` of entries, to
+ * be filled by the caller.
+ */
+static struct cons_pointer make_hamt_node( uint32_t bitmap, uint32_t count ) {
+    struct cons_pointer result =
+        make_vso( HAMTNODETV, sizeof( struct hamt_node_payload ) +
+                  sizeof( struct hamt_entry ) * count );
+    struct hamt_node_payload *payload = hamt_node( result );
+
+    payload->bitmap = bitmap;
+    payload->count = count;
+
+    return result;
+}
+
+/**
+ * Make a persistent hashmap with no keys, using this `hash_fn`, and
+ * protected by this `write_acl`. If `hash_fn` is `NIL`, use the standard
+ * hash function.
+ */
+struct cons_pointer make_hamt( struct cons_pointer hash_fn,
+                               struct cons_pointer write_acl ) {
+    /* make_vso zeroes the payload, so that the root is `NIL` */
+    struct cons_pointer result =
+        make_vso( HAMTTV, sizeof( struct hamt_payload ) );
+    struct hamt_payload *payload = hamt_payload( result );
+
+    payload->hash_fn = inc_ref( hash_fn );
+    payload->write_acl = inc_ref( write_acl );
+
+    return result;
+}
+
+/**
+ * Free the persistent hashmap indicated by this `pointer`. Its nodes are
+ * freed only if no other map shares them.
+ */
+void free_hamt( struct cons_pointer pointer ) {
+    struct hamt_payload *payload = hamt_payload( pointer );
+
+    dec_ref( payload->hash_fn );
+    dec_ref( payload->write_acl );
+    dec_ref( payload->root );
+}
+
+/**
+ * Free the node of a trie indicated by this `pointer`.
+ */
+void free_hamt_node( struct cons_pointer pointer ) {
+    struct hamt_node_payload *payload = hamt_node( pointer );
+
+    for ( uint32_t i = 0; i < payload->count; i++ ) {
+        dec_ref( payload->entries[i].key );
+        dec_ref( payload->entries[i].value );
+    }
+}
+
+/**
+ * @return the number of keys in the persistent hashmap indicated by this
+ * `pointer`.
+ */
+uint64_t hamt_count( struct cons_pointer pointer ) {
+    return hamtp( pointer ) ? hamt_payload( pointer )->count : 0;
+}
+
+/**
+ * Find the entry for this `key`, whose hash is this `hash`, in the trie
+ * whose root is this `node`.
+ *
+ * @return a pointer to the entry, or `NULL` if the key is not there.
+ */
+static struct hamt_entry *find_entry( struct cons_pointer node,
+                                      struct cons_pointer key,
+                                      uint32_t hash ) {
+    struct hamt_entry *result = NULL;
+
+    for ( uint32_t shift = 0; !nilp( node ); shift += HAMT_BITS ) {
+        struct hamt_node_payload *payload = hamt_node( node );
+
+        if ( shift >= HAMT_HASH_BITS ) {
+            for ( uint32_t i = 0; result == NULL && i < payload->count; i++ ) {
+                if ( equal( payload->entries[i].key, key ) ) {
+                    result = &payload->entries[i];
+                }
+            }
+            break;
+        }
+
+        uint32_t bit = 1U << hamt_index( hash, shift );
+
+        if ( ( payload->bitmap & bit ) == 0 ) {
+            break;
+        }
+
+        struct hamt_entry *entry =
+            &payload->entries[__builtin_popcount( payload->bitmap &
+                                                  ( bit - 1 ) )];
+
+        if ( nilp( entry->key ) ) {
+            node = entry->value;
+        } else {
+            if ( entry->hash == hash && equal( entry->key, key ) ) {
+                result = entry;
+            }
+            break;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return an entry which is a branch to this `node`, which is given to it.
+ */
+static struct hamt_entry branch_to( struct cons_pointer node ) {
+    struct hamt_entry result = {.key = NIL,.value = node };
+
+    return result;
+}
+
+/**
+ * Make a copy of this `node`, with this `bitmap`. If `delta` is 1, a gap is
+ * left at index `at` for an entry to be added; if it is 0, the entry at
+ * `at` is not copied, and is left to be replaced; if it is -1, that entry
+ * is left out. Every other entry is copied, and its key and value are
+ * shared with the node copied.
+ */
+static struct cons_pointer copy_node( struct cons_pointer node,
+                                      uint32_t bitmap, uint32_t at,
+                                      int delta ) {
+    struct hamt_node_payload *from = hamt_node( node );
+    struct cons_pointer result =
+        make_hamt_node( bitmap, from->count + delta );
+    struct hamt_node_payload *to = hamt_node( result );
+
+    for ( uint32_t i = 0; i < from->count; i++ ) {
+        if ( delta > 0 || i != at ) {
+            uint32_t j = ( i < at ) ? i : i + delta;
+
+            to->entries[j] = from->entries[i];
+            inc_ref( to->entries[j].key );
+            inc_ref( to->entries[j].value );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Make a node at this `shift` holding these two entries, whose keys differ,
+ * and whose references are given to it, and such further nodes as are
+ * needed to tell them apart.
+ */
+static struct cons_pointer make_pair_node( struct hamt_entry a,
+                                           struct hamt_entry b,
+                                           uint32_t shift ) {
+    struct cons_pointer result = NIL;
+
+    if ( shift >= HAMT_HASH_BITS ) {
+        result = make_hamt_node( 0, 2 );
+        hamt_node( result )->entries[0] = a;
+        hamt_node( result )->entries[1] = b;
+    } else {
+        uint32_t index_a = hamt_index( a.hash, shift );
+        uint32_t index_b = hamt_index( b.hash, shift );
+
+        if ( index_a == index_b ) {
+            struct cons_pointer branch =
+                make_pair_node( a, b, shift + HAMT_BITS );
+
+            result = make_hamt_node( 1U << index_a, 1 );
+            hamt_node( result )->entries[0] = branch_to( branch );
+        } else {
+            result = make_hamt_node( ( 1U << index_a ) | ( 1U << index_b ), 2 );
+            hamt_node( result )->entries[index_a < index_b ? 0 : 1] = a;
+            hamt_node( result )->entries[index_a < index_b ? 1 : 0] = b;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a new trie like that whose root, at this `shift`, is this `node`,
+ * but with this `entry`, whose references are given to it, added; or, if
+ * its key is already there, with that key's value replaced. Set `added` to
+ * true if the key was not already there.
+ */
+static struct cons_pointer assoc_node( struct cons_pointer node,
+                                       uint32_t shift,
+                                       struct hamt_entry entry,
+                                       bool *added ) {
+    struct cons_pointer result = NIL;
+
+    if ( nilp( node ) ) {
+        result = make_hamt_node( 1U << hamt_index( entry.hash, shift ), 1 );
+        hamt_node( result )->entries[0] = entry;
+        *added = true;
+    } else if ( shift >= HAMT_HASH_BITS ) {
+        struct hamt_node_payload *from = hamt_node( node );
+        uint32_t at = 0;
+
+        while ( at < from->count && !equal( from->entries[at].key, entry.key ) ) {
+            at++;
+        }
+
+        if ( at < from->count ) {
+            /* keep the key which is there, and replace its value */
+            dec_ref( entry.key );
+            entry.key = inc_ref( from->entries[at].key );
+            result = copy_node( node, 0, at, 0 );
+        } else {
+            result = copy_node( node, 0, at, 1 );
+            *added = true;
+        }
+        hamt_node( result )->entries[at] = entry;
+    } else {
+        struct hamt_node_payload *from = hamt_node( node );
+        uint32_t bit = 1U << hamt_index( entry.hash, shift );
+        uint32_t at = __builtin_popcount( from->bitmap & ( bit - 1 ) );
+
+        if ( ( from->bitmap & bit ) == 0 ) {
+            result = copy_node( node, from->bitmap | bit, at, 1 );
+            *added = true;
+        } else {
+            struct hamt_entry old = from->entries[at];
+
+            if ( nilp( old.key ) ) {
+                entry = branch_to( assoc_node( old.value, shift + HAMT_BITS,
+                                               entry, added ) );
+            } else if ( old.hash == entry.hash && equal( old.key, entry.key ) ) {
+                dec_ref( entry.key );
+                entry.key = inc_ref( old.key );
+            } else {
+                inc_ref( old.key );
+                inc_ref( old.value );
+                entry = branch_to( make_pair_node( old, entry,
+                                                   shift + HAMT_BITS ) );
+                *added = true;
+            }
+            result = copy_node( node, from->bitmap, at, 0 );
+        }
+        hamt_node( result )->entries[at] = entry;
+    }
+
+    return result;
+}
+
+/**
+ * @return a new reference to a trie like that whose root, at this `shift`,
+ * is this `node`, but without this `key`, whose hash is this `hash`; or
+ * `NIL` if that would be empty. Set `removed` to true if the key was there;
+ * if it was not, the trie returned is the one given.
+ */
+static struct cons_pointer dissoc_node( struct cons_pointer node,
+                                        uint32_t shift,
+                                        struct cons_pointer key,
+                                        uint32_t hash, bool *removed ) {
+    struct cons_pointer result = node;
+
+    if ( !nilp( node ) ) {
+        struct hamt_node_payload *from = hamt_node( node );
+        uint32_t bit = 0;
+        uint32_t at = from->count;
+
+        if ( shift >= HAMT_HASH_BITS ) {
+            for ( at = 0; at < from->count &&
+                  !equal( from->entries[at].key, key ); at++ );
+        } else {
+            bit = 1U << hamt_index( hash, shift );
+            if ( ( from->bitmap & bit ) != 0 ) {
+                at = __builtin_popcount( from->bitmap & ( bit - 1 ) );
+            }
+        }
+
+        if ( at < from->count ) {
+            struct hamt_entry old = from->entries[at];
+
+            if ( nilp( old.key ) ) {
+                struct cons_pointer branch =
+                    dissoc_node( old.value, shift + HAMT_BITS, key, hash,
+                                 removed );
+
+                if ( !*removed ) {
+                    dec_ref( branch );
+                } else if ( nilp( branch ) ) {
+                    result = from->count == 1 ? NIL :
+                        copy_node( node, from->bitmap & ~bit, at, -1 );
+                } else {
+                    struct hamt_node_payload *below = hamt_node( branch );
+
+                    result = copy_node( node, from->bitmap, at, 0 );
+                    if ( below->count == 1 && !nilp( below->entries[0].key ) ) {
+                        /* a branch to a single key is replaced by the key */
+                        hamt_node( result )->entries[at] = below->entries[0];
+                        inc_ref( below->entries[0].key );
+                        inc_ref( below->entries[0].value );
+                        dec_ref( branch );
+                    } else {
+                        hamt_node( result )->entries[at] =
+                            branch_to( branch );
+                    }
+                }
+            } else if ( bit == 0 ||
+                        ( old.hash == hash && equal( old.key, key ) ) ) {
+                *removed = true;
+                result = from->count == 1 ? NIL :
+                    copy_node( node, from->bitmap & ~bit, at, -1 );
+            }
+        }
+    }
+
+    if ( eq( result, node ) ) {
+        inc_ref( result );
+    }
+
+    return result;
+}
+
+/**
+ * @return a new persistent hashmap with the hash function and write access
+ * control list of this `map`, and this `root`, which is given to it, which
+ * holds this `count` of keys.
+ */
+static struct cons_pointer make_hamt_with_root( struct cons_pointer map,
+                                                struct cons_pointer root,
+                                                uint64_t count ) {
+    struct hamt_payload *from = hamt_payload( map );
+    struct cons_pointer result = make_hamt( from->hash_fn, from->write_acl );
+    struct hamt_payload *to = hamt_payload( result );
+
+    to->root = root;
+    to->count = count;
+
+    return result;
+}
+
+/**
+ * Give this `root`, which holds this `count` of keys, to this `map` if
+ * `in_place` is true, dropping the root it had; else to a new map.
+ *
+ * @return the map given the root.
+ */
+static struct cons_pointer replace_root( struct cons_pointer map,
+                                         struct cons_pointer root,
+                                         uint64_t count, bool in_place ) {
+    struct cons_pointer result = map;
+
+    if ( in_place ) {
+        struct hamt_payload *payload = hamt_payload( map );
+        struct cons_pointer old = payload->root;
+
+        payload->root = root;
+        payload->count = count;
+        dec_ref( old );
+    } else {
+        result = make_hamt_with_root( map, root, count );
+    }
+
+    return result;
+}
+
+/**
+ * Get the value of this `key` in this persistent hashmap `map`; or, if
+ * `return_key` is true, the key itself, as held in the map.
+ *
+ * @return the value or key, or `NIL` if the key is not there.
+ */
+struct cons_pointer hamt_get( struct cons_pointer map,
+                              struct cons_pointer key, bool return_key ) {
+    struct cons_pointer result = NIL;
+
+    if ( hamtp( map ) && !nilp( key ) ) {
+        struct hamt_entry *entry =
+            find_entry( hamt_payload( map )->root, key, get_hash( key ) );
+
+        if ( entry != NULL ) {
+            result = return_key ? entry->key : entry->value;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Add this `key`, or replace its value if it is there, or, if `remove` is
+ * true, remove it, in this persistent hashmap `map`; changing the map if
+ * `in_place` is true, else making a new one.
+ */
+static struct cons_pointer hamt_change( struct cons_pointer map,
+                                        struct cons_pointer key,
+                                        struct cons_pointer val,
+                                        bool remove, bool in_place ) {
+    struct hamt_payload *payload = hamt_payload( map );
+    uint32_t hash = get_hash( key );
+    bool changed = false;
+    struct cons_pointer root = NIL;
+    uint64_t count = payload->count;
+
+    if ( remove ) {
+        root = dissoc_node( payload->root, 0, key, hash, &changed );
+        count -= changed ? 1 : 0;
+    } else {
+        struct hamt_entry entry = {
+            .key = inc_ref( key ),
+            .value = inc_ref( val ),
+            .hash = hash
+        };
+
+        root = assoc_node( payload->root, 0, entry, &changed );
+        count += changed ? 1 : 0;
+    }
+
+    return replace_root( map, root, count, in_place );
+}
+
+/**
+ * @return a new persistent hashmap like this `map`, but with this `val` as
+ * the value of this `key`. The map is not changed, and shares with the new
+ * map all the nodes of its trie but those on the path to the key.
+ */
+struct cons_pointer hamt_assoc( struct cons_pointer map,
+                                struct cons_pointer key,
+                                struct cons_pointer val ) {
+    return nilp( key ) ? clone_hamt( map ) :
+        hamt_change( map, key, val, false, false );
+}
+
+/**
+ * @return a new persistent hashmap like this `map`, but without this `key`.
+ * The map is not changed, and shares with the new map all the nodes of its
+ * trie but those on the path to the key.
+ */
+struct cons_pointer hamt_dissoc( struct cons_pointer map,
+                                 struct cons_pointer key ) {
+    return nilp( key ) ? clone_hamt( map ) :
+        hamt_change( map, key, NIL, true, false );
+}
+
+/**
+ * A persistent hashmap may be changed in place only if it has a write
+ * access control list and the current user is on it; a map with none, as
+ * every map read or made by `hashmap` without one has, may be written by
+ * nobody, so that every `put!` to it gives a new map.
+ *
+ * @return true if this persistent hashmap `map` may be changed in place.
+ */
+static bool hamt_writable( struct cons_pointer map ) {
+    struct cons_pointer acl = hamt_payload( map )->write_acl;
+
+    return !nilp( acl ) && !nilp( authorised( map, acl ) );
+}
+
+/**
+ * Store this `val` as the value of this `key` in this persistent hashmap
+ * `map`. If the map may be written, q.v. `hamt_writable`, modifies the map
+ * and returns it; if not, returns a new map, which shares all but the path
+ * to the key with the old one.
+ */
+struct cons_pointer hamt_put( struct cons_pointer map,
+                              struct cons_pointer key,
+                              struct cons_pointer val ) {
+    struct cons_pointer result = map;
+
+    if ( hamtp( map ) && !nilp( key ) ) {
+        result = hamt_change( map, key, val, false, hamt_writable( map ) );
+    }
+
+    return result;
+}
+
+/**
+ * Store this `val` as the value of this `key` in this persistent hashmap
+ * `map`, modifying the map whether or not it may be written. Only for
+ * filling a new map which nothing else yet holds, as `read_map` does.
+ *
+ * @return the map.
+ */
+struct cons_pointer hamt_fill( struct cons_pointer map,
+                               struct cons_pointer key,
+                               struct cons_pointer val ) {
+    if ( hamtp( map ) && !nilp( key ) ) {
+        hamt_change( map, key, val, false, true );
+    }
+
+    return map;
+}
+
+/**
+ * Remove this `key` from this persistent hashmap `map`. If the map may be
+ * written, q.v. `hamt_writable`, modifies the map and returns it; if not,
+ * returns a new map, which shares all but the path to the key with the
+ * old one.
+ */
+struct cons_pointer hamt_remove( struct cons_pointer map,
+                                 struct cons_pointer key ) {
+    struct cons_pointer result = map;
+
+    if ( hamtp( map ) && !nilp( key ) ) {
+        result = hamt_change( map, key, NIL, true, hamt_writable( map ) );
+    }
+
+    return result;
+}
+
+/**
+ * @return a new persistent hashmap with the same keys and values as this
+ * `map`, sharing its trie.
+ */
+struct cons_pointer clone_hamt( struct cons_pointer map ) {
+    struct hamt_payload *payload = hamt_payload( map );
+
+    return make_hamt_with_root( map, inc_ref( payload->root ),
+                                payload->count );
+}
+
+/**
+ * Apply this function `fn`, with this `data`, to each key and value entry
+ * in the trie whose root is this `node`, in order.
+ */
+static void for_each_entry( struct cons_pointer node,
+                            void ( *fn )( struct hamt_entry *, void * ),
+                            void *data ) {
+    if ( !nilp( node ) ) {
+        struct hamt_node_payload *payload = hamt_node( node );
+
+        for ( uint32_t i = 0; i < payload->count; i++ ) {
+            if ( nilp( payload->entries[i].key ) ) {
+                for_each_entry( payload->entries[i].value, fn, data );
+            } else {
+                fn( &payload->entries[i], data );
+            }
+        }
+    }
+}
+
+/**
+ * @return the keys in the trie whose root is this `node`, in order, consed
+ * onto the front of this list of `keys`, which is given to it.
+ */
+static struct cons_pointer cons_keys( struct cons_pointer node,
+                                      struct cons_pointer keys ) {
+    if ( !nilp( node ) ) {
+        struct hamt_node_payload *payload = hamt_node( node );
+
+        for ( uint32_t i = payload->count; i > 0; i-- ) {
+            struct hamt_entry *entry = &payload->entries[i - 1];
+
+            if ( nilp( entry->key ) ) {
+                keys = cons_keys( entry->value, keys );
+            } else {
+                struct cons_pointer old = keys;
+
+                keys = make_cons( entry->key, old );
+                dec_ref( old );
+            }
+        }
+    }
+
+    return keys;
+}
+
+/**
+ * return a flat list of all the keys in this persistent hashmap `map`, in
+ * the order in which they are printed.
+ */
+struct cons_pointer hamt_keys( struct cons_pointer map ) {
+    return hamtp( map ) ? cons_keys( hamt_payload( map )->root, NIL ) : NIL;
+}
+
+/**
+ * The state shared by the entry visitor for `equal_hamts`.
+ */
+struct equal_hamts_state {
+    struct cons_pointer other;
+    bool result;
+};
+
+/**
+ * Entry visitor for `equal_hamts`: note in `data` if the key of this
+ * `entry` has not the same value in the other map, which is searched by
+ * the hash cached in the entry.
+ */
+static void check_entry( struct hamt_entry *entry, void *data ) {
+    struct equal_hamts_state *state = ( struct equal_hamts_state * ) data;
+
+    if ( state->result ) {
+        struct hamt_entry *other =
+            find_entry( hamt_payload( state->other )->root, entry->key,
+                        entry->hash );
+
+        state->result = other != NULL && equal( entry->value, other->value );
+    }
+}
+
+/**
+ * @return true if these two persistent hashmaps `a` and `b` have the same
+ * keys, with equal values, else false.
+ */
+bool equal_hamts( struct cons_pointer a, struct cons_pointer b ) {
+    struct equal_hamts_state state = { b, false };
+
+    if ( hamtp( a ) && hamtp( b ) && hamt_count( a ) == hamt_count( b ) &&
+         truep( authorised( a, NIL ) ) && truep( authorised( b, NIL ) ) ) {
+        state.result = true;
+        if ( !eq( hamt_payload( a )->root, hamt_payload( b )->root ) ) {
+            for_each_entry( hamt_payload( a )->root, &check_entry, &state );
+        }
+    }
+
+    return state.result;
+}
+
+/**
+ * The state shared by the entry visitor for `print_hamt`.
+ */
+struct print_hamt_state {
+    URL_FILE *output;
+    bool first;
+};
+
+/**
+ * Entry visitor for `print_hamt`: print this `entry` to the stream in
+ * `data`.
+ */
+static void print_entry( struct hamt_entry *entry, void *data ) {
+    struct print_hamt_state *state = ( struct print_hamt_state * ) data;
+
+    if ( !state->first ) {
+        url_fputws( L", ", state->output );
+    }
+    state->first = false;
+
+    print( state->output, entry->key );
+    url_fputwc( L' ', state->output );
+    print( state->output, entry->value );
+}
+
+/**
+ * Print the persistent hashmap indicated by this `pointer` to this
+ * `output` stream, as a hashmap is printed.
+ */
+void print_hamt( URL_FILE *output, struct cons_pointer pointer ) {
+    struct print_hamt_state state = { output, true };
+
+    url_fputwc( L'{', output );
+    if ( truep( authorised( pointer, NIL ) ) ) {
+        for_each_entry( hamt_payload( pointer )->root, &print_entry, &state );
+    }
+    url_fputwc( L'}', output );
+}
+
+/**
+ * Dump the persistent hashmap indicated by this `pointer` to this `output`
+ * stream.
+ */
+void dump_hamt( URL_FILE *output, struct cons_pointer pointer ) {
+    struct hamt_payload *payload = hamt_payload( pointer );
+
+    url_fwprintf( output, L"\t\tPersistent hashmap with %lu pairs:\n",
+                  payload->count );
+    url_fwprintf( output, L"\t\tHash function: " );
+    print( output, payload->hash_fn );
+    url_fwprintf( output, L"\n\t\tWrite ACL: " );
+    print( output, payload->write_acl );
+    url_fwprintf( output, L"\n\t\t" );
+    print_hamt( output, pointer );
+    url_fputws( L"\n", output );
+}
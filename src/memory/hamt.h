@@ -0,0 +1,80 @@
+/*
+ * hamt.h
+ *
+ * Persistent hashmaps: hashmaps held as hash array mapped tries, whose
+ * nodes are shared between a map and the maps made from it by adding or
+ * removing keys.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_hamt_h
+#define __psse_hamt_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "io/fopen.h"
+#include "memory/consspaceobject.h"
+#include "memory/vectorspace.h"
+
+/**
+ * The number of bits of a hash used at each level of the trie, and so the
+ * log to base two of the number of entries a node may have.
+ */
+#define HAMT_BITS 5
+
+/**
+ * The number of bits in a hash. Nodes at or below the depth at which all
+ * of them have been used hold keys whose hashes collide.
+ */
+#define HAMT_HASH_BITS 32
+
+/**
+ * @return the payload of the persistent hashmap indicated by this
+ * `pointer`, which must be a persistent hashmap.
+ */
+#define hamt_payload(pointer)(&(pointer_to_vso(pointer)->payload.hamt))
+
+struct cons_pointer make_hamt( struct cons_pointer hash_fn,
+                               struct cons_pointer write_acl );
+
+void free_hamt( struct cons_pointer pointer );
+
+void free_hamt_node( struct cons_pointer pointer );
+
+uint64_t hamt_count( struct cons_pointer pointer );
+
+struct cons_pointer hamt_get( struct cons_pointer map,
+                              struct cons_pointer key, bool return_key );
+
+struct cons_pointer hamt_assoc( struct cons_pointer map,
+                                struct cons_pointer key,
+                                struct cons_pointer val );
+
+struct cons_pointer hamt_dissoc( struct cons_pointer map,
+                                 struct cons_pointer key );
+
+struct cons_pointer hamt_put( struct cons_pointer map,
+                              struct cons_pointer key,
+                              struct cons_pointer val );
+
+struct cons_pointer hamt_fill( struct cons_pointer map,
+                               struct cons_pointer key,
+                               struct cons_pointer val );
+
+struct cons_pointer hamt_remove( struct cons_pointer map,
+                                 struct cons_pointer key );
+
+struct cons_pointer hamt_keys( struct cons_pointer map );
+
+struct cons_pointer clone_hamt( struct cons_pointer map );
+
+bool equal_hamts( struct cons_pointer a, struct cons_pointer b );
+
+void print_hamt( URL_FILE * output, struct cons_pointer pointer );
+
+void dump_hamt( URL_FILE * output, struct cons_pointer pointer );
+
+#endif
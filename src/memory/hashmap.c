@@ -15,8 +15,10 @@
 #include "io/print.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
+#include "memory/hamt.h"
 #include "memory/hashmap.h"
 #include "memory/vectorspace.h"
+#include "ops/equal.h"
 
 
 /**
@@ -31,21 +33,28 @@ struct cons_pointer lisp_get_hash( struct stack_frame *frame,
 /**
  * Lisp funtion of up to four args (all optional), where
  * 
- * first is expected to be an integer, the number of buckets, or nil;
+ * first is expected to be an integer, the number of slots, or nil;
  * second is expected to be a hashing function, or nil;
  * third is expected to be an assocable, or nil;
  * fourth is a list of user tokens, to be used as a write ACL, or nil.
+ *
+ * A hashmap with no write ACL is made persistent, q.v. hamt.c, and has no
+ * fixed number of slots, so that the first arg is ignored. It may be
+ * written by nobody, so that every `put!` to it gives a new map, which
+ * shares all but the path to the key put with the old.
  */
 struct cons_pointer lisp_make_hashmap( struct stack_frame *frame,
                                        struct cons_pointer frame_pointer,
                                        struct cons_pointer env ) {
-    uint32_t n = DFLT_HASHMAP_BUCKETS;
+    uint32_t n = DFLT_HASHMAP_SLOTS;
     struct cons_pointer hash_fn = NIL;
     struct cons_pointer result = NIL;
 
     if ( frame->args > 0 ) {
         if ( integerp( frame->arg[0] ) ) {
             n = to_long_int( frame->arg[0] ) % UINT32_MAX;
+            /* there must be at least one slot to hash into */
+            n = n > 0 ? n : 1;
         } else if ( !nilp( frame->arg[0] ) ) {
             result =
                 make_exception( c_string_to_lisp_string
@@ -69,26 +78,23 @@ struct cons_pointer lisp_make_hashmap( struct stack_frame *frame,
     if ( nilp( result ) ) {
         /* if there are fewer than 4 args, then arg[3] ought to be nil anyway, which
          * is fine */
-        result = make_hashmap( n, hash_fn, frame->arg[3] );
-        struct vector_space_object *map = pointer_to_vso( result );
+        bool persistent = nilp( frame->arg[3] );
+
+        result = persistent ? make_hamt( hash_fn, NIL ) :
+            make_hashmap( n, hash_fn, frame->arg[3] );
 
-        if ( frame->args > 2 &&
-             truep( authorised( result, map->payload.hashmap.write_acl ) ) ) {
+        if ( frame->args > 2 ) {
             // then arg[2] ought to be an assoc list which we should iterate down
             // populating the hashmap.
+            // through `hashmap_put`, so that the map is rehashed as it grows;
+            // or, if persistent, in place, as `read_map` fills a map read.
             for ( struct cons_pointer cursor = frame->arg[2]; !nilp( cursor );
                   cursor = c_cdr( cursor ) ) {
                 struct cons_pointer pair = c_car( cursor );
-                struct cons_pointer key = c_car( pair );
-                struct cons_pointer val = c_cdr( pair );
 
-                uint32_t bucket_no =
-                    get_hash( key ) % ( ( struct hashmap_payload * )
-                                        &( map->payload ) )->n_buckets;
-
-                map->payload.hashmap.buckets[bucket_no] =
-                    make_cons( make_cons( key, val ),
-                               map->payload.hashmap.buckets[bucket_no] );
+                result = persistent ?
+                    hamt_fill( result, c_car( pair ), c_cdr( pair ) ) :
+                    hashmap_put( result, c_car( pair ), c_cdr( pair ) );
             }
         }
     }
@@ -113,8 +119,9 @@ struct cons_pointer lisp_hashmap_put( struct stack_frame *frame,
     struct cons_pointer val = frame->arg[2];
 
     struct cons_pointer result = hashmap_put( mapp, key, val );
-    struct cons_space_object *cell = &pointer2cell( result );
-    return result;
+
+    /* a map changed in place is the caller's argument, not a new map */
+    return eq( result, mapp ) ? inc_ref( result ) : result;
 
     // TODO: else clone and return clone.
 }
@@ -126,7 +133,10 @@ struct cons_pointer lisp_hashmap_put( struct stack_frame *frame,
 struct cons_pointer lisp_hashmap_put_all( struct stack_frame *frame,
                                           struct cons_pointer frame_pointer,
                                           struct cons_pointer env ) {
-    return hashmap_put_all( frame->arg[0], frame->arg[1] );
+    struct cons_pointer result = hashmap_put_all( frame->arg[0],
+                                                  frame->arg[1] );
+
+    return eq( result, frame->arg[0] ) ? inc_ref( result ) : result;
 }
 
 struct cons_pointer lisp_hashmap_keys( struct stack_frame *frame,
@@ -138,15 +148,23 @@ struct cons_pointer lisp_hashmap_keys( struct stack_frame *frame,
 void dump_map( URL_FILE *output, struct cons_pointer pointer ) {
     struct hashmap_payload *payload =
         &pointer_to_vso( pointer )->payload.hashmap;
-    url_fwprintf( output, L"Hashmap with %d buckets:\n", payload->n_buckets );
+    url_fwprintf( output, L"Hashmap with %d slots and %d pairs:\n",
+                  payload->n_slots, payload->count );
     url_fwprintf( output, L"\tHash function: " );
     print( output, payload->hash_fn );
     url_fwprintf( output, L"\n\tWrite ACL: " );
     print( output, payload->write_acl );
-    url_fwprintf( output, L"\n\tBuckets:" );
-    for ( int i = 0; i < payload->n_buckets; i++ ) {
-        url_fwprintf( output, L"\n\t\t[%d]: ", i );
-        print( output, payload->buckets[i] );
+    url_fwprintf( output, L"\n\tSlots:" );
+    for ( uint32_t i = 0; i < payload->n_slots; i++ ) {
+        struct hashmap_slot *slot = &payload->slots[i];
+
+        if ( !nilp( slot->key ) ) {
+            url_fwprintf( output, L"\n\t\t[%d] (hash %u, distance %u): ", i,
+                          slot->hash, slot->distance );
+            print( output, slot->key );
+            url_fwprintf( output, L" " );
+            print( output, slot->value );
+        }
     }
     url_fwprintf( output, L"\n" );
 }
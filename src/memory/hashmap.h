@@ -15,7 +15,13 @@
 #include "memory/consspaceobject.h"
 #include "memory/vectorspace.h"
 
-#define DFLT_HASHMAP_BUCKETS 32
+#define DFLT_HASHMAP_SLOTS 32
+
+/**
+ * When a key/value pair put into a hashmap would fill more than this
+ * percentage of its slots, it is first rehashed to twice as many slots.
+ */
+#define HASHMAP_MAX_LOAD_PERCENT 80
 
 
 struct cons_pointer lisp_get_hash( struct stack_frame *frame,
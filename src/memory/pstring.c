@@ -0,0 +1,289 @@
+/*
+ * pstring.c
+ *
+ * Packed strings: strings whose characters are held contiguously in vector
+ * space, UTF-32, with their length and hash computed once when they are
+ * made, rather than one character to a cell, at the cost of a whole cell
+ * each. A packed string is not changed once made.
+ *
+ * Strings read by the reader, and by `slurp`, are packed; those made by C
+ * code from C strings, and symbols and keywords, are still made of cells.
+ * Anything which works on strings should therefore accept either, and
+ * `any_stringp` is true of both. Where a packed string must be walked a
+ * cell at a time, as by `cdr`, a cell string of the same characters is made
+ * when first needed, and kept.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+
+#include "debug.h"
+#include "io/print.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/pstring.h"
+#include "memory/vectorspace.h"
+
+/**
+ * Make a packed string with room for this `length` of characters, all of
+ * which are the null character, and whose hash is not yet computed.
+ *
+ * @return the packed string, or an exception if memory is exhausted.
+ */
+static struct cons_pointer allocate_pstring( uint64_t length ) {
+    struct cons_pointer result = make_vso( PSTRINGTV,
+                                           sizeof( struct pstring_payload ) +
+                                           length * sizeof( wchar_t ) );
+
+    if ( nilp( result ) ) {
+        result = make_exception( privileged_string_memory_exhausted, NIL );
+    } else {
+        /* make_vso has zeroed the characters, and `cells` is NIL */
+        pstring_payload( result )->length = length;
+    }
+
+    return result;
+}
+
+/**
+ * Compute the hash of the packed string indicated by this `pointer`, once
+ * its characters are in place. The hash is that which `calculate_hash`
+ * gives for a cell string of the same characters, so that the two are
+ * interchangeable as keys in maps; so it, too, is taken from the end.
+ *
+ * @return `pointer`.
+ */
+static struct cons_pointer seal_pstring( struct cons_pointer pointer ) {
+    if ( pstringp( pointer ) ) {
+        struct pstring_payload *payload = pstring_payload( pointer );
+        uint32_t hash = STRING_HASH_BASIS;
+
+        for ( uint64_t i = payload->length; i > 0; i-- ) {
+            hash = string_hash_step( hash, payload->characters[i - 1] );
+        }
+
+        payload->hash = hash;
+    }
+
+    return pointer;
+}
+
+/**
+ * Make a packed string of the first `length` of these `characters`.
+ *
+ * @return the packed string, or an exception if memory is exhausted.
+ */
+struct cons_pointer make_pstring( const wchar_t *characters,
+                                  uint64_t length ) {
+    struct cons_pointer result = allocate_pstring( length );
+
+    if ( pstringp( result ) && length > 0 ) {
+        wmemcpy( pstring_payload( result )->characters, characters, length );
+    }
+
+    return seal_pstring( result );
+}
+
+/**
+ * Give up the reference which the packed string indicated by this
+ * `pointer` holds to its cell string, if one has been made.
+ */
+void free_pstring( struct cons_pointer pointer ) {
+    if ( pstringp( pointer ) ) {
+        dec_ref( pstring_payload( pointer )->cells );
+    } else {
+        debug_printf( DEBUG_ALLOC,
+                      L"Non-packed-string passed to `free_pstring`\n" );
+    }
+}
+
+/**
+ * @return the number of characters in the packed string indicated by this
+ * `pointer`, or zero if it is not a packed string.
+ */
+uint64_t pstring_length( struct cons_pointer pointer ) {
+    return pstringp( pointer ) ? pstring_payload( pointer )->length : 0;
+}
+
+/**
+ * @return the number of characters in the string indicated by this
+ * `pointer`, whether packed or made of cells, not counting the null
+ * character which ends a cell string read by the reader; or zero if it is
+ * not a string.
+ */
+uint64_t string_length( struct cons_pointer pointer ) {
+    uint64_t result = pstring_length( pointer );
+
+    for ( struct cons_pointer c = pointer; stringp( c );
+          c = pointer2cell( c ).payload.string.cdr ) {
+        if ( pointer2cell( c ).payload.string.character != L'\0' ) {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a string of the one character at this zero-based `index` of the
+ * packed string indicated by this `pointer`, or `NIL` if it is not a packed
+ * string or has no such character.
+ */
+struct cons_pointer pstring_get( struct cons_pointer pointer,
+                                 uint64_t index ) {
+    struct cons_pointer result = NIL;
+
+    if ( index < pstring_length( pointer ) ) {
+        result =
+            make_string( pstring_payload( pointer )->characters[index], NIL );
+    }
+
+    return result;
+}
+
+/**
+ * @return a cell string of the same characters as the packed string
+ * indicated by this `pointer`, ending, like those read by the reader used
+ * to, with a null character; made when first asked for, and kept. Or `NIL`
+ * if it is not a packed string.
+ */
+struct cons_pointer pstring_cells( struct cons_pointer pointer ) {
+    struct cons_pointer result = NIL;
+
+    if ( pstringp( pointer ) ) {
+        struct pstring_payload *payload = pstring_payload( pointer );
+
+        if ( nilp( payload->cells ) ) {
+            struct cons_pointer cells = make_string( L'\0', NIL );
+
+            for ( uint64_t i = payload->length; i > 0; i-- ) {
+                cells = make_string( payload->characters[i - 1], cells );
+            }
+
+            payload->cells = cells;
+        }
+
+        result = payload->cells;
+    }
+
+    return result;
+}
+
+/**
+ * Copy the characters of this `string`, whether packed or made of cells,
+ * but not the null character which ends a cell string read by the reader,
+ * into this `buffer`, which has room for them.
+ *
+ * @return the number of characters copied.
+ */
+static uint64_t copy_characters( struct cons_pointer string,
+                                 wchar_t *buffer ) {
+    uint64_t result = pstring_length( string );
+
+    if ( result > 0 ) {
+        wmemcpy( buffer, pstring_payload( string )->characters, result );
+    }
+
+    for ( struct cons_pointer c = string; stringp( c );
+          c = pointer2cell( c ).payload.string.cdr ) {
+        wchar_t character = pointer2cell( c ).payload.string.character;
+
+        if ( character != L'\0' ) {
+            buffer[result++] = character;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a new packed string of the characters of string `a` followed by
+ * those of string `b`, either of which may be packed or made of cells; or
+ * an exception if memory is exhausted.
+ */
+struct cons_pointer string_append( struct cons_pointer a,
+                                   struct cons_pointer b ) {
+    uint64_t length_a = string_length( a );
+    struct cons_pointer result =
+        allocate_pstring( length_a + string_length( b ) );
+
+    if ( pstringp( result ) ) {
+        wchar_t *characters = pstring_payload( result )->characters;
+
+        copy_characters( a, characters );
+        copy_characters( b, characters + length_a );
+    }
+
+    return seal_pstring( result );
+}
+
+/**
+ * @return a new packed string of the characters of the packed string
+ * indicated by this `pointer`, in the reverse order; or an exception if
+ * memory is exhausted.
+ */
+struct cons_pointer pstring_reverse( struct cons_pointer pointer ) {
+    uint64_t length = pstring_length( pointer );
+    struct cons_pointer result = allocate_pstring( length );
+
+    if ( pstringp( result ) ) {
+        wchar_t *from = pstring_payload( pointer )->characters;
+        wchar_t *to = pstring_payload( result )->characters;
+
+        for ( uint64_t i = 0; i < length; i++ ) {
+            to[i] = from[length - 1 - i];
+        }
+    }
+
+    return seal_pstring( result );
+}
+
+/**
+ * @return true if strings `a` and `b`, at least one of which is packed and
+ * the other of which may be packed or made of cells, have the same
+ * characters in the same order, else false.
+ */
+bool equal_strings( struct cons_pointer a, struct cons_pointer b ) {
+    bool result = false;
+
+    if ( pstringp( a ) && pstringp( b ) ) {
+        struct pstring_payload *pa = pstring_payload( a );
+        struct pstring_payload *pb = pstring_payload( b );
+
+        result = pa->length == pb->length && pa->hash == pb->hash &&
+            wmemcmp( pa->characters, pb->characters, pa->length ) == 0;
+    } else if ( pstringp( b ) ) {
+        result = equal_strings( b, a );
+    } else if ( pstringp( a ) && stringp( b ) ) {
+        struct pstring_payload *pa = pstring_payload( a );
+        uint64_t i = 0;
+
+        result = true;
+        for ( struct cons_pointer c = b; result && stringp( c );
+              c = pointer2cell( c ).payload.string.cdr ) {
+            wchar_t character = pointer2cell( c ).payload.string.character;
+
+            if ( character != L'\0' ) {
+                result = i < pa->length && pa->characters[i++] == character;
+            }
+        }
+        result = result && i == pa->length;
+    }
+
+    return result;
+}
+
+void dump_pstring( URL_FILE *output, struct cons_pointer pointer ) {
+    struct pstring_payload *payload = pstring_payload( pointer );
+
+    url_fwprintf( output,
+                  L"\t\tPacked string of %lu characters, hash %u, %s: ",
+                  payload->length, payload->hash,
+                  nilp( payload->cells ) ? "no cells" : "with cells" );
+    print( output, pointer );
+    url_fwprintf( output, L"\n" );
+}
@@ -0,0 +1,57 @@
+/*
+ * pstring.h
+ *
+ * Packed strings: strings whose characters are held contiguously in vector
+ * space, rather than one to a cell.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_pstring_h
+#define __psse_pstring_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <wchar.h>
+
+#include "io/fopen.h"
+#include "memory/consspaceobject.h"
+#include "memory/vectorspace.h"
+
+/**
+ * @return the payload of the packed string indicated by this `pointer`,
+ * which must be a packed string.
+ */
+#define pstring_payload(pointer)(&(pointer_to_vso(pointer)->payload.pstring))
+
+/**
+ * true if `conspoint` points to a string, whether packed or made of cells,
+ * else false.
+ */
+#define any_stringp(conspoint)(stringp(conspoint)||pstringp(conspoint))
+
+struct cons_pointer make_pstring( const wchar_t *characters,
+                                  uint64_t length );
+
+void free_pstring( struct cons_pointer pointer );
+
+uint64_t pstring_length( struct cons_pointer pointer );
+
+uint64_t string_length( struct cons_pointer pointer );
+
+struct cons_pointer pstring_get( struct cons_pointer pointer,
+                                 uint64_t index );
+
+struct cons_pointer pstring_cells( struct cons_pointer pointer );
+
+struct cons_pointer string_append( struct cons_pointer a,
+                                   struct cons_pointer b );
+
+struct cons_pointer pstring_reverse( struct cons_pointer pointer );
+
+bool equal_strings( struct cons_pointer a, struct cons_pointer b );
+
+void dump_pstring( URL_FILE * output, struct cons_pointer pointer );
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * room.c
+ *
+ * Live statistics on allocation, by type, and the `(room)` function which
+ * reports them. Each thread counts the objects it allocates and frees in
+ * tables of its own, so that counting costs no more than an increment;
+ * the tables are added into the shared totals whenever the thread takes
+ * a new cons page, and when the totals are asked for. High water marks
+ * are therefore sampled at those points, and may a little understate the
+ * true peaks.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <wctype.h>
+
+#include "arith/integer.h"
+#include "arith/real.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/hashmap.h"
+#include "memory/room.h"
+#include "memory/vectorspace.h"
+#include "ops/intern.h"
+
+/**
+ * This thread's counts of cons space objects, by tag, since they were last
+ * added into the totals.
+ */
+_Thread_local struct tag_counter thread_cell_counters[NTAGCOUNTERS];
+
+/**
+ * This thread's counts of vector space objects, by tag, likewise.
+ */
+_Thread_local struct tag_counter thread_vso_counters[NTAGCOUNTERS];
+
+/**
+ * The totals, guarded by `room_lock`.
+ */
+static struct tag_counter cell_counters[NTAGCOUNTERS];
+
+static struct tag_counter vso_counters[NTAGCOUNTERS];
+
+/**
+ * The greatest number of cons space objects seen live at once.
+ */
+static uint64_t cells_high_water = 0;
+
+/**
+ * When the totals were first added to, and when and at what count of cells
+ * allocated `(room)` was last called, from which to work out the rate of
+ * allocation.
+ */
+static uint64_t room_epoch_ns = 0;
+
+static uint64_t room_last_ns = 0;
+
+static uint64_t room_last_allocated = 0;
+
+static pthread_mutex_t room_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @return the current value of the monotonic clock, in nanoseconds.
+ */
+static uint64_t room_now(  ) {
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Count the allocation of this vector space object `vso`, of this many
+ * `bytes` in all.
+ */
+void note_vso_allocated( struct vector_space_object *vso, uint64_t bytes ) {
+    struct tag_counter *counter =
+        tag_counter( thread_vso_counters, vso->header.tag.value );
+
+    counter->allocated++;
+    counter->bytes_allocated += bytes;
+}
+
+/**
+ * Count the freeing of this vector space object `vso`.
+ */
+void note_vso_freed( struct vector_space_object *vso ) {
+    struct tag_counter *counter =
+        tag_counter( thread_vso_counters, vso->header.tag.value );
+
+    counter->freed++;
+    counter->bytes_freed +=
+        sizeof( struct vector_space_header ) + vso->header.size;
+}
+
+/**
+ * Add the counts in this thread's table `from` into the totals `to`, and
+ * clear them. The caller must hold `room_lock`.
+ *
+ * @return the number of objects live, according to the totals.
+ */
+static uint64_t add_tag_counters( struct tag_counter *to,
+                                  struct tag_counter *from ) {
+    int64_t live = 0;
+
+    for ( int i = 0; i < NTAGCOUNTERS; i++ ) {
+        if ( from[i].tag != 0 ) {
+            struct tag_counter *total = tag_counter( to, from[i].tag );
+
+            total->allocated += from[i].allocated;
+            total->freed += from[i].freed;
+            total->bytes_allocated += from[i].bytes_allocated;
+            total->bytes_freed += from[i].bytes_freed;
+
+            from[i].allocated = 0;
+            from[i].freed = 0;
+            from[i].bytes_allocated = 0;
+            from[i].bytes_freed = 0;
+        }
+    }
+
+    for ( int i = 0; i < NTAGCOUNTERS; i++ ) {
+        /* objects may be freed by a thread other than the one which
+         * allocated them, so a type may briefly seem to have fewer than
+         * none live */
+        int64_t n = ( int64_t ) ( to[i].allocated - to[i].freed );
+
+        if ( n > 0 && ( uint64_t ) n > to[i].high_water ) {
+            to[i].high_water = n;
+        }
+        live += n;
+    }
+
+    return live > 0 ? ( uint64_t ) live : 0;
+}
+
+/**
+ * Add this thread's counts into the totals.
+ */
+void flush_tag_counters(  ) {
+    pthread_mutex_lock( &room_lock );
+
+    if ( room_epoch_ns == 0 ) {
+        room_epoch_ns = room_now(  );
+        room_last_ns = room_epoch_ns;
+    }
+
+    uint64_t live = add_tag_counters( cell_counters, thread_cell_counters );
+    add_tag_counters( vso_counters, thread_vso_counters );
+
+    if ( live > cells_high_water ) {
+        cells_high_water = live;
+    }
+
+    pthread_mutex_unlock( &room_lock );
+}
+
+/**
+ * Store this integer `value` under the keyword named `name` in the hashmap
+ * `map`.
+ */
+static void room_put( struct cons_pointer map, wchar_t *name,
+                      struct cons_pointer value ) {
+    struct cons_pointer key = c_string_to_lisp_keyword( name );
+
+    hashmap_put( map, key, value );
+    dec_ref( key );
+    dec_ref( value );
+}
+
+/**
+ * @return a hashmap describing the objects counted by this `counter`; if
+ * `cell_bytes` is not zero, the objects are cons space objects of that
+ * size, else vector space objects which have counted their own bytes.
+ */
+static struct cons_pointer room_for_tag( struct tag_counter *counter,
+                                         uint64_t cell_bytes ) {
+    struct cons_pointer result = make_hashmap( 8, NIL, TRUE );
+    uint64_t live = counter->allocated - counter->freed;
+    uint64_t bytes = cell_bytes != 0 ? live * cell_bytes :
+        counter->bytes_allocated - counter->bytes_freed;
+
+    room_put( result, L"allocated",
+              acquire_integer( ( int64_t ) counter->allocated, NIL ) );
+    room_put( result, L"freed",
+              acquire_integer( ( int64_t ) counter->freed, NIL ) );
+    room_put( result, L"live", acquire_integer( ( int64_t ) live, NIL ) );
+    room_put( result, L"high-water",
+              acquire_integer( ( int64_t ) counter->high_water, NIL ) );
+    room_put( result, L"bytes", acquire_integer( ( int64_t ) bytes, NIL ) );
+
+    return result;
+}
+
+/**
+ * @return a hashmap of hashmaps, one for each tag in these `counters`,
+ * keyed by the tag as a keyword.
+ */
+static struct cons_pointer room_by_tag( struct tag_counter *counters,
+                                        uint64_t cell_bytes ) {
+    struct cons_pointer result = make_hashmap( DFLT_HASHMAP_SLOTS, NIL,
+                                               TRUE );
+
+    for ( int i = 0; i < NTAGCOUNTERS; i++ ) {
+        if ( counters[i].tag != 0 ) {
+            union {
+                uint32_t value;
+                char bytes[TAGLENGTH];
+            } tag = { counters[i].tag };
+            wchar_t name[TAGLENGTH + 1];
+
+            for ( int j = 0; j < TAGLENGTH; j++ ) {
+                name[j] = ( wchar_t ) tag.bytes[j];
+            }
+            name[TAGLENGTH] = L'\0';
+
+            room_put( result, name,
+                      room_for_tag( &counters[i], cell_bytes ) );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Function: return a hashmap describing the use of memory: the number of
+ * cons space objects allocated, freed and live, the high water mark of
+ * live objects, the bytes they occupy, the rate at which cells have been
+ * allocated since `(room)` was last called, and the same figures broken
+ * down by the type of object in cons space and in vector space.
+ *
+ * * (room)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return a hashmap.
+ */
+struct cons_pointer lisp_room( struct stack_frame *frame,
+                               struct cons_pointer frame_pointer,
+                               struct cons_pointer env ) {
+    struct tag_counter cells[NTAGCOUNTERS];
+    struct tag_counter vsos[NTAGCOUNTERS];
+    uint64_t cell_bytes = sizeof( struct cons_space_object ) +
+        sizeof( union cell_tag ) + sizeof( uint32_t );
+    uint64_t allocated = 0;
+    uint64_t freed = 0;
+    uint64_t vso_bytes = 0;
+
+    flush_tag_counters(  );
+
+    pthread_mutex_lock( &room_lock );
+
+    memcpy( cells, cell_counters, sizeof( cells ) );
+    memcpy( vsos, vso_counters, sizeof( vsos ) );
+    uint64_t high_water = cells_high_water;
+    uint64_t now = room_now(  );
+    uint64_t since = room_last_ns;
+    uint64_t allocated_before = room_last_allocated;
+
+    for ( int i = 0; i < NTAGCOUNTERS; i++ ) {
+        allocated += cells[i].allocated;
+        freed += cells[i].freed;
+        vso_bytes += vsos[i].bytes_allocated - vsos[i].bytes_freed;
+    }
+    room_last_ns = now;
+    room_last_allocated = allocated;
+
+    pthread_mutex_unlock( &room_lock );
+
+    struct cons_pointer result = make_hashmap( DFLT_HASHMAP_SLOTS, NIL,
+                                               TRUE );
+    double seconds = ( now - since ) / 1e9;
+
+    room_put( result, L"allocated",
+              acquire_integer( ( int64_t ) allocated, NIL ) );
+    room_put( result, L"freed", acquire_integer( ( int64_t ) freed, NIL ) );
+    room_put( result, L"live",
+              acquire_integer( ( int64_t ) ( allocated - freed ), NIL ) );
+    room_put( result, L"high-water",
+              acquire_integer( ( int64_t ) high_water, NIL ) );
+    room_put( result, L"bytes",
+              acquire_integer( ( int64_t )
+                               ( ( allocated - freed ) * cell_bytes +
+                                 vso_bytes ), NIL ) );
+    room_put( result, L"pages",
+              acquire_integer( ( int64_t ) initialised_cons_pages, NIL ) );
+    room_put( result, L"resident-pages",
+              acquire_integer( ( int64_t ) resident_cons_pages, NIL ) );
+    room_put( result, L"allocation-rate",
+              make_real( seconds > 0 ?
+                         ( allocated - allocated_before ) / seconds : 0 ) );
+    room_put( result, L"by-type", room_by_tag( cells, cell_bytes ) );
+    room_put( result, L"by-vector-type", room_by_tag( vsos, 0 ) );
+
+    return result;
+}
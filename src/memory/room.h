@@ -0,0 +1,78 @@
+/*
+ * room.h
+ *
+ * Live statistics on allocation, by type, cheap enough to be kept all the
+ * time, and the `(room)` function which reports them.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_room_h
+#define __psse_room_h
+
+#include <stdint.h>
+
+#include "memory/consspaceobject.h"
+#include "memory/vectorspace.h"
+
+/**
+ * The number of bits in the index of a table of tag counters; the tables
+ * have room for many more tags than there are.
+ */
+#define TAGCOUNTERBITS 6
+
+#define NTAGCOUNTERS (1 << TAGCOUNTERBITS)
+
+/**
+ * Counts of the objects of one type (tag) allocated and freed, and the
+ * bytes they occupied. For cons space objects, the bytes are not counted,
+ * as every cell is the same size.
+ */
+struct tag_counter {
+    /** the tag, or 0 if this counter is unused. */
+    uint32_t tag;
+    /** the number of objects allocated. */
+    uint64_t allocated;
+    /** the number of objects freed. */
+    uint64_t freed;
+    /** the number of bytes allocated. */
+    uint64_t bytes_allocated;
+    /** the number of bytes freed. */
+    uint64_t bytes_freed;
+    /** the greatest number of objects seen live at once. */
+    uint64_t high_water;
+};
+
+extern _Thread_local struct tag_counter thread_cell_counters[NTAGCOUNTERS];
+
+extern _Thread_local struct tag_counter thread_vso_counters[NTAGCOUNTERS];
+
+/**
+ * @return the counter for this `tag` in this table of `counters`, claiming
+ * one if the tag has none yet. As there are few tags, and the table is
+ * never more than half full, this is almost always the first probe.
+ */
+static inline struct tag_counter *tag_counter( struct tag_counter *counters,
+                                               uint32_t tag ) {
+    uint32_t i = ( tag * 0x9E3779B1u ) >> ( 32 - TAGCOUNTERBITS );
+
+    while ( counters[i].tag != tag && counters[i].tag != 0 ) {
+        i = ( i + 1 ) & ( NTAGCOUNTERS - 1 );
+    }
+    counters[i].tag = tag;
+
+    return &counters[i];
+}
+
+void note_vso_allocated( struct vector_space_object *vso, uint64_t bytes );
+
+void note_vso_freed( struct vector_space_object *vso );
+
+void flush_tag_counters(  );
+
+struct cons_pointer lisp_room( struct stack_frame *frame,
+                               struct cons_pointer frame_pointer,
+                               struct cons_pointer env );
+
+#endif
@@ -22,6 +22,7 @@
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
 #include "memory/dump.h"
+#include "memory/room.h"
 #include "memory/stack.h"
 #include "memory/vectorspace.h"
 #include "ops/lispops.h"
@@ -32,6 +33,15 @@
  */
 uint32_t stack_limit = 0;
 
+/**
+ * This thread's pool of freed stack frames. Every frame in the pool has
+ * its header and all its slots already set up as a new frame needs them,
+ * so that taking one costs neither an allocation nor clearing.
+ */
+static _Thread_local struct vector_space_object *frame_pool[FRAME_POOL_SIZE];
+
+static _Thread_local uint32_t frame_pool_count = 0;
+
 /**
  * set a register in a stack frame. Alwaye use this to do so,
  * because that way we can be sure the inc_ref happens!
@@ -76,39 +86,61 @@ struct stack_frame *get_stack_frame( struct cons_pointer pointer ) {
 /**
  * Make an empty stack frame, and return it.
  *
- * This function does the actual meat of making the frame.
+ * This function does the actual meat of making the frame, taking it from
+ * this thread's pool of freed frames if it has one and the frame is of the
+ * usual size.
  *
  * @param previous the current top-of-stack;
- * @param depth the depth of the new frame.
+ * @param depth the depth of the new frame;
+ * @param slots the number of argument slots it should have, at least
+ * `args_in_frame`.
  * @return the new frame, or NULL if memory is exhausted.
  */
 struct cons_pointer in_make_empty_frame( struct cons_pointer previous,
-                                         uint32_t depth ) {
+                                         uint32_t depth, int slots ) {
     debug_print( L"Entering make_empty_frame\n", DEBUG_ALLOC );
-    struct cons_pointer result =
-        make_vso( STACKFRAMETV, sizeof( struct stack_frame ) );
+    struct cons_pointer result = NIL;
+
+    if ( frame_pool_count > 0 && slots == args_in_frame ) {
+        struct vector_space_object *vso = frame_pool[--frame_pool_count];
+
+        result = make_vec_pointer( vso, STACKFRAMETV );
+
+        if ( exceptionp( result ) ) {
+            /* cons space is exhausted; keep the frame for later */
+            frame_pool_count++;
+            result = NIL;
+        } else {
+            vso->header.vecp = result;
+            note_vso_allocated( vso, sizeof( struct vector_space_header ) +
+                                vso->header.size );
+        }
+    } else {
+        result = make_vso( STACKFRAMETV, stack_frame_size( slots ) );
+
+        if ( !nilp( result ) ) {
+            struct stack_frame *frame = get_stack_frame( result );
+
+            /*
+             * The frame has already been cleared with memset in make_vso, but
+             * our NIL is not the same as C's NULL.
+             */
+            frame->function = NIL;
+            frame->args = 0;
+            frame->slots = slots;
+
+            for ( int i = 0; i < slots; i++ ) {
+                frame->arg[i] = NIL;
+            }
+        }
+    }
 
     if ( !nilp( result ) ) {
         struct stack_frame *frame = get_stack_frame( result );
-        /*
-         * \todo later, pop a frame off a free-list of stack frames
-         */
 
         frame->previous = previous;
         frame->depth = depth;
 
-        /*
-         * The frame has already been cleared with memset in make_vso, but our
-         * NIL is not the same as C's NULL.
-         */
-        frame->more = NIL;
-        frame->function = NIL;
-        frame->args = 0;
-
-        for ( int i = 0; i < args_in_frame; i++ ) {
-            frame->arg[i] = NIL;
-        }
-
         debug_dump_object( result, DEBUG_ALLOC );
     }
     debug_print( L"Leaving make_empty_frame\n", DEBUG_ALLOC );
@@ -118,21 +150,26 @@ struct cons_pointer in_make_empty_frame( struct cons_pointer previous,
 }
 
 /**
- * @brief Make an empty stack frame, and return it.
+ * @brief Make an empty stack frame with room for this many arguments, and
+ * return it.
  *
  * This function does the error checking around actual construction.
  *
  * @param previous the current top-of-stack;
- * @param env the environment in which evaluation happens.
- * @return the new frame, or NULL if memory is exhausted.
+ * @param n_args the number of arguments the frame is to hold.
+ * @return the new frame, or an exception if the stack is too deep or memory
+ * is exhausted.
  */
-struct cons_pointer make_empty_frame( struct cons_pointer previous ) {
+static struct cons_pointer make_frame( struct cons_pointer previous,
+                                       int n_args ) {
     struct cons_pointer result = NIL;
     uint32_t depth =
         ( nilp( previous ) ) ? 0 : ( get_stack_frame( previous ) )->depth + 1;
 
     if ( stack_limit == 0 || stack_limit > depth ) {
-        result = in_make_empty_frame( previous, depth );
+        result = in_make_empty_frame( previous, depth,
+                                      n_args > args_in_frame ? n_args :
+                                      args_in_frame );
     } else {
         debug_printf( DEBUG_STACK,
                       L"WARNING: Exceeded stack limit of %d\n", stack_limit );
@@ -150,6 +187,30 @@ struct cons_pointer make_empty_frame( struct cons_pointer previous ) {
     return result;
 }
 
+/**
+ * @brief Make an empty stack frame of the usual size, and return it.
+ *
+ * @param previous the current top-of-stack.
+ * @return the new frame, or an exception if the stack is too deep or memory
+ * is exhausted.
+ */
+struct cons_pointer make_empty_frame( struct cons_pointer previous ) {
+    return make_frame( previous, 0 );
+}
+
+/**
+ * @return the number of elements in this list of `args`.
+ */
+static int count_args( struct cons_pointer args ) {
+    int result = 0;
+
+    for ( ; consp( args ); args = c_cdr( args ) ) {
+        result++;
+    }
+
+    return result;
+}
+
 /**
  * Allocate a new stack frame with its previous pointer set to this value,
  * its arguments set up from these args, evaluated in this env.
@@ -162,15 +223,14 @@ struct cons_pointer make_stack_frame( struct cons_pointer previous,
                                       struct cons_pointer args,
                                       struct cons_pointer env ) {
     debug_print( L"Entering make_stack_frame\n", DEBUG_STACK );
-    struct cons_pointer result = make_empty_frame( previous );
+    struct cons_pointer result = make_frame( previous, count_args( args ) );
 
     if ( !exceptionp( result ) ) {
         struct stack_frame *frame = get_stack_frame( result );
 
-        while ( frame->args < args_in_frame && consp( args ) ) {
+        for ( ; consp( args ); args = c_cdr( args ) ) {
             /* iterate down the arg list filling in the arg slots in the
-             * frame. When there are no more slots, if there are still args,
-             * stash them on more */
+             * frame, of which there is one for each arg */
             struct cons_space_object cell = pointer2cell( args );
 
             /*
@@ -190,25 +250,10 @@ struct cons_pointer make_stack_frame( struct cons_pointer previous,
                 debug_print_object( cell.payload.cons.car, DEBUG_STACK );
                 debug_print( L"\n", DEBUG_STACK );
                 set_reg( frame, frame->args, val );
+                dec_ref( val );
             }
-
-            args = cell.payload.cons.cdr;
         }
 
-        if ( !exceptionp( result ) ) {
-            if ( consp( args ) ) {
-                /* if we still have args, eval them and stick the values on `more` */
-                struct cons_pointer more =
-                    eval_forms( get_stack_frame( previous ), previous, args,
-                                env );
-                frame->more = more;
-                inc_ref( more );
-
-                for ( ; !nilp( args ); args = c_cdr( args ) ) {
-                    frame->args++;
-                }
-            }
-        }
         debug_print( L"make_stack_frame: returning\n", DEBUG_STACK );
         debug_dump_object( result, DEBUG_STACK );
     }
@@ -229,26 +274,15 @@ struct cons_pointer make_special_frame( struct cons_pointer previous,
                                         struct cons_pointer env ) {
     debug_print( L"Entering make_special_frame\n", DEBUG_STACK );
 
-    struct cons_pointer result = make_empty_frame( previous );
+    struct cons_pointer result = make_frame( previous, count_args( args ) );
 
     if ( !exceptionp( result ) ) {
         struct stack_frame *frame = get_stack_frame( result );
 
-        while ( frame->args < args_in_frame && !nilp( args ) ) {
+        for ( ; consp( args ); args = c_cdr( args ) ) {
             /* iterate down the arg list filling in the arg slots in the
-             * frame. When there are no more slots, if there are still args,
-             * stash them on more */
-            struct cons_space_object cell = pointer2cell( args );
-
-            set_reg( frame, frame->args, cell.payload.cons.car );
-
-            args = cell.payload.cons.cdr;
-        }
-        if ( !exceptionp( result ) ) {
-            if ( consp( args ) ) {
-                frame->more = args;
-                inc_ref( args );
-            }
+             * frame, of which there is one for each arg */
+            set_reg( frame, frame->args, c_car( args ) );
         }
     }
     debug_print( L"make_special_frame: returning\n", DEBUG_STACK );
@@ -261,19 +295,57 @@ struct cons_pointer make_special_frame( struct cons_pointer previous,
  * Free this stack frame.
  */
 void free_stack_frame( struct stack_frame *frame ) {
-    /*
-     * \todo later, push it back on the stack-frame freelist
-     */
     debug_print( L"Entering free_stack_frame\n", DEBUG_ALLOC );
-    for ( int i = 0; i < args_in_frame; i++ ) {
+    for ( int i = 0; i < frame->slots; i++ ) {
         dec_ref( frame->arg[i] );
     }
-    if ( !nilp( frame->more ) ) {
-        dec_ref( frame->more );
-    }
     debug_print( L"Leaving free_stack_frame\n", DEBUG_ALLOC );
 }
 
+/**
+ * Keep the vector space object `vso` of a stack frame of the usual size
+ * which has been freed with `free_stack_frame` in this thread's pool, if
+ * there is room, setting its slots back to how a new frame needs them. The
+ * references the frame held must already have been given up.
+ *
+ * @return true if the frame was kept, else false, in which case the caller
+ * should release its memory.
+ */
+bool recycle_stack_frame( struct vector_space_object *vso ) {
+    struct stack_frame *frame = ( struct stack_frame * ) &( vso->payload );
+    bool result = frame_pool_count < FRAME_POOL_SIZE &&
+        frame->slots == args_in_frame;
+
+    if ( result ) {
+        for ( int i = 0; i < args_in_frame; i++ ) {
+            frame->arg[i] = NIL;
+        }
+        frame->function = NIL;
+        frame->args = 0;
+
+        note_vso_freed( vso );
+        frame_pool[frame_pool_count++] = vso;
+    }
+
+    return result;
+}
+
+/**
+ * Release the memory of every frame in this thread's pool; threads other
+ * than the main thread should call this, by way of `release_cons_pages`,
+ * before they exit.
+ */
+void drain_frame_pool(  ) {
+    while ( frame_pool_count > 0 ) {
+        struct vector_space_object *vso = frame_pool[--frame_pool_count];
+
+        /* already counted as freed when it was pooled */
+        note_vso_allocated( vso, sizeof( struct vector_space_header ) +
+                            vso->header.size );
+        release_vso( vso );
+    }
+}
+
 struct cons_pointer frame_get_previous( struct cons_pointer frame_pointer ) {
     struct stack_frame *frame = get_stack_frame( frame_pointer );
     struct cons_pointer result = NIL;
@@ -327,19 +399,13 @@ void dump_frame( URL_FILE *output, struct cons_pointer frame_pointer ) {
         dump_frame_context( output, frame_pointer, 4 );
 
         for ( int arg = 0; arg < frame->args; arg++ ) {
-            struct cons_space_object cell = pointer2cell( frame->arg[arg] );
-
             url_fwprintf( output, L"\tArg %d:\t%4.4s\tcount: %10u\tvalue: ",
-                          arg, cell.tag.bytes, cell.count );
+                          arg, pointer2tag( frame->arg[arg] ).bytes,
+                          pointer2count( frame->arg[arg] ) );
 
             print( output, frame->arg[arg] );
             url_fputws( L"\n", output );
         }
-        if ( !nilp( frame->more ) ) {
-            url_fputws( L"More: \t", output );
-            print( output, frame->more );
-            url_fputws( L"\n", output );
-        }
     }
 }
 
@@ -364,16 +430,8 @@ void dump_stack_trace( URL_FILE *output, struct cons_pointer pointer ) {
 struct cons_pointer fetch_arg( struct stack_frame *frame, unsigned int index ) {
     struct cons_pointer result = NIL;
 
-    if ( index < args_in_frame ) {
+    if ( index < frame->slots ) {
         result = frame->arg[index];
-    } else {
-        struct cons_pointer p = frame->more;
-
-        for ( int i = args_in_frame; i < index; i++ ) {
-            p = pointer2cell( p ).payload.cons.cdr;
-        }
-
-        result = pointer2cell( p ).payload.cons.car;
     }
 
     return result;
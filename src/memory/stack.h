@@ -21,10 +21,12 @@
 #ifndef __psse_stack_h
 #define __psse_stack_h
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "consspaceobject.h"
 #include "conspage.h"
+#include "vectorspace.h"
 
 /**
  * macros for the tag of a stack frame.
@@ -37,6 +39,17 @@
  */
 #define stackframep(vso)(((struct vector_space_object *)vso)->header.tag.value == STACKFRAMETV)
 
+/**
+ * the size in bytes of a stack frame with this many argument `slots`.
+ */
+#define stack_frame_size(slots)(sizeof(struct stack_frame) + (slots) * sizeof(struct cons_pointer))
+
+/**
+ * The greatest number of freed stack frames each thread keeps, ready
+ * initialised, for reuse.
+ */
+#define FRAME_POOL_SIZE 256
+
 extern uint32_t stack_limit;
 
 void set_reg( struct stack_frame *frame, int reg, struct cons_pointer value );
@@ -51,6 +64,10 @@ struct cons_pointer make_stack_frame( struct cons_pointer previous,
 
 void free_stack_frame( struct stack_frame *frame );
 
+bool recycle_stack_frame( struct vector_space_object *vso );
+
+void drain_frame_pool(  );
+
 void dump_frame( URL_FILE * output, struct cons_pointer pointer );
 
 void dump_stack_trace( URL_FILE * output, struct cons_pointer frame_pointer );
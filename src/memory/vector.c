@@ -0,0 +1,164 @@
+/*
+ * vector.c
+ *
+ * Vectors: sequences of cons pointers held contiguously in vector space,
+ * so that any element may be got at in constant time. A vector is filled
+ * when it is made, and not changed thereafter; like a list, it holds a
+ * reference to each of its elements.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#include <stdint.h>
+
+#include "debug.h"
+#include "io/print.h"
+#include "memory/conspage.h"
+#include "memory/consspaceobject.h"
+#include "memory/vector.h"
+#include "memory/vectorspace.h"
+
+/**
+ * Make a vector of this `length`, all of whose elements are `NIL`.
+ *
+ * @return the vector, or an exception if memory is exhausted.
+ */
+struct cons_pointer make_vector( uint64_t length ) {
+    struct cons_pointer result = make_vso( VECTORTV,
+                                           sizeof( struct vector_payload ) +
+                                           length *
+                                           sizeof( struct cons_pointer ) );
+
+    if ( nilp( result ) ) {
+        result = make_exception( privileged_string_memory_exhausted, NIL );
+    } else {
+        /* make_vso has zeroed the elements, and NIL is all zeroes */
+        vector_payload( result )->length = length;
+    }
+
+    return result;
+}
+
+/**
+ * Give up the references which the vector indicated by this `pointer`
+ * holds to its elements.
+ */
+void free_vector( struct cons_pointer pointer ) {
+    if ( vectorp( pointer ) ) {
+        struct vector_payload *payload = vector_payload( pointer );
+
+        for ( uint64_t i = 0; i < payload->length; i++ ) {
+            dec_ref( payload->elements[i] );
+        }
+    } else {
+        debug_printf( DEBUG_ALLOC, L"Non-vector passed to `free_vector`\n" );
+    }
+}
+
+/**
+ * @return the number of elements in the vector indicated by this
+ * `pointer`, or zero if it is not a vector.
+ */
+uint64_t vector_length( struct cons_pointer pointer ) {
+    return vectorp( pointer ) ? vector_payload( pointer )->length : 0;
+}
+
+/**
+ * @return the element at this zero-based `index` of the vector indicated by
+ * this `pointer`, or `NIL` if it is not a vector or has no such element.
+ */
+struct cons_pointer vector_get( struct cons_pointer pointer,
+                                uint64_t index ) {
+    struct cons_pointer result = NIL;
+
+    if ( vectorp( pointer ) ) {
+        struct vector_payload *payload = vector_payload( pointer );
+
+        if ( index < payload->length ) {
+            result = payload->elements[index];
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a vector of the elements of this `list`, in the same order, or
+ * an exception if memory is exhausted.
+ */
+struct cons_pointer list_to_vector( struct cons_pointer list ) {
+    struct cons_pointer result = make_vector( c_length( list ) );
+
+    if ( vectorp( result ) ) {
+        struct vector_payload *payload = vector_payload( result );
+        uint64_t i = 0;
+
+        for ( struct cons_pointer c = list; !nilp( c ); c = c_cdr( c ) ) {
+            payload->elements[i++] = inc_ref( c_car( c ) );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return a new vector of the elements of vector `a` followed by those of
+ * vector `b`, or an exception if memory is exhausted.
+ */
+struct cons_pointer vector_append( struct cons_pointer a,
+                                   struct cons_pointer b ) {
+    uint64_t length_a = vector_length( a );
+    uint64_t length_b = vector_length( b );
+    struct cons_pointer result = make_vector( length_a + length_b );
+
+    if ( vectorp( result ) ) {
+        struct vector_payload *payload = vector_payload( result );
+
+        for ( uint64_t i = 0; i < length_a; i++ ) {
+            payload->elements[i] = inc_ref( vector_get( a, i ) );
+        }
+        for ( uint64_t i = 0; i < length_b; i++ ) {
+            payload->elements[length_a + i] = inc_ref( vector_get( b, i ) );
+        }
+    }
+
+    return result;
+}
+
+void dump_vector( URL_FILE *output, struct cons_pointer pointer ) {
+    struct vector_payload *payload = vector_payload( pointer );
+
+    url_fwprintf( output, L"Vector of %lu elements:", payload->length );
+    for ( uint64_t i = 0; i < payload->length; i++ ) {
+        url_fwprintf( output, L"\n\t\t[%lu]: ", i );
+        print( output, payload->elements[i] );
+    }
+    url_fwprintf( output, L"\n" );
+}
+
+/**
+ * Function: return a vector of the arguments, in order.
+ *
+ * * (vector args...)
+ *
+ * @param frame my stack frame.
+ * @param frame_pointer a pointer to my stack frame.
+ * @param env my environment (ignored).
+ * @return a vector of the arguments.
+ */
+struct cons_pointer lisp_vector( struct stack_frame *frame,
+                                 struct cons_pointer frame_pointer,
+                                 struct cons_pointer env ) {
+    struct cons_pointer result = make_vector( frame->args );
+
+    if ( vectorp( result ) ) {
+        struct vector_payload *payload = vector_payload( result );
+
+        for ( int i = 0; i < frame->args; i++ ) {
+            payload->elements[i] = inc_ref( frame->arg[i] );
+        }
+    }
+
+    return result;
+}
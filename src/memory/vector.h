@@ -0,0 +1,45 @@
+/*
+ * vector.h
+ *
+ * Vectors: sequences of cons pointers held contiguously in vector space.
+ *
+ * (c) 2017 Simon Brooke <simon@journeyman.cc>
+ * Licensed under GPL version 2.0, or, at your option, any later version.
+ */
+
+#ifndef __psse_vector_h
+#define __psse_vector_h
+
+#include <stdint.h>
+
+#include "io/fopen.h"
+#include "memory/consspaceobject.h"
+#include "memory/vectorspace.h"
+
+/**
+ * @return the payload of the vector indicated by this `pointer`, which
+ * must be a vector.
+ */
+#define vector_payload(pointer)(&(pointer_to_vso(pointer)->payload.vector))
+
+struct cons_pointer make_vector( uint64_t length );
+
+void free_vector( struct cons_pointer pointer );
+
+uint64_t vector_length( struct cons_pointer pointer );
+
+struct cons_pointer vector_get( struct cons_pointer pointer,
+                                uint64_t index );
+
+struct cons_pointer list_to_vector( struct cons_pointer list );
+
+struct cons_pointer vector_append( struct cons_pointer a,
+                                   struct cons_pointer b );
+
+void dump_vector( URL_FILE * output, struct cons_pointer pointer );
+
+struct cons_pointer lisp_vector( struct stack_frame *frame,
+                                 struct cons_pointer frame_pointer,
+                                 struct cons_pointer env );
+
+#endif
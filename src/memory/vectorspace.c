@@ -8,7 +8,7 @@
  *  Licensed under GPL version 2.0, or, at your option, any later version.
  */
 
-#include <math.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,11 +25,152 @@
 #include "memory/consspaceobject.h"
 #include "debug.h"
 #include "io/io.h"
+#include "memory/bytes.h"
+#include "memory/hamt.h"
 #include "memory/hashmap.h"
+#include "memory/pstring.h"
+#include "memory/room.h"
 #include "memory/stack.h"
+#include "memory/vector.h"
 #include "memory/vectorspace.h"
 #include "ops/intern.h"
 
+/**
+ * A size class of vector space objects. Objects of a class are carved from
+ * slabs of `VSO_SLAB_BYTES`, which are never given back; freed objects are
+ * kept on a free list, linked through their first word, for reuse by the
+ * next object of the class, so that a steady churn of objects, such as
+ * stack frames, runs in a fixed amount of memory. The last class, of size
+ * zero, counts the objects too large for any slab, which are malloced and
+ * freed individually.
+ */
+struct vso_class {
+    /** the size of the objects of this class, header included. */
+    uint32_t size;
+    /** freed objects of this class, awaiting reuse. */
+    void *free;
+    /** the unused remainder of the newest slab. */
+    char *fresh;
+    char *fresh_end;
+    /** the number of slabs taken. */
+    uint64_t slabs;
+    /** the number of objects of this class allocated, ever. */
+    uint64_t allocated;
+    /** the number of objects of this class live, and the most ever. */
+    uint64_t live;
+    uint64_t high_water;
+    pthread_mutex_t lock;
+};
+
+#define VSO_CLASS( bytes ) { bytes, NULL, NULL, NULL, 0, 0, 0, 0, \
+        PTHREAD_MUTEX_INITIALIZER }
+
+/**
+ * The size classes, roughly four to each doubling so that no object wastes
+ * more than a fifth of its space; every size is a multiple of sixteen
+ * bytes, so every object is aligned as `malloc` would align it.
+ */
+static struct vso_class vso_classes[] = {
+    VSO_CLASS( 32 ), VSO_CLASS( 48 ), VSO_CLASS( 64 ), VSO_CLASS( 80 ),
+    VSO_CLASS( 96 ), VSO_CLASS( 128 ), VSO_CLASS( 160 ), VSO_CLASS( 192 ),
+    VSO_CLASS( 256 ), VSO_CLASS( 320 ), VSO_CLASS( 384 ), VSO_CLASS( 512 ),
+    VSO_CLASS( 640 ), VSO_CLASS( 768 ), VSO_CLASS( 1024 ),
+    VSO_CLASS( 1280 ), VSO_CLASS( 1536 ), VSO_CLASS( 2048 ),
+    VSO_CLASS( 2560 ), VSO_CLASS( 3072 ), VSO_CLASS( VSO_LARGEST_CLASS ),
+    VSO_CLASS( 0 )
+};
+
+#define NVSOCLASSES ( sizeof( vso_classes ) / sizeof( struct vso_class ) )
+
+/**
+ * @return the size class for objects of this many `bytes`, header
+ * included.
+ */
+static struct vso_class *vso_class_for( uint64_t bytes ) {
+    struct vso_class *result = &vso_classes[NVSOCLASSES - 1];
+
+    if ( bytes <= VSO_LARGEST_CLASS ) {
+        for ( int i = 0; i < NVSOCLASSES - 1; i++ ) {
+            if ( bytes <= vso_classes[i].size ) {
+                result = &vso_classes[i];
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @return memory for an object of this many `bytes`, header included, not
+ * cleared, or NULL if memory is exhausted.
+ */
+static void *allocate_vso_memory( uint64_t bytes ) {
+    struct vso_class *class = vso_class_for( bytes );
+    void *result = NULL;
+
+    pthread_mutex_lock( &class->lock );
+
+    if ( class->size == 0 ) {
+        result = malloc( bytes );
+    } else if ( class->free != NULL ) {
+        result = class->free;
+        class->free = *( void ** ) result;
+    } else {
+        if ( class->fresh_end - class->fresh < class->size ) {
+            class->fresh = malloc( VSO_SLAB_BYTES );
+
+            if ( class->fresh != NULL ) {
+                class->fresh_end = class->fresh + VSO_SLAB_BYTES;
+                class->slabs++;
+            } else {
+                class->fresh_end = NULL;
+            }
+        }
+        if ( class->fresh != NULL ) {
+            result = class->fresh;
+            class->fresh += class->size;
+        }
+    }
+
+    if ( result != NULL ) {
+        class->allocated++;
+        if ( ++class->live > class->high_water ) {
+            class->high_water = class->live;
+        }
+    }
+
+    pthread_mutex_unlock( &class->lock );
+
+    return result;
+}
+
+/**
+ * Return the memory of this vector space object `vso` for reuse, and count
+ * it freed; whatever it refers to is not touched. This is for collectors
+ * which deal with the object's references themselves; otherwise, use
+ * `free_vso`.
+ */
+void release_vso( struct vector_space_object *vso ) {
+    struct vso_class *class =
+        vso_class_for( sizeof( struct vector_space_header ) +
+                       vso->header.size );
+
+    note_vso_freed( vso );
+
+    pthread_mutex_lock( &class->lock );
+
+    if ( class->size == 0 ) {
+        free( vso );
+    } else {
+        *( void ** ) vso = class->free;
+        class->free = vso;
+    }
+    class->live--;
+
+    pthread_mutex_unlock( &class->lock );
+}
+
 
 /**
  * Make a cons_space_object which points to the vector_space_object
@@ -39,27 +180,30 @@
  * @tag the vector-space tag of the particular type of vector-space object,
  * NOT `VECTORPOINTTV`.
  *
- * @return a cons_pointer to the object, or NIL if the object could not be
- * allocated due to memory exhaustion.
+ * @return a cons_pointer to the object, or
+ * `privileged_exception_memory_exhausted` if cons space is exhausted.
  */
 struct cons_pointer make_vec_pointer( struct vector_space_object *address,
                                       uint32_t tag ) {
     debug_print( L"Entered make_vec_pointer\n", DEBUG_ALLOC );
     struct cons_pointer pointer = allocate_cell( VECTORPOINTTV );
-    struct cons_space_object *cell = &pointer2cell( pointer );
 
-    debug_printf( DEBUG_ALLOC,
-                  L"make_vec_pointer: tag written, about to set pointer address to %p\n",
-                  address );
+    if ( !exceptionp( pointer ) ) {
+        struct cons_space_object *cell = &pointer2cell( pointer );
 
-    cell->payload.vectorp.address = address;
-    cell->payload.vectorp.tag.value = tag;
+        debug_printf( DEBUG_ALLOC,
+                      L"make_vec_pointer: tag written, about to set pointer address to %p\n",
+                      address );
 
-    debug_printf( DEBUG_ALLOC,
-                  L"make_vec_pointer: all good, returning pointer to %p\n",
-                  cell->payload.vectorp.address );
+        cell->payload.vectorp.address = address;
+        cell->payload.vectorp.tag.value = tag;
 
-    debug_dump_object( pointer, DEBUG_ALLOC );
+        debug_printf( DEBUG_ALLOC,
+                      L"make_vec_pointer: all good, returning pointer to %p\n",
+                      cell->payload.vectorp.address );
+
+        debug_dump_object( pointer, DEBUG_ALLOC );
+    }
 
     return pointer;
 }
@@ -80,46 +224,86 @@ struct cons_pointer make_vso( uint32_t tag, uint64_t payload_size ) {
     struct cons_pointer result = NIL;
     int64_t total_size = sizeof( struct vector_space_header ) + payload_size;
 
-    /* Pad size to 64 bit words. This is intended to promote access efficiancy
-     * on 64 bit machines but may just be voodoo coding */
-    uint64_t padded = ceil( ( total_size * 8.0 ) / 8.0 );
-    debug_print( L"make_vso: about to malloc\n", DEBUG_ALLOC );
-    struct vector_space_object *vso = malloc( padded );
+    debug_print( L"make_vso: about to allocate\n", DEBUG_ALLOC );
+    struct vector_space_object *vso = allocate_vso_memory( total_size );
 
     if ( vso != NULL ) {
-        memset( vso, 0, padded );
+        memset( vso, 0, total_size );
         vso->header.tag.value = tag;
 
         debug_printf( DEBUG_ALLOC,
                       L"make_vso: written tag '%4.4s' into vso at %p\n",
                       vso->header.tag.bytes, vso );
+        vso->header.size = payload_size;
+        note_vso_allocated( vso, total_size );
+
         result = make_vec_pointer( vso, tag );
-        debug_dump_object( result, DEBUG_ALLOC );
-        vso->header.vecp = result;
-        // memcpy(vso->header.vecp, result, sizeof(struct cons_pointer));
 
-        vso->header.size = payload_size;
+        if ( exceptionp( result ) ) {
+            /* cons space is exhausted, so nothing can point to it */
+            release_vso( vso );
+            result = NIL;
+        } else {
+            debug_dump_object( result, DEBUG_ALLOC );
+            vso->header.vecp = result;
+            // memcpy(vso->header.vecp, result, sizeof(struct cons_pointer));
 
 #ifdef DEBUG
-        debug_printf( DEBUG_ALLOC,
-                      L"Allocated vector-space object of type %4.4s, total size %ld, payload size %ld, at address %p, payload address %p\n",
-                      &vso->header.tag.bytes, total_size, vso->header.size,
-                      vso, &vso->payload );
-        if ( padded != total_size ) {
-            debug_printf( DEBUG_ALLOC, L"\t\tPadded from %d to %d\n",
-                          total_size, padded );
-        }
+            debug_printf( DEBUG_ALLOC,
+                          L"Allocated vector-space object of type %4.4s, total size %ld, payload size %ld, at address %p, payload address %p\n",
+                          &vso->header.tag.bytes, total_size,
+                          vso->header.size, vso, &vso->payload );
 #endif
+        }
     }
 #ifdef DEBUG
-    debug_printf( DEBUG_ALLOC,
-                  L"make_vso: all good, returning pointer to %p\n",
-                  pointer2cell( result ).payload.vectorp.address );
+    if ( !nilp( result ) ) {
+        debug_printf( DEBUG_ALLOC,
+                      L"make_vso: all good, returning pointer to %p\n",
+                      pointer2cell( result ).payload.vectorp.address );
+    }
 #endif
 
     return result;
 }
 
+/**
+ * Move the vector space object indicated by this `pointer` to new memory
+ * with room for a payload of this `payload_size`, copying its header and
+ * as much of its payload as will fit, and zeroing the rest. Its VECP cell
+ * is pointed at the new memory, so that every reference to the object,
+ * all of which go through that cell, sees it moved; but any C pointer to
+ * the old memory is no longer good.
+ *
+ * @return the object in its new memory, or NULL if memory is exhausted,
+ * in which case the object is where it was, unchanged.
+ */
+struct vector_space_object *resize_vso( struct cons_pointer pointer,
+                                        uint64_t payload_size ) {
+    struct vector_space_object *from = pointer_to_vso( pointer );
+    uint64_t total_size = sizeof( struct vector_space_header ) + payload_size;
+    struct vector_space_object *result = allocate_vso_memory( total_size );
+
+    if ( result != NULL ) {
+        uint64_t kept = from->header.size < payload_size ?
+            from->header.size : payload_size;
+
+        memcpy( result, from, sizeof( struct vector_space_header ) + kept );
+        memset( ( char * ) &result->payload + kept, 0, payload_size - kept );
+        result->header.size = payload_size;
+        pointer2cell( pointer ).payload.vectorp.address = result;
+        note_vso_allocated( result, total_size );
+
+        release_vso( from );
+
+        debug_printf( DEBUG_ALLOC,
+                      L"Moved vector-space object of type %4.4s from %p to %p, payload size now %ld\n",
+                      &result->header.tag.bytes, from, result, payload_size );
+    }
+
+    return result;
+}
+
 /** for vector space pointers, free the actual vector-space
  * object. Dangerous! */
 
@@ -131,21 +315,68 @@ void free_vso( struct cons_pointer pointer ) {
                   ( char * ) cell.payload.vectorp.tag.bytes,
                   cell.payload.vectorp.address );
     struct vector_space_object *vso = cell.payload.vectorp.address;
+    bool recycled = false;
 
     switch ( vso->header.tag.value ) {
+        case BYTESTV:
+            free_bytes( pointer );
+            break;
+        case HAMTTV:
+            free_hamt( pointer );
+            break;
+        case HAMTNODETV:
+            free_hamt_node( pointer );
+            break;
         case HASHTV:
             free_hashmap( pointer );
             break;
+        case PSTRINGTV:
+            free_pstring( pointer );
+            break;
         case STACKFRAMETV:
             free_stack_frame( get_stack_frame( pointer ) );
+            recycled = recycle_stack_frame( vso );
+            break;
+        case VECTORTV:
+            free_vector( pointer );
             break;
     }
 
-//  free( (void *)cell.payload.vectorp.address );
+    if ( !recycled ) {
+        release_vso( vso );
+    }
     debug_printf( DEBUG_ALLOC, L"Freed vector-space object at 0x%lx\n",
                   cell.payload.vectorp.address );
 }
 
+/**
+ * Print the occupancy of each size class of vector space objects which has
+ * been used to this `output` stream.
+ */
+void summarise_vector_space( URL_FILE *output ) {
+    url_fwprintf( output, L"Vector space by size class:\n" );
+
+    for ( int i = 0; i < NVSOCLASSES; i++ ) {
+        struct vso_class *class = &vso_classes[i];
+
+        pthread_mutex_lock( &class->lock );
+
+        if ( class->allocated > 0 ) {
+            if ( class->size == 0 ) {
+                url_fwprintf( output, L"\t larger" );
+            } else {
+                url_fwprintf( output, L"\t%6u", class->size );
+            }
+            url_fwprintf( output,
+                          L" bytes: %4lu slabs, %10lu allocated, %8lu live, %8lu high water\n",
+                          class->slabs, class->allocated, class->live,
+                          class->high_water );
+        }
+
+        pthread_mutex_unlock( &class->lock );
+    }
+}
+
 // bool check_vso_tag( struct cons_pointer pointer, char * tag) {
 //     bool result = false;
 
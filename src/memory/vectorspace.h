@@ -19,6 +19,7 @@
 
 #include "consspaceobject.h"
 #include "hashmap.h"
+#include "io/fopen.h"
 
 #ifndef __vectorspace_h
 #define __vectorspace_h
@@ -29,7 +30,11 @@
 #define HASHTAG "HASH"
 #define HASHTV 1213415752
 
-#define hashmapp(conspoint)((check_tag(conspoint,HASHTV)))
+/*
+ * true if `conspoint` points to a map of either kind: a hashmap, or a
+ * persistent hashmap, q.v.
+ */
+#define hashmapp(conspoint)((check_tag(conspoint,HASHTV))||(check_tag(conspoint,HAMTTV)))
 
 /*
  * a namespace (i.e. a binding of names to values, implemented as a hashmap)
@@ -49,6 +54,54 @@
 
 #define vectorp(conspoint)(check_tag(conspoint,VECTORTV))
 
+/*
+ * an array of 64 bit integers, held unboxed.
+ */
+#define INTARRAYTAG "IARR"
+#define INTARRAYTV 1381122377
+
+#define intarrayp(conspoint)(check_tag(conspoint,INTARRAYTV))
+
+/*
+ * a string whose characters are held contiguously, rather than one to a cell.
+ */
+#define PSTRINGTAG "PSTR"
+#define PSTRINGTV 1381258064
+
+#define pstringp(conspoint)(check_tag(conspoint,PSTRINGTV))
+
+/*
+ * an array of double precision reals, held unboxed.
+ */
+#define REALARRAYTAG "RARR"
+#define REALARRAYTV 1381122386
+
+#define realarrayp(conspoint)(check_tag(conspoint,REALARRAYTV))
+
+/*
+ * a buffer of bytes, or a slice of one.
+ */
+#define BYTESTAG "BYTS"
+#define BYTESTV 1398036802
+
+#define bytesp(conspoint)(check_tag(conspoint,BYTESTV))
+
+/*
+ * a persistent hashmap, held as a hash array mapped trie.
+ */
+#define HAMTTAG "HAMT"
+#define HAMTTV 1414349128
+
+#define hamtp(conspoint)(check_tag(conspoint,HAMTTV))
+
+/*
+ * a node of a hash array mapped trie.
+ */
+#define HAMTNODETAG "HNOD"
+#define HAMTNODETV 1146048072
+
+#define hamtnodep(conspoint)(check_tag(conspoint,HAMTNODETV))
+
 /**
  * given a pointer to a vector space object, return the object.
  */
@@ -59,10 +112,34 @@
  */
 #define vso_get_vecp(vso)((((vector_space_object)vso)->header.vecp))
 
+/**
+ * Vector space objects of up to this many bytes, header included, are
+ * carved from slabs shared by objects of the same size class, and recycled
+ * when freed; larger ones are malloced and freed individually.
+ */
+#define VSO_LARGEST_CLASS 4096
+
+/**
+ * The number of bytes in each slab.
+ */
+#define VSO_SLAB_BYTES (64 * 1024)
+
+struct vector_space_object;
+
+struct cons_pointer make_vec_pointer( struct vector_space_object *address,
+                                      uint32_t tag );
+
 struct cons_pointer make_vso( uint32_t tag, uint64_t payload_size );
 
+struct vector_space_object *resize_vso( struct cons_pointer pointer,
+                                        uint64_t payload_size );
+
 void free_vso( struct cons_pointer pointer );
 
+void release_vso( struct vector_space_object *vso );
+
+void summarise_vector_space( URL_FILE * output );
+
 /**
  * the header which forms the start of every vector space object.
  */
@@ -81,9 +158,23 @@ struct vector_space_header {
 };
 
 /**
- * The payload of a hashmap. The number of buckets is assigned at run-time,
- * and is stored in n_buckets. Each bucket is something ASSOC can consume:
- * i.e. either an assoc list or a further hashmap.
+ * A slot in a hashmap. An empty slot has a key of `NIL`. The hash of the key
+ * is kept with it, so that a probe need only call `equal` on keys whose
+ * hashes match, and so that the map may be rehashed without hashing its
+ * keys again.
+ */
+struct hashmap_slot {
+    struct cons_pointer key;    /* the key, or `NIL` if the slot is empty */
+    struct cons_pointer value;  /* the value bound to the key */
+    uint32_t hash;              /* the hash of the key */
+    uint32_t distance;          /* how many slots the key lies beyond the
+                                 * slot its hash would put it in */
+};
+
+/**
+ * The payload of a hashmap. The slots are a single open addressed table,
+ * held in the vector space object itself; the number of them, which is a
+ * power of two, is assigned at run-time, and is stored in n_slots.
  */
 struct hashmap_payload {
     struct cons_pointer hash_fn;  /* function for hashing values in this hashmap, or `NIL` to use
@@ -92,10 +183,107 @@ struct hashmap_payload {
                                      * principal difference between a hashmap and a
                                      * namespace is that a hashmap has a write ACL
                                      * of `NIL`, meaning not writeable by anyone */
-    uint32_t n_buckets;         /* number of hash buckets */
-    uint32_t unused;            /* for word alignment and possible later expansion */
-    struct cons_pointer buckets[];  /* actual hash buckets, which should be `NIL`
-                                     * or assoc lists or (possibly) further hashmaps. */
+    uint32_t n_slots;           /* number of slots */
+    uint32_t count;             /* number of slots which hold keys */
+    struct hashmap_slot slots[];  /* the slots themselves */
+};
+
+
+/**
+ * An entry in a node of a hash array mapped trie: either a key, its value
+ * and the hash of the key, or a branch to a further node.
+ */
+struct hamt_entry {
+    struct cons_pointer key;    /* the key, or `NIL` if this entry is a
+                                 * branch */
+    struct cons_pointer value;  /* the value bound to the key, or the node
+                                 * to which the branch leads */
+    uint32_t hash;              /* the hash of the key */
+};
+
+/**
+ * The payload of a node of a hash array mapped trie. Each bit of the bitmap
+ * which is set stands for one of the 32 values which the next five bits of
+ * a hash may have, and there is an entry for each, in order; so the entry
+ * for a hash is found by counting the bits set below its own. Below the
+ * depth at which every bit of the hash has been used, a node holds keys
+ * whose hashes are all the same, its bitmap is zero, and it is searched
+ * from end to end.
+ */
+struct hamt_node_payload {
+    uint32_t bitmap;            /* which entries are present */
+    uint32_t count;             /* the number of entries */
+    struct hamt_entry entries[];  /* the entries themselves */
+};
+
+/**
+ * The payload of a persistent hashmap. Nodes are never changed once made,
+ * and may be shared between maps; so a map with a key added or removed
+ * need copy only the nodes on the path to that key.
+ */
+struct hamt_payload {
+    struct cons_pointer hash_fn;  /* function for hashing values in this
+                                   * hashmap, or `NIL` to use the default
+                                   * hashing function */
+    struct cons_pointer write_acl;  /* as for a hashmap */
+    struct cons_pointer root;   /* the root node, or `NIL` if empty */
+    uint64_t count;             /* the number of keys */
+};
+
+/**
+ * The payload of a vector. The elements are held contiguously, so that any
+ * of them may be got at in constant time, and are never changed once the
+ * vector has been filled.
+ */
+struct vector_payload {
+    uint64_t length;            /* number of elements */
+    struct cons_pointer elements[];   /* the elements themselves */
+};
+
+
+/**
+ * The payload of an integer array: its length, and that many integers,
+ * unboxed.
+ */
+struct intarray_payload {
+    uint64_t length;            /* number of elements */
+    int64_t elements[];         /* the elements themselves */
+};
+
+/**
+ * The payload of a real array: its length, and that many reals, unboxed.
+ */
+struct realarray_payload {
+    uint64_t length;            /* number of elements */
+    double elements[];          /* the elements themselves */
+};
+
+/**
+ * The payload of a packed string: its length and hash, computed once when
+ * it is made, and its characters, UTF-32, contiguously. Those few things
+ * which must walk a string a cell at a time, such as `cdr`, are given a
+ * cell string of the same characters, made when first needed and kept in
+ * `cells` thereafter.
+ */
+struct pstring_payload {
+    uint64_t length;            /* number of characters */
+    uint32_t hash;              /* as for a cell string of these characters */
+    struct cons_pointer cells;  /* the same as a cell string, or NIL */
+    wchar_t characters[];       /* the characters themselves */
+};
+
+/**
+ * The payload of a byte buffer: its length, and a pointer to its first
+ * byte. A buffer read from a stream holds its bytes itself, in `data`; a
+ * slice of one holds none, but shares those of the buffer it was cut from,
+ * which it keeps in `base`, so that they are not freed while it lives.
+ * Byte buffers are never moved (see `resize_vso`), so `bytes` stays good.
+ */
+struct bytes_payload {
+    uint64_t length;            /* number of bytes */
+    struct cons_pointer base;   /* the buffer this is a slice of, or NIL */
+    uint8_t *bytes;             /* the first byte */
+    uint8_t data[];             /* the bytes themselves, if not a slice */
 };
 
 
@@ -115,6 +303,13 @@ struct vector_space_object {
         /** the payload considered as bytes */
         char bytes;
         struct hashmap_payload hashmap;
+        struct vector_payload vector;
+        struct intarray_payload intarray;
+        struct realarray_payload realarray;
+        struct pstring_payload pstring;
+        struct bytes_payload bytebuffer;
+        struct hamt_payload hamt;
+        struct hamt_node_payload hamtnode;
     } payload;
 };
 
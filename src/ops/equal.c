@@ -11,12 +11,18 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "arith/array.h"
 #include "arith/integer.h"
 #include "arith/peano.h"
 #include "arith/ratio.h"
+#include "authorise.h"
 #include "debug.h"
+#include "memory/bytes.h"
+#include "memory/hamt.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
+#include "memory/pstring.h"
+#include "memory/vector.h"
 #include "memory/vectorspace.h"
 #include "ops/equal.h"
 #include "ops/intern.h"
@@ -37,10 +43,7 @@ bool eq( struct cons_pointer a, struct cons_pointer b ) {
  * else false.
  */
 bool same_type( struct cons_pointer a, struct cons_pointer b ) {
-    struct cons_space_object *cell_a = &pointer2cell( a );
-    struct cons_space_object *cell_b = &pointer2cell( b );
-
-    return cell_a->tag.value == cell_b->tag.value;
+    return pointer2tag( a ).value == pointer2tag( b ).value;
 }
 
 /**
@@ -127,9 +130,8 @@ bool equal_integer_number( struct cons_pointer a, struct cons_pointer b ) {
     debug_print( L" = ", DEBUG_ARITH );
     debug_print_object( b, DEBUG_ARITH );
     bool result = false;
-    struct cons_space_object *cell_b = &pointer2cell( b );
 
-    switch ( cell_b->tag.value ) {
+    switch ( pointer2tag( b ).value ) {
         case INTEGERTV:
             result = equal_integer_integer( a, b );
             break;
@@ -164,7 +166,7 @@ bool equal_real_number( struct cons_pointer a, struct cons_pointer b ) {
     bool result = false;
     struct cons_space_object *cell_b = &pointer2cell( b );
 
-    switch ( cell_b->tag.value ) {
+    switch ( pointer2tag( b ).value ) {
         case INTEGERTV:
             result = equal_integer_real( b, a );
             break;
@@ -205,10 +207,7 @@ bool equal_number_number( struct cons_pointer a, struct cons_pointer b ) {
     debug_print_object( b, DEBUG_ARITH );
 
     if ( !result ) {
-        struct cons_space_object *cell_a = &pointer2cell( a );
-        struct cons_space_object *cell_b = &pointer2cell( b );
-
-        switch ( cell_a->tag.value ) {
+        switch ( pointer2tag( a ).value ) {
             case INTEGERTV:
                 result = equal_integer_number( a, b );
                 break;
@@ -216,7 +215,7 @@ bool equal_number_number( struct cons_pointer a, struct cons_pointer b ) {
                 result = equal_real_number( a, b );
                 break;
             case RATIOTV:
-                switch ( cell_b->tag.value ) {
+                switch ( pointer2tag( b ).value ) {
                     case INTEGERTV:
                         /* as ratios are simplified by make_ratio, any
                          * ratio that would simplify to an integer is an
@@ -247,12 +246,12 @@ bool equal_number_number( struct cons_pointer a, struct cons_pointer b ) {
 /**
  * @brief equality of two map-like things. 
  *
- * The list returned by `keys` on a map-like thing is not sorted, and is not 
- * guaranteed always to come out in the same order. So equality is established
- * if:
- * 1. the length of the keys list is the same; and 
- * 2. the value of each key in the keys list for map `a` is the same in map `a` 
- *    and in map `b`.
+ * The slots in which keys lie depend on the order in which they were put,
+ * and on the number of slots, so that two maps with the same keys need not
+ * have them in the same slots. So equality is established if:
+ * 1. the number of keys is the same; and 
+ * 2. the value of each key in map `a` is the same in map `a` and in map
+ *    `b`; the key is found in `b` by the hash cached with it in `a`.
  *
  * Private function, do not use outside this file, **WILL NOT** work 
  * unless both arguments are VECPs.
@@ -263,35 +262,57 @@ bool equal_number_number( struct cons_pointer a, struct cons_pointer b ) {
  * @return false otherwise.
  */
 bool equal_map_map( struct cons_pointer a, struct cons_pointer b ) {
-    bool result = false;
+    struct hashmap_payload *map_a = &pointer_to_vso( a )->payload.hashmap;
+    struct hashmap_payload *map_b = &pointer_to_vso( b )->payload.hashmap;
+    bool result = truep( authorised( a, NIL ) ) &&
+        truep( authorised( b, NIL ) ) && map_a->count == map_b->count;
 
-    struct cons_pointer keys_a = hashmap_keys( a );
+    for ( uint32_t i = 0; result && i < map_a->n_slots; i++ ) {
+        struct hashmap_slot *slot = &map_a->slots[i];
 
-    if ( c_length( keys_a ) == c_length( hashmap_keys( b ) ) ) {
-        result = true;
+        if ( !nilp( slot->key ) ) {
+            struct hashmap_slot *other =
+                hashmap_find_slot( map_b, slot->key, slot->hash );
 
-        for ( struct cons_pointer i = keys_a; !nilp( i ); i = c_cdr( i ) ) {
-            struct cons_pointer key = c_car( i );
-            if ( !equal
-                 ( hashmap_get( a, key, false ),
-                   hashmap_get( b, key, false ) ) ) {
-                result = false;
-                break;
-            }
+            result = other != NULL && equal( slot->value, other->value );
         }
     }
 
     return result;
 }
 
+/**
+ * @brief equality of two vectors: true if they are of the same length,
+ * and each element of `a` is `equal` to the element of `b` at the same
+ * index.
+ *
+ * Private function, do not use outside this file, **WILL NOT** work
+ * unless both arguments are vectors.
+ *
+ * @param a a pointer to a vector.
+ * @param b another pointer to a vector.
+ * @return true if the two vectors have the same logical structure.
+ * @return false otherwise.
+ */
+bool equal_vector_elements( struct cons_pointer a, struct cons_pointer b ) {
+    uint64_t length = vector_length( a );
+    bool result = length == vector_length( b );
+
+    for ( uint64_t i = 0; result && i < length; i++ ) {
+        result = equal( vector_get( a, i ), vector_get( b, i ) );
+    }
+
+    return result;
+}
+
 /**
  * @brief equality of two vector-space things. 
  *
- * Expensive, but we need to be able to check for equality of at least hashmaps
- * and namespaces.
+ * Expensive, but we need to be able to check for equality of at least
+ * hashmaps, namespaces and vectors.
  *
  * Private function, do not use outside this file, not guaranteed to work 
- * unless both arguments are VECPs pointing to map like things.
+ * unless both arguments are VECPs.
  * 
  * @param a a pointer to a vector space object.
  * @param b another pointer to a vector space object.
@@ -307,7 +328,7 @@ bool equal_vector_vector( struct cons_pointer a, struct cons_pointer b ) {
          * same address in vector space, so I don't believe it's worth checking
          * for this.
          */
-    } else if ( vectorp( a ) && vectorp( b ) ) {
+    } else if ( vectorpointp( a ) && vectorpointp( b ) ) {
         struct vector_space_object *va = pointer_to_vso( a );
         struct vector_space_object *vb = pointer_to_vso( b );
 
@@ -315,10 +336,23 @@ bool equal_vector_vector( struct cons_pointer a, struct cons_pointer b ) {
          * even if they have identical logical structure. Is this right? */
         if ( va->header.tag.value == vb->header.tag.value ) {
             switch ( va->header.tag.value ) {
+                case BYTESTV:
+                    result = equal_bytes( a, b );
+                    break;
+                case HAMTTV:
+                    result = equal_hamts( a, b );
+                    break;
                 case HASHTV:
                 case NAMESPACETV:
                     result = equal_map_map( a, b );
                     break;
+                case INTARRAYTV:
+                case REALARRAYTV:
+                    result = equal_numeric_arrays( a, b );
+                    break;
+                case VECTORTV:
+                    result = equal_vector_elements( a, b );
+                    break;
             }
         }
     }
@@ -341,11 +375,14 @@ bool equal( struct cons_pointer a, struct cons_pointer b ) {
 
     if ( eq( a, b ) ) {
         result = true;
+    } else if ( ( pstringp( a ) && any_stringp( b ) ) ||
+                ( stringp( a ) && pstringp( b ) ) ) {
+        result = equal_strings( a, b );
     } else if ( !numberp( a ) && same_type( a, b ) ) {
         struct cons_space_object *cell_a = &pointer2cell( a );
         struct cons_space_object *cell_b = &pointer2cell( b );
 
-        switch ( cell_a->tag.value ) {
+        switch ( pointer2tag( a ).value ) {
             case CONSTV:
             case LAMBDATV:
             case NLAMBDATV:
@@ -371,7 +408,7 @@ bool equal( struct cons_pointer a, struct cons_pointer b ) {
                      cell_b->payload.string.hash ) {
                     wchar_t a_buff[STRING_SHIPYARD_SIZE],
                         b_buff[STRING_SHIPYARD_SIZE];
-                    uint32_t tag = cell_a->tag.value;
+                    uint32_t tag = pointer2tag( a ).value;
                     int i = 0;
 
                     memset( a_buff, 0, sizeof( a_buff ) );
@@ -405,7 +442,7 @@ bool equal( struct cons_pointer a, struct cons_pointer b ) {
                 }
                 break;
             case VECTORPOINTTV:
-                if ( cell_b->tag.value == VECTORPOINTTV ) {
+                if ( pointer2tag( b ).value == VECTORPOINTTV ) {
                     result = equal_vector_vector( a, b );
                 } else {
                     result = false;
@@ -18,6 +18,7 @@
  */
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 /*
  * wide characters
@@ -30,7 +31,9 @@
 #include "io/io.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
+#include "memory/hamt.h"
 #include "memory/hashmap.h"
+#include "memory/pstring.h"
 #include "ops/equal.h"
 #include "ops/intern.h"
 #include "ops/lispops.h"
@@ -77,13 +80,14 @@ uint32_t sxhash( struct cons_pointer ptr ) {
 
 /**
  * Get the hash value for the cell indicated by this `ptr`; currently only
- * implemented for string like things and integers.
+ * implemented for string like things, including packed strings, and
+ * integers.
  */
 uint32_t get_hash( struct cons_pointer ptr ) {
     struct cons_space_object *cell = &pointer2cell( ptr );
     uint32_t result = 0;
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( ptr ).value ) {
         case INTEGERTV:
             /* Note that we're only hashing on the least significant word of an
              * integer. */
@@ -97,6 +101,11 @@ uint32_t get_hash( struct cons_pointer ptr ) {
         case TRUETV:
             result = 1;         // arbitrarily
             break;
+        case VECTORPOINTTV:
+            /* a packed string hashes as the same string made of cells */
+            result = pstringp( ptr ) ? pstring_payload( ptr )->hash :
+                sxhash( ptr );
+            break;
         default:
             result = sxhash( ptr );
             break;
@@ -113,16 +122,18 @@ void free_hashmap( struct cons_pointer pointer ) {
 
     if ( hashmapp( pointer ) ) {
         struct vector_space_object *vso = cell->payload.vectorp.address;
-
-        dec_ref( vso->payload.hashmap.hash_fn );
-        dec_ref( vso->payload.hashmap.write_acl );
-
-        for ( int i = 0; i < vso->payload.hashmap.n_buckets; i++ ) {
-            if ( !nilp( vso->payload.hashmap.buckets[i] ) ) {
-                debug_printf( DEBUG_ALLOC,
-                              L"Decrementing bucket [%d] of hashmap at 0x%lx\n",
-                              i, cell->payload.vectorp.address );
-                dec_ref( vso->payload.hashmap.buckets[i] );
+        struct hashmap_payload *payload = &vso->payload.hashmap;
+
+        dec_ref( payload->hash_fn );
+        dec_ref( payload->write_acl );
+
+        debug_printf( DEBUG_ALLOC,
+                      L"Decrementing %d pairs of hashmap at 0x%lx\n",
+                      payload->count, cell->payload.vectorp.address );
+        for ( uint32_t i = 0; i < payload->n_slots; i++ ) {
+            if ( !nilp( payload->slots[i].key ) ) {
+                dec_ref( payload->slots[i].key );
+                dec_ref( payload->slots[i].value );
             }
         }
     } else {
@@ -130,18 +141,30 @@ void free_hashmap( struct cons_pointer pointer ) {
     }
 }
 
+/**
+ * @return the size of the payload of a hashmap with this number of slots.
+ */
+static uint64_t hashmap_payload_size( uint32_t n_slots ) {
+    return sizeof( struct hashmap_payload ) +
+        sizeof( struct hashmap_slot ) * ( uint64_t ) n_slots;
+}
 
 /**
- * Make a hashmap with this number of buckets, using this `hash_fn`. If 
- * `hash_fn` is `NIL`, use the standard hash funtion.
+ * Make a hashmap with room for at least this number of keys, using this
+ * `hash_fn`. If `hash_fn` is `NIL`, use the standard hash funtion. The
+ * number of slots is rounded up to a power of two.
  */
-struct cons_pointer make_hashmap( uint32_t n_buckets,
+struct cons_pointer make_hashmap( uint32_t n_slots,
                                   struct cons_pointer hash_fn,
                                   struct cons_pointer write_acl ) {
-    struct cons_pointer result = make_vso( HASHTV,
-                                           ( sizeof( struct cons_pointer ) *
-                                             ( n_buckets + 2 ) ) +
-                                           ( sizeof( uint32_t ) * 2 ) );
+    uint32_t n = 1;
+
+    while ( n < n_slots && n < ( UINT32_MAX / 2 ) + 1 ) {
+        n *= 2;
+    }
+
+    /* make_vso zeroes the slots, and a slot of zeroes has a key of `NIL` */
+    struct cons_pointer result = make_vso( HASHTV, hashmap_payload_size( n ) );
 
     struct hashmap_payload *payload =
         ( struct hashmap_payload * ) &pointer_to_vso( result )->payload;
@@ -149,26 +172,88 @@ struct cons_pointer make_hashmap( uint32_t n_buckets,
     payload->hash_fn = inc_ref( hash_fn );
     payload->write_acl = inc_ref( write_acl );
 
-    payload->n_buckets = n_buckets;
-    for ( int i = 0; i < n_buckets; i++ ) {
-        payload->buckets[i] = NIL;
+    payload->n_slots = n;
+    payload->count = 0;
+
+    return result;
+}
+
+/**
+ * Find the slot holding this `key`, whose hash is this `hash`, in this
+ * hashmap `payload`. Keys are placed Robin Hood fashion: a key being placed
+ * takes the slot of any key which lies fewer slots beyond its own home
+ * slot, and that key is placed further on in its stead. So the keys which
+ * lie beyond a key's home slot lie no nearer their own, and the search may
+ * stop at the first slot whose key is nearer home than the key sought would
+ * be, as well as at an empty one.
+ *
+ * @return a pointer to the slot, or `NULL` if the key is not there.
+ */
+struct hashmap_slot *hashmap_find_slot( struct hashmap_payload *payload,
+                                        struct cons_pointer key,
+                                        uint32_t hash ) {
+    uint32_t mask = payload->n_slots - 1;
+    struct hashmap_slot *result = NULL;
+
+    for ( uint32_t distance = 0, i = hash & mask;
+          distance < payload->n_slots; distance++, i = ( i + 1 ) & mask ) {
+        struct hashmap_slot *slot = &payload->slots[i];
+
+        if ( nilp( slot->key ) || slot->distance < distance ) {
+            break;
+        } else if ( slot->hash == hash && equal( slot->key, key ) ) {
+            result = slot;
+            break;
+        }
     }
 
     return result;
 }
 
 /**
- * return a flat list of all the keys in the hashmap indicated by `map`.
+ * Place this `entry`, whose key is not already in it, in this hashmap
+ * `payload`, which must have an empty slot. References are neither taken
+ * nor dropped: the payload simply holds those which the entry held.
+ */
+static void place_slot( struct hashmap_payload *payload,
+                        struct hashmap_slot entry ) {
+    uint32_t mask = payload->n_slots - 1;
+
+    entry.distance = 0;
+
+    for ( uint32_t i = entry.hash & mask;; i = ( i + 1 ) & mask ) {
+        struct hashmap_slot *slot = &payload->slots[i];
+
+        if ( nilp( slot->key ) ) {
+            *slot = entry;
+            break;
+        } else if ( slot->distance < entry.distance ) {
+            /* the entry is further from home than this key: take its slot,
+             * and carry it on in the entry's stead */
+            struct hashmap_slot displaced = *slot;
+
+            *slot = entry;
+            entry = displaced;
+        }
+        entry.distance++;
+    }
+}
+
+/**
+ * return a flat list of all the keys in the hashmap indicated by `map`, in
+ * the order of their slots.
  */
 struct cons_pointer hashmap_keys( struct cons_pointer mapp ) {
     struct cons_pointer result = NIL;
-    if ( hashmapp( mapp ) && truep( authorised( mapp, NIL ) ) ) {
-        struct vector_space_object *map = pointer_to_vso( mapp );
-
-        for ( int i = 0; i < map->payload.hashmap.n_buckets; i++ ) {
-            for ( struct cons_pointer c = map->payload.hashmap.buckets[i];
-                  !nilp( c ); c = c_cdr( c ) ) {
-                result = make_cons( c_car( c_car( c ) ), result );
+    if ( hamtp( mapp ) ) {
+        result = truep( authorised( mapp, NIL ) ) ? hamt_keys( mapp ) : NIL;
+    } else if ( hashmapp( mapp ) && truep( authorised( mapp, NIL ) ) ) {
+        struct hashmap_payload *payload =
+            &pointer_to_vso( mapp )->payload.hashmap;
+
+        for ( uint32_t i = payload->n_slots; i > 0; i-- ) {
+            if ( !nilp( payload->slots[i - 1].key ) ) {
+                result = make_cons( payload->slots[i - 1].key, result );
             }
         }
     }
@@ -176,28 +261,47 @@ struct cons_pointer hashmap_keys( struct cons_pointer mapp ) {
     return result;
 }
 
+/**
+ * @return `next`, the map which putting into `mapp` gave. If that is a new
+ * map, `mapp`, which it replaces, is dropped, unless it is `original`,
+ * which belongs to the caller.
+ */
+static struct cons_pointer next_map( struct cons_pointer mapp,
+                                     struct cons_pointer next,
+                                     struct cons_pointer original ) {
+    if ( !eq( next, mapp ) && !eq( mapp, original ) ) {
+        dec_ref( mapp );
+    }
+
+    return next;
+}
+
 /**
  * Copy all key/value pairs in this association list `assoc` into this hashmap `mapp`. If
  * current user is authorised to write to this hashmap, modifies the hashmap and
- * returns it; if not, clones the hashmap, modifies the clone, and returns that.
+ * returns it; if not, returns a new hashmap with the pairs added.
  */
 struct cons_pointer hashmap_put_all( struct cons_pointer mapp,
                                      struct cons_pointer assoc ) {
-    // TODO: if current user has write access to this hashmap
-    if ( hashmapp( mapp ) ) {
-        struct vector_space_object *map = pointer_to_vso( mapp );
+    struct cons_pointer original = mapp;
 
+    if ( hashmapp( mapp ) ) {
         if ( consp( assoc ) ) {
             for ( struct cons_pointer pair = c_car( assoc ); !nilp( pair );
                   pair = c_car( assoc ) ) {
-                /* TODO: this is really hammering the memory management system, because
-                 * it will make a new clone for every key/value pair added. Fix. */
+                /* a hashmap which may not be written is cloned for each
+                 * pair added; a persistent hashmap copies only the path to
+                 * the key, so that it costs much less. */
                 if ( consp( pair ) ) {
-                    mapp = hashmap_put( mapp, c_car( pair ), c_cdr( pair ) );
+                    mapp = next_map( mapp,
+                                     hashmap_put( mapp, c_car( pair ),
+                                                  c_cdr( pair ) ), original );
                 } else if ( hashmapp( pair ) ) {
-                    hashmap_put_all( mapp, pair );
+                    mapp = next_map( mapp, hashmap_put_all( mapp, pair ),
+                                     original );
                 } else {
-                    hashmap_put( mapp, pair, TRUE );
+                    mapp = next_map( mapp, hashmap_put( mapp, pair, TRUE ),
+                                     original );
                 }
                 assoc = c_cdr( assoc );
             }
@@ -205,7 +309,12 @@ struct cons_pointer hashmap_put_all( struct cons_pointer mapp,
             for ( struct cons_pointer keys = hashmap_keys( assoc );
                   !nilp( keys ); keys = c_cdr( keys ) ) {
                 struct cons_pointer key = c_car( keys );
-                hashmap_put( mapp, key, hashmap_get( assoc, key, false ) );
+
+                mapp = next_map( mapp,
+                                 hashmap_put( mapp, key,
+                                              hashmap_get( assoc, key,
+                                                           false ) ),
+                                 original );
             }
         }
     }
@@ -231,12 +340,17 @@ struct cons_pointer hashmap_get( struct cons_pointer mapp,
 
     struct cons_pointer result = NIL;
     if ( hashmapp( mapp ) && truep( authorised( mapp, NIL ) ) && !nilp( key ) ) {
-        struct vector_space_object *map = pointer_to_vso( mapp );
-        uint32_t bucket_no = get_hash( key ) % map->payload.hashmap.n_buckets;
-
-        result =
-            search_store( key, map->payload.hashmap.buckets[bucket_no],
-                          return_key );
+        if ( hamtp( mapp ) ) {
+            result = hamt_get( mapp, key, return_key );
+        } else {
+            struct hashmap_slot *slot =
+                hashmap_find_slot( &pointer_to_vso( mapp )->payload.hashmap,
+                                   key, get_hash( key ) );
+
+            if ( slot != NULL ) {
+                result = return_key ? slot->key : slot->value;
+            }
+        }
     }
 #ifdef DEBUG
     debug_print( L"\nhashmap_get returning: `", DEBUG_BIND );
@@ -255,22 +369,32 @@ struct cons_pointer clone_hashmap( struct cons_pointer ptr ) {
     struct cons_pointer result = NIL;
 
     if ( truep( authorised( ptr, NIL ) ) ) {
-        if ( hashmapp( ptr ) ) {
+        if ( hamtp( ptr ) ) {
+            /* the trie is never changed, so may simply be shared */
+            result = clone_hamt( ptr );
+        } else if ( hashmapp( ptr ) ) {
             struct vector_space_object const *from = pointer_to_vso( ptr );
 
             if ( from != NULL ) {
-                struct hashmap_payload from_pl = from->payload.hashmap;
+                /* pointers, not copies: the slots are a flexible array
+                 * member, which a copy of the payload would not include */
+                struct hashmap_payload const *from_pl = &from->payload.hashmap;
                 result =
-                    make_hashmap( from_pl.n_buckets, from_pl.hash_fn,
-                                  from_pl.write_acl );
-                struct vector_space_object const *to =
-                    pointer_to_vso( result );
-                struct hashmap_payload to_pl = to->payload.hashmap;
-
-                for ( int i = 0; i < to_pl.n_buckets; i++ ) {
-                    to_pl.buckets[i] = from_pl.buckets[i];
-                    inc_ref( to_pl.buckets[i] );
+                    make_hashmap( from_pl->n_slots, from_pl->hash_fn,
+                                  from_pl->write_acl );
+                struct hashmap_payload *to_pl =
+                    &pointer_to_vso( result )->payload.hashmap;
+
+                /* the slots may be copied as they are, since the clone has
+                 * as many as the original */
+                for ( uint32_t i = 0; i < to_pl->n_slots; i++ ) {
+                    to_pl->slots[i] = from_pl->slots[i];
+                    if ( !nilp( to_pl->slots[i].key ) ) {
+                        inc_ref( to_pl->slots[i].key );
+                        inc_ref( to_pl->slots[i].value );
+                    }
                 }
+                to_pl->count = from_pl->count;
             }
         }
     } else {
@@ -341,6 +465,7 @@ struct cons_pointer search_store( struct cons_pointer key,
                                             goto found;
                                         }
                                         break;
+                                    case HAMTTV:
                                     case HASHTV:
                                     case NAMESPACETV:
                                         result =
@@ -360,6 +485,7 @@ struct cons_pointer search_store( struct cons_pointer key,
 
                                 }
                                 break;
+                            case HAMTTV:
                             case HASHTV:
                             case NAMESPACETV:
                                 debug_print
@@ -380,6 +506,7 @@ struct cons_pointer search_store( struct cons_pointer key,
                         }
                     }
                     break;
+                case HAMTTV:
                 case HASHTV:
                 case NAMESPACETV:
                     result = hashmap_get( store, key, return_key );
@@ -454,14 +581,7 @@ struct cons_pointer internedp( struct cons_pointer key,
             store = c_cdr( store );
         }
     } else if ( hashmapp( store ) ) {
-        struct vector_space_object *map = pointer_to_vso( store );
-
-        for ( int i = 0; i < map->payload.hashmap.n_buckets; i++ ) {
-            for ( struct cons_pointer c = map->payload.hashmap.buckets[i];
-                  !nilp( c ); c = c_cdr( c ) ) {
-                result = internedp( key, c );
-            }
-        }
+        result = nilp( hashmap_get( store, key, true ) ) ? NIL : TRUE;
     }
 
     return result;
@@ -481,28 +601,94 @@ struct cons_pointer c_assoc( struct cons_pointer key,
 }
 
 /**
- * Store this `val` as the value of this `key` in this hashmap `mapp`. If
+ * Rehash the hashmap indicated by this `mapp` to twice as many slots. The
+ * keys are placed afresh, from the copy of their slots made first, using
+ * the hashes cached in them.
+ *
+ * The map is moved in vector space, but its cons pointer is unchanged; if
+ * memory is exhausted, it is left as it was.
+ */
+static void rehash_hashmap( struct cons_pointer mapp ) {
+    struct hashmap_payload *payload =
+        &pointer_to_vso( mapp )->payload.hashmap;
+    uint32_t n = payload->n_slots;
+    struct hashmap_slot *old = n < UINT32_MAX / 2 ?
+        malloc( sizeof( struct hashmap_slot ) * n ) : NULL;
+
+    if ( old != NULL ) {
+        memcpy( old, payload->slots, sizeof( struct hashmap_slot ) * n );
+
+        struct vector_space_object *map =
+            resize_vso( mapp, hashmap_payload_size( n * 2 ) );
+
+        if ( map != NULL ) {
+            payload = &map->payload.hashmap;
+            /* the new half of the slots is zeroed already */
+            memset( payload->slots, 0, sizeof( struct hashmap_slot ) * n );
+            payload->n_slots = n * 2;
+
+            for ( uint32_t i = 0; i < n; i++ ) {
+                if ( !nilp( old[i].key ) ) {
+                    place_slot( payload, old[i] );
+                }
+            }
+        }
+
+        free( old );
+    }
+}
+
+/**
+ * Store this `val` as the value of this `key` in this hashmap `mapp`,
+ * replacing any value the key already had. If
  * current user is authorised to write to this hashmap, modifies the hashmap and
  * returns it; if not, clones the hashmap, modifies the clone, and returns that.
  */
 struct cons_pointer hashmap_put( struct cons_pointer mapp,
                                  struct cons_pointer key,
                                  struct cons_pointer val ) {
-    if ( hashmapp( mapp ) && !nilp( key ) ) {
+    if ( hamtp( mapp ) ) {
+        mapp = hamt_put( mapp, key, val );
+    } else if ( hashmapp( mapp ) && !nilp( key ) ) {
         struct vector_space_object *map = pointer_to_vso( mapp );
 
         if ( nilp( authorised( mapp, map->payload.hashmap.write_acl ) ) ) {
             mapp = clone_hashmap( mapp );
             map = pointer_to_vso( mapp );
         }
-        uint32_t bucket_no = get_hash( key ) % map->payload.hashmap.n_buckets;
 
-        // TODO: if there are too many values in the bucket, rehash the whole 
-        // hashmap to a bigger number of buckets, and return that.
+        uint32_t hash = get_hash( key );
+        struct hashmap_slot *slot =
+            hashmap_find_slot( &map->payload.hashmap, key, hash );
+
+        if ( slot != NULL ) {
+            struct cons_pointer old = slot->value;
+
+            slot->value = inc_ref( val );
+            dec_ref( old );
+        } else {
+            if ( ( ( uint64_t ) map->payload.hashmap.count + 1 ) * 100 >
+                 ( uint64_t ) map->payload.hashmap.n_slots *
+                 HASHMAP_MAX_LOAD_PERCENT ) {
+                /* doubling keeps the cost of a put constant, amortised */
+                rehash_hashmap( mapp );
+                map = pointer_to_vso( mapp );
+            }
 
-        map->payload.hashmap.buckets[bucket_no] =
-            make_cons( make_cons( key, val ),
-                       map->payload.hashmap.buckets[bucket_no] );
+            if ( map->payload.hashmap.count < map->payload.hashmap.n_slots ) {
+                struct hashmap_slot entry = {
+                    .key = inc_ref( key ),
+                    .value = inc_ref( val ),
+                    .hash = hash
+                };
+
+                place_slot( &map->payload.hashmap, entry );
+                map->payload.hashmap.count++;
+            } else {
+                debug_print( L"hashmap_put: no room, and could not grow\n",
+                             DEBUG_BIND );
+            }
+        }
     }
 
     debug_print( L"hashmap_put:\n", DEBUG_BIND );
@@ -22,6 +22,7 @@
 
 #include <stdbool.h>
 
+struct hashmap_payload;
 
 extern struct cons_pointer privileged_symbol_nil;
 
@@ -33,6 +34,10 @@ void free_hashmap( struct cons_pointer ptr );
 
 void dump_map( URL_FILE * output, struct cons_pointer pointer );
 
+struct hashmap_slot *hashmap_find_slot( struct hashmap_payload *payload,
+                                        struct cons_pointer key,
+                                        uint32_t hash );
+
 struct cons_pointer hashmap_get( struct cons_pointer mapp,
                                  struct cons_pointer key, bool return_key );
 
@@ -45,7 +50,9 @@ struct cons_pointer hashmap_put_all( struct cons_pointer mapp,
 
 struct cons_pointer hashmap_keys( struct cons_pointer map );
 
-struct cons_pointer make_hashmap( uint32_t n_buckets,
+struct cons_pointer clone_hashmap( struct cons_pointer ptr );
+
+struct cons_pointer make_hashmap( uint32_t n_slots,
                                   struct cons_pointer hash_fn,
                                   struct cons_pointer write_acl );
 
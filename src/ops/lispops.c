@@ -24,17 +24,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arith/array.h"
 #include "arith/integer.h"
 #include "arith/peano.h"
 #include "debug.h"
 #include "io/io.h"
 #include "io/print.h"
 #include "io/read.h"
+#include "memory/bytes.h"
+#include "memory/collect.h"
 #include "memory/conspage.h"
 #include "memory/consspaceobject.h"
 #include "memory/stack.h"
+#include "memory/vector.h"
 #include "memory/vectorspace.h"
 #include "memory/dump.h"
+#include "memory/pstring.h"
 #include "ops/equal.h"
 #include "ops/intern.h"
 #include "ops/lispops.h"
@@ -60,7 +65,12 @@ struct cons_pointer prompt_name;
  * @param parent the parent stack frame.
  * @param form the form to be evaluated.
  * @param env the evaluation environment.
- * @return the result of evaluating the form.
+ * @return the result of evaluating the form, as a reference which the caller
+ * owns, and must release when done with it. So that this may be so, every
+ * function, primitive or not, likewise returns a reference which its caller
+ * owns: a value newly made is owned by whoever made it, but a function which
+ * returns one of its arguments, or any part of one, or any other value which
+ * is held elsewhere, must first `inc_ref` it.
  */
 struct cons_pointer eval_form( struct stack_frame *parent,
                                struct cons_pointer parent_pointer,
@@ -71,7 +81,7 @@ struct cons_pointer eval_form( struct stack_frame *parent,
     debug_println( DEBUG_EVAL );
 
     struct cons_pointer result = form;
-    switch ( pointer2cell( form ).tag.value ) {
+    switch ( pointer2tag( form ).value ) {
             /* things which evaluate to themselves */
         case EXCEPTIONTV:
         case FREETV:           // shouldn't happen, but anyway...
@@ -86,9 +96,13 @@ struct cons_pointer eval_form( struct stack_frame *parent,
         case TIMETV:
         case TRUETV:
         case WRITETV:
+            inc_ref( result );
             break;
         default:
-            {
+            if ( cons_space_exhausted ) {
+                /* unwind until the REPL can shed memory */
+                result = privileged_exception_memory_exhausted;
+            } else {
                 struct cons_pointer next_pointer =
                     make_empty_frame( parent_pointer );
 
@@ -137,9 +151,11 @@ struct cons_pointer eval_forms( struct stack_frame *frame,
     struct cons_pointer result = NIL;
 
     while ( consp( list ) ) {
-        result =
-            make_cons( eval_form( frame, frame_pointer, c_car( list ), env ),
-                       result );
+        struct cons_pointer val =
+            eval_form( frame, frame_pointer, c_car( list ), env );
+
+        result = make_cons( val, result );
+        dec_ref( val );
         list = c_cdr( list );
     }
 
@@ -189,21 +205,17 @@ struct cons_pointer lisp_try( struct stack_frame *frame,
 struct cons_pointer
 lisp_oblist( struct stack_frame *frame, struct cons_pointer frame_pointer,
              struct cons_pointer env ) {
-    return oblist;
+    return inc_ref( oblist );
 }
 
 /**
  * Used to construct the body for `lambda` and `nlambda` expressions.
  */
 struct cons_pointer compose_body( struct stack_frame *frame ) {
-    struct cons_pointer body = frame->more;
+    struct cons_pointer body = NIL;
 
-    for ( int i = args_in_frame - 1; i > 0; i-- ) {
-        if ( !nilp( body ) ) {
-            body = make_cons( frame->arg[i], body );
-        } else if ( !nilp( frame->arg[i] ) ) {
-            body = make_cons( frame->arg[i], body );
-        }
+    for ( int i = frame->args - 1; i > 0; i-- ) {
+        body = make_cons( frame->arg[i], body );
     }
 
     debug_print( L"compose_body returning ", DEBUG_LAMBDA );
@@ -275,16 +287,12 @@ eval_lambda( struct cons_space_object *cell, struct stack_frame *frame,
 
             names = c_cdr( names );
         }
-
-        /* \todo if there's more than `args_in_frame` arguments, bind those too. */
     } else if ( symbolp( names ) ) {
         /* if `names` is a symbol, rather than a list of symbols,
          * then bind a list of the values of args to that symbol. */
-        /* \todo eval all the things in frame->more */
-        struct cons_pointer vals =
-            eval_forms( frame, frame_pointer, frame->more, env );
+        struct cons_pointer vals = NIL;
 
-        for ( int i = args_in_frame - 1; i >= 0; i-- ) {
+        for ( int i = frame->args - 1; i >= 0; i-- ) {
             struct cons_pointer val =
                 eval_form( frame, frame_pointer, frame->arg[i], env );
 
@@ -292,6 +300,7 @@ eval_lambda( struct cons_space_object *cell, struct stack_frame *frame,
             } else {
                 vals = make_cons( val, vals );
             }
+            dec_ref( val );
         }
 
         new_env = set( names, vals, new_env );
@@ -347,6 +356,7 @@ struct cons_pointer maybe_fixup_exception_location( struct cons_pointer r,
         switch ( get_tag_value( payload ) ) {
             case NILTV:
             case CONSTV:
+            case HAMTTV:
             case HASHTV:
                 {
                     if ( nilp( c_assoc( privileged_keyword_location,
@@ -375,6 +385,96 @@ struct cons_pointer maybe_fixup_exception_location( struct cons_pointer r,
 }
 
 
+/**
+ * @return true if this list of `args` is short enough for every argument
+ * to have a slot of its own in a stack frame.
+ */
+static bool fits_in_frame( struct cons_pointer args ) {
+    int n = 0;
+
+    for ( ; consp( args ) && n <= args_in_frame; args = c_cdr( args ) ) {
+        n++;
+    }
+
+    return n <= args_in_frame;
+}
+
+/**
+ * Apply the primitive function at `fn_pointer` to the values of these
+ * `args`, which must fit in a stack frame, evaluated in this `env`. This is
+ * the commonest call of all, so the frame is built on the C stack, not in
+ * vector space, and the function is given the pointer of the calling
+ * frame, `frame_pointer`, as its own. Should the function throw an
+ * exception, a frame in vector space is made for the exception to hold on
+ * to, just as though it had been there all along. Between top level forms,
+ * when collections happen, no such frame is live.
+ */
+static struct cons_pointer apply_primitive( struct cons_pointer fn_pointer,
+                                            struct stack_frame *frame,
+                                            struct cons_pointer frame_pointer,
+                                            struct cons_pointer args,
+                                            struct cons_pointer env ) {
+    struct cons_pointer result = NIL;
+    union {
+        struct stack_frame frame;
+        char bytes[stack_frame_size( args_in_frame )];
+    } space;
+    struct stack_frame *next = &space.frame;
+
+    next->previous = frame_pointer;
+    next->depth = frame->depth + 1;
+    next->function = NIL;
+    next->args = 0;
+    next->slots = args_in_frame;
+    for ( int i = 0; i < args_in_frame; i++ ) {
+        next->arg[i] = NIL;
+    }
+
+    for ( ; consp( args ); args = c_cdr( args ) ) {
+        struct cons_pointer val =
+            eval_form( frame, frame_pointer, c_car( args ), env );
+
+        if ( exceptionp( val ) ) {
+            result = val;
+            break;
+        }
+        set_reg( next, next->args, val );
+        dec_ref( val );
+    }
+
+    if ( !exceptionp( result ) ) {
+        result =
+            ( *( pointer2cell( fn_pointer ).payload.function.executable ) )
+            ( next, frame_pointer, env );
+
+        if ( exceptionp( result ) &&
+             eq( pointer2cell( result ).payload.exception.frame,
+                 frame_pointer ) ) {
+            /* thrown by the function itself, which would have held on
+             * to its own frame, had there been one */
+            struct cons_pointer heap_pointer =
+                make_empty_frame( frame_pointer );
+
+            if ( !exceptionp( heap_pointer ) ) {
+                struct stack_frame *heap = get_stack_frame( heap_pointer );
+
+                for ( int i = 0; i < next->args; i++ ) {
+                    set_reg( heap, i, next->arg[i] );
+                }
+                pointer2cell( result ).payload.exception.frame =
+                    heap_pointer;
+                dec_ref( frame_pointer );
+            }
+        }
+
+        result = maybe_fixup_exception_location( result, fn_pointer );
+    }
+
+    free_stack_frame( next );
+
+    return result;
+}
+
 /**
  * Internal guts of apply.
  * @param frame the stack frame, expected to have only one argument, a list
@@ -404,7 +504,12 @@ c_apply( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 break;
 
             case FUNCTIONTV:
-                {
+                if ( fits_in_frame( args )
+                     && ( stack_limit == 0
+                          || stack_limit > frame->depth + 1 ) ) {
+                    result = apply_primitive( fn_pointer, frame,
+                                              frame_pointer, args, env );
+                } else {
                     struct cons_pointer exep = NIL;
                     struct cons_pointer next_pointer =
                         make_stack_frame( frame_pointer, args, env );
@@ -427,11 +532,14 @@ c_apply( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 break;
 
             case KEYTV:
-                result = c_assoc( fn_pointer,
-                                  eval_form( frame,
-                                             frame_pointer,
-                                             c_car( c_cdr( frame->arg[0] ) ),
-                                             env ) );
+                {
+                    struct cons_pointer store =
+                        eval_form( frame, frame_pointer,
+                                   c_car( c_cdr( frame->arg[0] ) ), env );
+
+                    result = inc_ref( c_assoc( fn_pointer, store ) );
+                    dec_ref( store );
+                }
                 break;
 
             case LAMBDATV:
@@ -454,14 +562,17 @@ c_apply( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 }
                 break;
 
+            case HAMTTV:
             case HASHTV:
                 /* \todo: if arg[0] is a CONS, treat it as a path */
-                result = c_assoc( eval_form( frame,
-                                             frame_pointer,
-                                             c_car( c_cdr
-                                                    ( frame->arg
-                                                      [0] ) ), env ),
-                                  fn_pointer );
+                {
+                    struct cons_pointer key =
+                        eval_form( frame, frame_pointer,
+                                   c_car( c_cdr( frame->arg[0] ) ), env );
+
+                    result = inc_ref( c_assoc( key, fn_pointer ) );
+                    dec_ref( key );
+                }
                 break;
 
             case NLAMBDATV:
@@ -507,7 +618,8 @@ c_apply( struct stack_frame *frame, struct cons_pointer frame_pointer,
                     memset( buffer, '\0', bs );
                     swprintf( buffer, bs,
                               L"Unexpected cell with tag %d (%4.4s) in function position",
-                              fn_cell->tag.value, &( fn_cell->tag.bytes[0] ) );
+                              pointer2tag( fn_pointer ).value,
+                              &( pointer2tag( fn_pointer ).bytes[0] ) );
                     struct cons_pointer message =
                         c_string_to_lisp_string( buffer );
                     free( buffer );
@@ -517,6 +629,7 @@ c_apply( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 }
         }
 
+        dec_ref( fn_pointer );
     }
 
     debug_print( L"c_apply: returning: ", DEBUG_EVAL );
@@ -553,9 +666,8 @@ lisp_eval( struct stack_frame *frame, struct cons_pointer frame_pointer,
     debug_dump_object( frame_pointer, DEBUG_EVAL );
 
     struct cons_pointer result = frame->arg[0];
-    struct cons_space_object *cell = &pointer2cell( frame->arg[0] );
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( frame->arg[0] ).value ) {
         case CONSTV:
             result = c_apply( frame, frame_pointer, env );
             break;
@@ -572,8 +684,7 @@ lisp_eval( struct stack_frame *frame, struct cons_pointer frame_pointer,
                         throw_exception( c_string_to_lisp_symbol( L"eval" ),
                                          message, frame_pointer );
                 } else {
-                    result = c_assoc( canonical, env );
-//                    inc_ref( result );
+                    result = inc_ref( c_assoc( canonical, env ) );
                 }
             }
             break;
@@ -584,7 +695,7 @@ lisp_eval( struct stack_frame *frame, struct cons_pointer frame_pointer,
              * H'mmm... this is working, but it isn't here. Where is it?
              */
         default:
-            result = frame->arg[0];
+            result = inc_ref( frame->arg[0] );
             break;
     }
 
@@ -640,7 +751,7 @@ lisp_apply( struct stack_frame *frame, struct cons_pointer frame_pointer,
 struct cons_pointer
 lisp_quote( struct stack_frame *frame, struct cons_pointer frame_pointer,
             struct cons_pointer env ) {
-    return frame->arg[0];
+    return inc_ref( frame->arg[0] );
 }
 
 
@@ -668,7 +779,7 @@ lisp_set( struct stack_frame *frame, struct cons_pointer frame_pointer,
 
     if ( symbolp( frame->arg[0] ) ) {
         deep_bind( frame->arg[0], frame->arg[1] );
-        result = frame->arg[1];
+        result = inc_ref( frame->arg[1] );
     } else {
         result =
             throw_exception( c_string_to_lisp_symbol( L"set" ),
@@ -760,6 +871,9 @@ lisp_cons( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 end_of_stringp( c_cdr( car ) ) ) {
         result =
             make_string( pointer2cell( car ).payload.string.character, cdr );
+    } else if ( any_stringp( car ) && pstringp( cdr ) &&
+                string_length( car ) == 1 ) {
+        result = string_append( car, cdr );
     } else {
         result = make_cons( car, cdr );
     }
@@ -786,9 +900,9 @@ lisp_car( struct stack_frame *frame, struct cons_pointer frame_pointer,
     struct cons_pointer result = NIL;
     struct cons_space_object *cell = &pointer2cell( frame->arg[0] );
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( frame->arg[0] ).value ) {
         case CONSTV:
-            result = cell->payload.cons.car;
+            result = inc_ref( cell->payload.cons.car );
             break;
         case NILTV:
             break;
@@ -799,6 +913,12 @@ lisp_car( struct stack_frame *frame, struct cons_pointer frame_pointer,
         case STRINGTV:
             result = make_string( cell->payload.string.character, NIL );
             break;
+        case VECTORPOINTTV:
+            if ( pstringp( frame->arg[0] ) ) {
+                result = pstring_get( frame->arg[0], 0 );
+                break;
+            }
+            /* else fall through */
         default:
             result =
                 throw_exception( c_string_to_lisp_symbol( L"car" ),
@@ -831,19 +951,29 @@ lisp_cdr( struct stack_frame *frame, struct cons_pointer frame_pointer,
     struct cons_pointer result = NIL;
     struct cons_space_object *cell = &pointer2cell( frame->arg[0] );
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( frame->arg[0] ).value ) {
         case CONSTV:
-            result = cell->payload.cons.cdr;
+            result = inc_ref( cell->payload.cons.cdr );
             break;
         case NILTV:
             break;
         case READTV:
             url_fgetwc( cell->payload.stream.stream );
-            result = frame->arg[0];
+            result = inc_ref( frame->arg[0] );
             break;
         case STRINGTV:
-            result = cell->payload.string.cdr;
+            result = inc_ref( cell->payload.string.cdr );
             break;
+        case VECTORPOINTTV:
+            if ( pstringp( frame->arg[0] ) ) {
+                /* walking a packed string a cell at a time needs cells */
+                struct cons_pointer cells = pstring_cells( frame->arg[0] );
+
+                result = inc_ref( pointer2cell( cells ).payload.string.cdr );
+                dec_ref( cells );
+                break;
+            }
+            /* else fall through */
         default:
             result =
                 throw_exception( c_string_to_lisp_symbol( L"cdr" ),
@@ -885,8 +1015,9 @@ struct cons_pointer lisp_length( struct stack_frame *frame,
 struct cons_pointer
 lisp_assoc( struct stack_frame *frame, struct cons_pointer frame_pointer,
             struct cons_pointer env ) {
-    return c_assoc( frame->arg[0],
-                    nilp( frame->arg[1] ) ? oblist : frame->arg[1] );
+    return inc_ref( c_assoc( frame->arg[0],
+                             nilp( frame->arg[1] ) ? oblist :
+                             frame->arg[1] ) );
 }
 
 /**
@@ -995,10 +1126,9 @@ lisp_equal( struct stack_frame *frame, struct cons_pointer frame_pointer,
 }
 
 long int c_count( struct cons_pointer p ) {
-    struct cons_space_object *cell = &pointer2cell( p );
     int result = 0;
 
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( p ).value ) {
         case CONSTV:
         case STRINGTV:
             /* I think doctrine is that you cannot treat symbols or keywords as
@@ -1008,6 +1138,18 @@ long int c_count( struct cons_pointer p ) {
             for ( p; !nilp( p ); p = c_cdr( p ) ) {
                 result++;
             }
+            break;
+        case VECTORPOINTTV:
+            if ( vectorp( p ) ) {
+                result = vector_length( p );
+            } else if ( pstringp( p ) ) {
+                result = pstring_length( p );
+            } else if ( bytesp( p ) ) {
+                result = bytes_length( p );
+            } else {
+                result = numeric_array_length( p );
+            }
+            break;
     }
 
     return result;
@@ -1032,6 +1174,59 @@ lisp_count( struct stack_frame *frame, struct cons_pointer frame_pointer,
     return acquire_integer( c_count( frame->arg[0] ), NIL );
 }
 
+/**
+ * Function: return the `n`th member of this `sequence`, counting from one,
+ * or `nil` if it has none. The member of a vector, numeric array, packed
+ * string or byte buffer is got at directly; that of a list by walking down
+ * it.
+ *
+ * * (nth n sequence)
+ *
+ * @param frame my stack_frame.
+ * @param frame_pointer a pointer to my stack_frame.
+ * @param env my environment (ignored).
+ * @return the `n`th member of `sequence`, or `nil`.
+ * @exception if `n` is not an integer.
+ */
+struct cons_pointer
+lisp_nth( struct stack_frame *frame, struct cons_pointer frame_pointer,
+          struct cons_pointer env ) {
+    struct cons_pointer result = NIL;
+
+    if ( !integerp( frame->arg[0] ) ) {
+        result = throw_exception( c_string_to_lisp_symbol( L"nth" ),
+                                  c_string_to_lisp_string
+                                  ( L"First argument to `nth` must be an integer" ),
+                                  frame_pointer );
+    } else {
+        struct integer_payload *n_cell =
+            &pointer2cell( frame->arg[0] ).payload.integer;
+        int64_t n = n_cell->value;
+
+        /* a bignum is longer than any sequence there is room for */
+        if ( n > 0 && nilp( n_cell->more ) ) {
+            if ( vectorp( frame->arg[1] ) ) {
+                result = inc_ref( vector_get( frame->arg[1], n - 1 ) );
+            } else if ( numeric_arrayp( frame->arg[1] ) ) {
+                result = numeric_array_get( frame->arg[1], n - 1 );
+            } else if ( pstringp( frame->arg[1] ) ) {
+                result = pstring_get( frame->arg[1], n - 1 );
+            } else if ( bytesp( frame->arg[1] ) ) {
+                result = bytes_get( frame->arg[1], n - 1 );
+            } else {
+                struct cons_pointer c = frame->arg[1];
+
+                for ( ; n > 1 && consp( c ); n-- ) {
+                    c = c_cdr( c );
+                }
+                result = consp( c ) ? inc_ref( c_car( c ) ) : NIL;
+            }
+        }
+    }
+
+    return result;
+}
+
 /**
  * Function; read one complete lisp form and return it. If read-stream is specified and
  * is a read stream, then read from that stream, else the stream which is the value of
@@ -1090,10 +1285,12 @@ lisp_read( struct stack_frame *frame, struct cons_pointer frame_pointer,
 struct cons_pointer c_reverse( struct cons_pointer arg ) {
     struct cons_pointer result = NIL;
 
-    if ( sequencep( arg ) ) {
+    if ( pstringp( arg ) ) {
+        result = pstring_reverse( arg );
+    } else if ( sequencep( arg ) ) {
         for ( struct cons_pointer p = arg; sequencep( p ); p = c_cdr( p ) ) {
             struct cons_space_object o = pointer2cell( p );
-            switch ( o.tag.value ) {
+            switch ( pointer2tag( p ).value ) {
                 case CONSTV:
                     result = make_cons( o.payload.cons.car, result );
                     break;
@@ -1128,7 +1325,10 @@ struct cons_pointer c_reverse( struct cons_pointer arg ) {
 struct cons_pointer lisp_reverse( struct stack_frame *frame,
                                   struct cons_pointer frame_pointer,
                                   struct cons_pointer env ) {
-    return c_reverse( frame->arg[0] );
+    struct cons_pointer result = c_reverse( frame->arg[0] );
+
+    /* what is not a sequence is given back as it is */
+    return eq( result, frame->arg[0] ) ? inc_ref( result ) : result;
 }
 
 /**
@@ -1179,12 +1379,30 @@ struct cons_pointer lisp_inspect( struct stack_frame *frame,
  * @param frame my stack frame.
  * @param frame_pointer a pointer to my stack_frame.
  * @param env my environment (ignored).
- * @return As a Lisp string, the tag of `expression`.
+ * @return As a Lisp string, the tag of `expression`. A packed string is
+ * held differently from a string made of cells, and a persistent hashmap
+ * from a hashtable, but each is the same type of thing as the other, so
+ * their tags are given as `STRG` and `HASH` respectively.
  */
 struct cons_pointer
 lisp_type( struct stack_frame *frame, struct cons_pointer frame_pointer,
            struct cons_pointer env ) {
-    return c_type( frame->arg[0] );
+    struct cons_pointer result = NIL;
+    char *tag = pstringp( frame->arg[0] ) ? STRINGTAG :
+        hamtp( frame->arg[0] ) ? HASHTAG : NULL;
+
+    if ( tag != NULL ) {
+        /* terminated with the null character, as c_type does */
+        result = make_string( ( wchar_t ) 0, NIL );
+
+        for ( int i = TAGLENGTH - 1; i >= 0; i-- ) {
+            result = make_string( ( wchar_t ) tag[i], result );
+        }
+    } else {
+        result = c_type( frame->arg[0] );
+    }
+
+    return result;
 }
 
 /**
@@ -1227,7 +1445,7 @@ lisp_progn( struct stack_frame *frame, struct cons_pointer frame_pointer,
             struct cons_pointer env ) {
     struct cons_pointer result = NIL;
 
-    for ( int i = 0; i < args_in_frame && !nilp( frame->arg[i] ); i++ ) {
+    for ( int i = 0; i < frame->args; i++ ) {
         struct cons_pointer r = result;
 
         result = eval_form( frame, frame_pointer, frame->arg[i], env );
@@ -1235,10 +1453,6 @@ lisp_progn( struct stack_frame *frame, struct cons_pointer frame_pointer,
         dec_ref( r );
     }
 
-    if ( consp( frame->more ) ) {
-        result = c_progn( frame, frame_pointer, frame->more, env );
-    }
-
     return result;
 }
 
@@ -1264,10 +1478,11 @@ struct cons_pointer eval_cond_clause( struct cons_pointer clause,
                        env );
 
         if ( !nilp( val ) ) {
-            result =
-                make_cons( TRUE,
-                           c_progn( frame, frame_pointer, c_cdr( clause ),
-                                    env ) );
+            struct cons_pointer action =
+                c_progn( frame, frame_pointer, c_cdr( clause ), env );
+
+            result = make_cons( TRUE, action );
+            dec_ref( action );
 
 #ifdef DEBUG
             debug_print( L"\n\t\tCond clause ", DEBUG_EVAL );
@@ -1281,6 +1496,9 @@ struct cons_pointer eval_cond_clause( struct cons_pointer clause,
             debug_print( L" failed.\n", DEBUG_EVAL );
 #endif
         }
+        if ( !exceptionp( val ) ) {
+            dec_ref( val );
+        }
     } else {
         result = throw_exception( c_string_to_lisp_symbol( L"cond" ),
                                   c_string_to_lisp_string
@@ -1316,7 +1534,10 @@ lisp_cond( struct stack_frame *frame, struct cons_pointer frame_pointer,
         result = eval_cond_clause( clause_pointer, frame, frame_pointer, env );
 
         if ( !nilp( result ) && truep( c_car( result ) ) ) {
-            result = c_cdr( result );
+            struct cons_pointer pair = result;
+
+            result = inc_ref( c_cdr( pair ) );
+            dec_ref( pair );
             done = true;
             break;
         }
@@ -1359,9 +1580,8 @@ struct cons_pointer throw_exception_with_cause( struct cons_pointer location,
         debug_print( L"`\n", 511 );
     }
 #endif
-    struct cons_space_object *cell = &pointer2cell( message );
 
-    if ( cell->tag.value == EXCEPTIONTV ) {
+    if ( pointer2tag( message ).value == EXCEPTIONTV ) {
         result = message;
     } else {
         result =
@@ -1422,7 +1642,7 @@ lisp_exception( struct stack_frame *frame, struct cons_pointer frame_pointer,
                 struct cons_pointer env ) {
     struct cons_pointer message = frame->arg[0];
 
-    return exceptionp( message ) ? message :
+    return exceptionp( message ) ? inc_ref( message ) :
         throw_exception_with_cause( message, frame->arg[1], frame->arg[2],
                                     frame->previous );
 }
@@ -1529,8 +1749,22 @@ struct cons_pointer lisp_repl( struct stack_frame *frame,
             print( os, prompt );
         }
 
-        expr = lisp_read( get_stack_frame( frame_pointer ), frame_pointer,
-                          new_env );
+        /* between top level forms is a safe point at which to collect */
+        maybe_collect_cycles(  );
+
+        if ( nilp( frame->previous ) ) {
+            /* and at the outermost REPL, nothing is live which is not
+             * reachable from these */
+            struct cons_pointer roots[] =
+                { frame_pointer, env, new_env, input, output };
+            maybe_mark_sweep( roots, 5 );
+            relieve_memory_pressure( roots, 5 );
+        }
+
+        /* and to give back memory which is no longer needed */
+        release_empty_cons_pages(  );
+
+        expr = lisp_read( frame, frame_pointer, new_env );
 
         if ( exceptionp( expr )
              && url_feof( pointer2cell( input ).payload.stream.stream ) ) {
@@ -1541,8 +1775,14 @@ struct cons_pointer lisp_repl( struct stack_frame *frame,
 
         println( os );
 
-        print( os, eval_form( frame, frame_pointer, expr, new_env ) );
+        struct cons_pointer value =
+            eval_form( frame, frame_pointer, expr, new_env );
 
+        print( os, value );
+
+        if ( !exceptionp( value ) ) {
+            dec_ref( value );
+        }
         dec_ref( expr );
     }
 
@@ -1577,12 +1817,14 @@ struct cons_pointer lisp_source( struct stack_frame *frame,
     struct cons_pointer result = NIL;
     struct cons_space_object *cell = &pointer2cell( frame->arg[0] );
     struct cons_pointer source_key = c_string_to_lisp_keyword( L"source" );
-    switch ( cell->tag.value ) {
+    switch ( pointer2tag( frame->arg[0] ).value ) {
         case FUNCTIONTV:
-            result = c_assoc( source_key, cell->payload.function.meta );
+            result = inc_ref( c_assoc( source_key,
+                                       cell->payload.function.meta ) );
             break;
         case SPECIALTV:
-            result = c_assoc( source_key, cell->payload.special.meta );
+            result = inc_ref( c_assoc( source_key,
+                                       cell->payload.special.meta ) );
             break;
         case LAMBDATV:
             result = make_cons( c_string_to_lisp_symbol( L"lambda" ),
@@ -1595,8 +1837,6 @@ struct cons_pointer lisp_source( struct stack_frame *frame,
                                            cell->payload.lambda.body ) );
             break;
     }
-    // \todo suffers from premature GC, and I can't see why!
-    inc_ref( result );
 
     return result;
 }
@@ -1605,9 +1845,14 @@ struct cons_pointer lisp_source( struct stack_frame *frame,
  * A version of append which can conveniently be called from C.
  */
 struct cons_pointer c_append( struct cons_pointer l1, struct cons_pointer l2 ) {
-    switch ( pointer2cell( l1 ).tag.value ) {
+    if ( ( pstringp( l1 ) && any_stringp( l2 ) ) ||
+         ( stringp( l1 ) && pstringp( l2 ) ) ) {
+        return string_append( l1, l2 );
+    }
+
+    switch ( pointer2tag( l1 ).value ) {
         case CONSTV:
-            if ( pointer2cell( l1 ).tag.value == pointer2cell( l2 ).tag.value ) {
+            if ( pointer2tag( l1 ).value == pointer2tag( l2 ).value ) {
                 if ( nilp( c_cdr( l1 ) ) ) {
                     return make_cons( c_car( l1 ), l2 );
                 } else {
@@ -1623,19 +1868,19 @@ struct cons_pointer c_append( struct cons_pointer l1, struct cons_pointer l2 ) {
         case KEYTV:
         case STRINGTV:
         case SYMBOLTV:
-            if ( pointer2cell( l1 ).tag.value == pointer2cell( l2 ).tag.value ) {
+            if ( pointer2tag( l1 ).value == pointer2tag( l2 ).value ) {
                 if ( nilp( c_cdr( l1 ) ) ) {
                     return
                         make_string_like_thing( ( pointer2cell( l1 ).
                                                   payload.string.character ),
                                                 l2,
-                                                pointer2cell( l1 ).tag.value );
+                                                pointer2tag( l1 ).value );
                 } else {
                     return
                         make_string_like_thing( ( pointer2cell( l1 ).
                                                   payload.string.character ),
                                                 c_append( c_cdr( l1 ), l2 ),
-                                                pointer2cell( l1 ).tag.value );
+                                                pointer2tag( l1 ).value );
                 }
             } else {
                 throw_exception( c_string_to_lisp_symbol( L"append" ),
@@ -1643,6 +1888,19 @@ struct cons_pointer c_append( struct cons_pointer l1, struct cons_pointer l2 ) {
                                  ( L"Can't append: not same type" ), NIL );
             }
             break;
+        case VECTORPOINTTV:
+            if ( vectorp( l1 ) && vectorp( l2 ) ) {
+                return vector_append( l1, l2 );
+            } else {
+                return
+                    throw_exception( c_string_to_lisp_symbol( L"append" ),
+                                     c_string_to_lisp_string
+                                     ( vectorp( l1 ) ?
+                                       L"Can't append: not same type" :
+                                       L"Can't append: not a sequence" ),
+                                     NIL );
+            }
+            break;
         default:
             throw_exception( c_string_to_lisp_symbol( L"append" ),
                              c_string_to_lisp_string
@@ -1659,6 +1917,11 @@ struct cons_pointer lisp_append( struct stack_frame *frame,
                                  struct cons_pointer env ) {
     struct cons_pointer result = fetch_arg( frame, ( frame->args - 1 ) );
 
+    if ( frame->args < 2 ) {
+        /* there is nothing to append to it, so it is given back as it is */
+        inc_ref( result );
+    }
+
     for ( int a = frame->args - 2; a >= 0; a-- ) {
         result = c_append( fetch_arg( frame, a ), result );
     }
@@ -1666,9 +1929,44 @@ struct cons_pointer lisp_append( struct stack_frame *frame,
     return result;
 }
 
+/**
+ * Apply the function which is the first argument in this `frame` to each
+ * element of the vector which is the second, and return a vector of the
+ * results; or the first exception, if any application returns one.
+ */
+static struct cons_pointer mapcar_vector( struct stack_frame *frame,
+                                          struct cons_pointer frame_pointer,
+                                          struct cons_pointer env ) {
+    uint64_t length = vector_length( frame->arg[1] );
+    struct cons_pointer result = make_vector( length );
+
+    for ( uint64_t i = 0; i < length && vectorp( result ); i++ ) {
+        struct cons_pointer expr =
+            make_cons( frame->arg[0],
+                       make_cons( vector_get( frame->arg[1], i ), NIL ) );
+        struct cons_pointer r = eval_form( frame, frame_pointer, expr, env );
+
+        if ( exceptionp( r ) ) {
+            dec_ref( result );
+            result = r;
+            inc_ref( expr );    // to protect exception from the later dec_ref
+        } else {
+            vector_payload( result )->elements[i] = r;
+        }
+
+        dec_ref( expr );
+    }
+
+    return result;
+}
+
 struct cons_pointer lisp_mapcar( struct stack_frame *frame,
                                  struct cons_pointer frame_pointer,
                                  struct cons_pointer env ) {
+    if ( vectorp( frame->arg[1] ) ) {
+        return mapcar_vector( frame, frame_pointer, env );
+    }
+
     struct cons_pointer result = NIL;
     debug_print( L"Mapcar: ", DEBUG_EVAL );
     debug_dump_object( frame_pointer, DEBUG_EVAL );
@@ -1690,6 +1988,7 @@ struct cons_pointer lisp_mapcar( struct stack_frame *frame,
             break;
         } else {
             result = make_cons( r, result );
+            dec_ref( r );
         }
         debug_printf( DEBUG_EVAL, L"Mapcar %d, result is ", i++ );
         debug_print_object( result, DEBUG_EVAL );
@@ -1718,11 +2017,13 @@ struct cons_pointer lisp_mapcar( struct stack_frame *frame,
 struct cons_pointer lisp_list( struct stack_frame *frame,
                                struct cons_pointer frame_pointer,
                                struct cons_pointer env ) {
-    struct cons_pointer result = frame->more;
+    struct cons_pointer result = NIL;
+
+    for ( int a = frame->args - 1; a >= 0; a-- ) {
+        struct cons_pointer tail = result;
 
-    for ( int a = nilp( result ) ? frame->args - 1 : args_in_frame - 1;
-          a >= 0; a-- ) {
-        result = make_cons( fetch_arg( frame, a ), result );
+        result = make_cons( frame->arg[a], tail );
+        dec_ref( tail );
     }
 
     return result;
@@ -1753,7 +2054,15 @@ struct cons_pointer lisp_let( struct stack_frame *frame,
 
             debug_print_binding( symbol, val, false, DEBUG_BIND );
 
-            bindings = make_cons( make_cons( symbol, val ), bindings );
+            struct cons_pointer binding = make_cons( symbol, val );
+            struct cons_pointer more = make_cons( binding, bindings );
+
+            dec_ref( binding );
+            dec_ref( val );
+            if ( !eq( bindings, env ) ) {
+                dec_ref( bindings );
+            }
+            bindings = more;
         } else {
             result =
                 throw_exception( c_string_to_lisp_symbol( L"let" ),
@@ -1768,16 +2077,20 @@ struct cons_pointer lisp_let( struct stack_frame *frame,
 
     /* i.e., no exception yet */
     for ( int form = 1; !exceptionp( result ) && form < frame->args; form++ ) {
+        struct cons_pointer r = result;
+
         result =
             eval_form( frame, frame_pointer, fetch_arg( frame, form ),
                        bindings );
+        dec_ref( r );
     }
 
-    /* release the local bindings as they go out of scope! **BUT** 
-     * bindings were consed onto the front of env, so caution... */
-    // for (struct cons_pointer cursor = bindings; !eq( cursor, env); cursor = c_cdr(cursor)) {
-    //     dec_ref( cursor);
-    // }
+    /* release the local bindings as they go out of scope; they were consed
+     * onto the front of env, which is not ours to release, but each holds
+     * only the one below it, so releasing the topmost releases them all. */
+    if ( !eq( bindings, env ) ) {
+        dec_ref( bindings );
+    }
 
     return result;
 
@@ -1795,7 +2108,6 @@ struct cons_pointer lisp_and( struct stack_frame *frame,
                               struct cons_pointer frame_pointer,
                               struct cons_pointer env ) {
     bool accumulator = true;
-    struct cons_pointer result = frame->more;
 
     for ( int a = 0; accumulator == true && a < frame->args; a++ ) {
         accumulator = truthy( fetch_arg( frame, a ) );
@@ -1816,7 +2128,6 @@ struct cons_pointer lisp_or( struct stack_frame *frame,
                              struct cons_pointer frame_pointer,
                              struct cons_pointer env ) {
     bool accumulator = false;
-    struct cons_pointer result = frame->more;
 
     for ( int a = 0; accumulator == false && a < frame->args; a++ ) {
         accumulator = truthy( fetch_arg( frame, a ) );
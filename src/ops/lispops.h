@@ -152,6 +152,9 @@ struct cons_pointer lisp_reverse( struct stack_frame *frame,
 struct cons_pointer
 lisp_count( struct stack_frame *frame, struct cons_pointer frame_pointer,
             struct cons_pointer env );
+struct cons_pointer
+lisp_nth( struct stack_frame *frame, struct cons_pointer frame_pointer,
+          struct cons_pointer env );
 
 /**
  * Function: Get the Lisp type of the single argument.
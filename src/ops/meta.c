@@ -25,7 +25,7 @@ struct cons_pointer lisp_metadata( struct stack_frame *frame,
     struct cons_pointer result = NIL;
     struct cons_space_object cell = pointer2cell( frame->arg[0] );
 
-    switch ( cell.tag.value ) {
+    switch ( pointer2tag( frame->arg[0] ).value ) {
         case FUNCTIONTV:
             result = cell.payload.function.meta;
             break;
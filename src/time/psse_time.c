@@ -60,7 +60,9 @@ struct cons_pointer make_time( struct cons_pointer integer_or_nil ) {
     struct cons_pointer pointer = allocate_cell( TIMETV );
     struct cons_space_object *cell = &pointer2cell( pointer );
 
-    if ( integerp( integer_or_nil ) ) {
+    if ( exceptionp( pointer ) ) {
+        /* memory is exhausted */
+    } else if ( integerp( integer_or_nil ) ) {
         cell->payload.time.value =
             pointer2cell( integer_or_nil ).payload.integer.value;
     } else {
@@ -0,0 +1,110 @@
+#!/bin/bash
+
+result=0
+tmp=tmp/bytes.$$
+echo "hi" > ${tmp}
+
+echo -n "$0: read a file as bytes... "
+
+expected='#b[104 105 10]'
+actual=`echo "(read-bytes (open \"${tmp}\"))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: read some bytes of a file... "
+
+expected='#b[104 105]'
+actual=`echo "(read-bytes (open \"${tmp}\") 2)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: convert bytes to a string... "
+
+expected='"hi"'
+actual=`echo "(bytes->string (read-bytes (open \"${tmp}\") 2))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: convert a string to bytes... "
+
+expected='#b[97 98 99]'
+actual=`echo "(string->bytes \"abc\")" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: slice a slice of bytes... "
+
+expected='"cde"'
+actual=`echo "(bytes->string (byte-slice (byte-slice (string->bytes \"abcdefg\") 1 5) 1 3))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: count and nth of bytes... "
+
+expected='(3 98)'
+actual=`echo "(list (count (string->bytes \"abc\")) (nth 2 (string->bytes \"abc\")))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: write bytes to a file... "
+
+expected='3'
+actual=`echo "(write-bytes (read-bytes (open \"${tmp}\")) (open \"${tmp}.out\" t))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: bytes written are those read... "
+
+if cmp -s ${tmp} ${tmp}.out
+then
+    echo "OK"
+else
+    echo "Fail: ${tmp}.out differs from ${tmp}"
+    result=`echo "${result} + 1" | bc`
+fi
+
+rm -f ${tmp} ${tmp}.out
+
+exit ${result}
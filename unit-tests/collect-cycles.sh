@@ -0,0 +1,32 @@
+#!/bin/bash
+
+result=0
+
+#####################################################################
+# Explicit cycle collection returns the number of cells recovered
+echo -n "$0: collect-cycles returns a count... "
+actual=`echo "(collect-cycles)" | target/psse 2>/dev/null | tail -1`
+
+if [[ "${actual}" =~ ^[0-9,]+$ ]]
+then
+    echo "OK"
+else
+    echo "Fail: expected a number, got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# Evaluation still works after collecting
+expected='6'
+actual=`echo "(collect-cycles) (+ 1 2 3) (collect-cycles) (+ 1 2 3)" | target/psse -g 1 2>/dev/null | tail -1`
+
+echo -n "$0: evaluation after collection... "
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+exit ${result}
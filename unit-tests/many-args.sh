@@ -27,4 +27,28 @@ else
     result=`echo "${result} + 1" | bc`
 fi
 
+echo -n "$0: a lambda binds all of ten parameters... "
+expected="(10 9 1)"
+actual=`echo "((lambda (a b c d e f g h i j) (list j i a)) 1 2 3 4 5 6 7 8 9 10)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: cond reaches its ninth clause... "
+expected="9"
+actual=`echo "(cond (nil 1) (nil 2) (nil 3) (nil 4) (nil 5) (nil 6) (nil 7) (nil 8) (t 9))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
 exit ${result}
@@ -34,7 +34,7 @@ fi
 # Create a map using map notation: order of keys in output is not
 # significant at this stage, but in the long term should be sorted
 # alphanumerically
-expected='{:one 1, :two 2, :three 3}'
+expected='{:two 2, :three 3, :one 1}'
 actual=`echo "{:one 1 :two 2 :three 3}" | target/psse 2>/dev/null | tail -1`
 
 echo -n "$0: Map using map notation... "
@@ -50,7 +50,7 @@ fi
 # Create a map using make-map: order of keys in output is not
 # significant at this stage, but in the long term should be sorted
 # alphanumerically
-expected='{:one 1, :two 2, :three 3}'
+expected='{:two 2, :three 3, :one 1}'
 actual=`echo "(hashmap nil nil '((:one . 1)(:two . 2)(:three . 3)))" |\
     target/psse 2>/dev/null | tail -1`
 
@@ -92,4 +92,70 @@ else
     result=1
 fi
 
-exit ${result}
\ No newline at end of file
+#####################################################################
+# A map grows as keys are put into it, and keeps them all; putting a
+# key which is already there replaces its value in the map given
+pairs=`for i in $(seq 1 1000); do echo -n ":k$i $i "; done`
+expected='(1,000 100 7 1,000)'
+actual=`echo "(set! m {${pairs}}) (set! n (put! m :k100 7)) (list (count (keys n)) (:k100 m) (:k100 n) (:k1000 n))" |\
+    target/psse 2>/dev/null | tail -1`
+
+echo -n "$0: Map rehashed as it grows... "
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# Maps with the same pairs, put in different orders, are equal, and a
+# key which is not in a map has no value there
+expected='(t nil nil)'
+actual=`echo "(list (= {:a 1 :b 2} {:b 2 :a 1}) (= {:a 1 :b 2} {:a 1 :b 3}) (:c {:a 1 :b 2}))" |\
+    target/psse 2>/dev/null | tail -1`
+
+echo -n "$0: Map equality and absent keys... "
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# A map literal is persistent, but is still of type HASH; keys whose
+# hashes collide are kept apart, and maps holding them compare equal
+# whatever order they were put in
+expected='("HASH" {1 :a, 4,294,967,297 :b} t)'
+actual=`echo "(list (type {}) (put! (put! {} 1 :a) 4294967297 :b) (= (put! (put! {} 1 :a) 4294967297 :b) (put! (put! {} 4294967297 :b) 1 :a)))" |\
+    target/psse 2>/dev/null | tail -1`
+
+echo -n "$0: Persistent map with colliding hashes... "
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# A map literal has no write ACL, so may be written by nobody: putting a
+# key into it gives a new map, and leaves it as it was
+expected='({:b 2, :a 1} {:b 2, :a 1, :c 3})'
+actual=`echo "(set! m {:a 1 :b 2}) (set! n (put! m :c 3)) (list m n)" |\
+    target/psse 2>/dev/null | tail -1`
+
+echo -n "$0: Putting to a map literal leaves it unchanged... "
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+exit ${result}
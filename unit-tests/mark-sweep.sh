@@ -0,0 +1,33 @@
+#!/bin/bash
+
+result=0
+
+#####################################################################
+# Evaluation is unaffected by managing memory by mark-sweep rather than
+# by reference counting, even when collecting between every form
+expected='3628800'
+actual=`echo "(set! fact (lambda (n) \"Factorial\" (cond ((= n 1) 1) (t (* n (fact (- n 1))))))) (fact 5) (fact 10)" | target/psse -M -g 1 -c 64 2>/dev/null | tail -1`
+
+echo -n "$0: factorial under mark-sweep... "
+if [ "${expected}" = "${actual//,/}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# Garbage is actually recovered
+echo -n "$0: mark-sweep recovers cells... "
+recovered=`echo "(set! fact (lambda (n) (cond ((= n 1) 1) (t (* n (fact (- n 1))))))) (fact 20) (fact 20) (fact 20)" | target/psse -M -g 1 -c 64 -S 2>&1 >/dev/null | grep 'Mark-sweep summary' | sed 's/.*recovered \([0-9]*\).*/\1/'`
+
+if [ -n "${recovered}" ] && [ "${recovered}" -gt 0 ]
+then
+    echo "OK"
+else
+    echo "Fail: expected some cells to be recovered, got '${recovered}'"
+    result=1
+fi
+
+exit ${result}
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+result=0
+
+build='(set! build (lambda (n acc) (cond ((= n 0) acc) (t (build (- n 1) (cons n acc))))))'
+
+#####################################################################
+# Exhausting cons space returns an exception rather than killing the
+# session, which then recovers once the garbage has been collected
+echo -n "$0: exhausting cons space throws an exception... "
+output=`echo "${build} (build 3000 nil) (count (build 50 nil))" | target/psse -M -c 1024 -m 40 2>/dev/null`
+
+if echo "${output}" | grep -q 'Memory exhausted'
+then
+    echo "OK"
+else
+    echo "Fail: expected 'Memory exhausted' in '${output}'"
+    result=1
+fi
+
+echo -n "$0: the session survives exhaustion... "
+expected='50'
+actual=`echo "${output}" | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# Reading a list too long for cons space exhausts the reserve too, since
+# the reader does not stop to unwind; that also throws an exception,
+# rather than killing the session
+echo -n "$0: exhausting the reserve too throws an exception... "
+long=`for i in $(seq 60000); do echo -n "1 "; done`
+output=`echo "(count '(${long})) (count (list 1 2 3))" | target/psse -M -c 1024 -m 40 2>/dev/null`
+expected='3'
+actual=`echo "${output}" | tail -1`
+
+if echo "${output}" | grep -q 'Memory exhausted' && [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected 'Memory exhausted' then '${expected}' in '${output}'"
+    result=1
+fi
+
+#####################################################################
+# Passing the soft limit sheds memory between top level forms
+echo -n "$0: the soft limit sheds memory... "
+released=`echo "${build} (count (build 50 nil)) (count (build 50 nil))" | target/psse -M -c 1024 -g 0 -l 12 -S 2>&1 >/dev/null | grep 'Cons page summary' | sed 's/.*releases \([0-9]*\).*/\1/'`
+
+if [ -n "${released}" ] && [ "${released}" -gt 0 ]
+then
+    echo "OK"
+else
+    echo "Fail: expected some pages to be released, got '${released}'"
+    result=1
+fi
+
+exit ${result}
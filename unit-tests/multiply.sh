@@ -28,4 +28,17 @@ else
     result=`echo "${result} + 1" | bc`
 fi
 
+echo -n "$0: multiply an integer by zero... "
+
+expected='0'
+actual=`echo "(multiply 5 0)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
 exit ${result}
\ No newline at end of file
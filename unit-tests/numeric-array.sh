@@ -0,0 +1,172 @@
+#!/bin/bash
+
+result=0
+
+echo -n "$0: read back an integer array... "
+
+expected='#i[1 2 3]'
+actual=`echo "(integer-array '(1 2 3))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: add two integer arrays... "
+
+expected='#i[11 22 33]'
+actual=`echo "(+ (integer-array '(1 2 3)) (integer-array '(10 20 30)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: subtract an integer array from a number... "
+
+expected='#i[9 8 7 6 5]'
+actual=`echo "(- 10 (integer-array '(1 2 3 4 5)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: multiply a real array by a number... "
+
+expected='#r[2 5 6]'
+actual=`echo "(* 2 (real-array '(1 2.5 3)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: multiply an array by zero... "
+
+expected='#i[0 0 0]'
+actual=`echo "(* 0 (integer-array '(1 2 3)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: add an integer array to a real... "
+
+expected='#r[1.5 2.5 3.5]'
+actual=`echo "(+ (integer-array '(1 2 3)) 0.5)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: sum an integer array... "
+
+expected='15'
+actual=`echo "(array-sum (integer-array '(1 2 3 4 5)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: dot product of real arrays... "
+
+expected='32'
+actual=`echo "(array-dot (real-array '(1 2 3)) (real-array '(4 5 6)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: greatest element of a real array... "
+
+expected='9'
+actual=`echo "(array-max (real-array '(5 2 9 1 4)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: compare a real array with a number... "
+
+expected='#i[1 1 0 0 0]'
+actual=`echo "(array< (real-array '(1 2 3 4 5)) 3)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: count and nth of an array... "
+
+expected='8'
+actual=`echo "(+ (count (integer-array '(7 8 9))) (nth 2 (integer-array '(7 8 9))) -3)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: arrays of different lengths... "
+
+actual=`echo "(+ (integer-array '(1 2)) (integer-array '(1 2 3)))" | target/psse 2>&1 | grep -c "arrays differ in length"`
+
+if [ "${actual}" -gt 0 ]
+then
+    echo "OK"
+else
+    echo "Fail: expected an exception"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: integer array overflow... "
+
+actual=`echo "(* (integer-array '(1000000000)) (integer-array '(1000000000)) (integer-array '(1000000000)))" | target/psse 2>&1 | grep -c "Integer array overflow"`
+
+if [ "${actual}" -gt 0 ]
+then
+    echo "OK"
+else
+    echo "Fail: expected an exception"
+    result=`echo "${result} + 1" | bc`
+fi
+
+exit ${result}
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+result=0
+
+build='(set! build (lambda (n acc) (cond ((= n 0) acc) (t (build (- n 1) (cons n acc))))))'
+
+#####################################################################
+# Collecting only the nursery recovers the garbage of each form
+echo -n "$0: the nursery is collected... "
+recovered=`echo "${build} (count (build 200 nil)) (count (build 200 nil)) (count (build 200 nil))" | target/psse -M -g 0 -n 1 -c 64 -S 2>&1 >/dev/null | grep 'Nursery summary' | sed 's/.*cells recovered \([0-9]*\).*/\1/'`
+
+if [ -n "${recovered}" ] && [ "${recovered}" -gt 0 ]
+then
+    echo "OK"
+else
+    echo "Fail: expected some cells to be recovered, got '${recovered}'"
+    result=1
+fi
+
+#####################################################################
+# A young value stored in a tenured hashmap, which has a write ACL so that
+# `put!` changes it in place, survives collections of the nursery
+echo -n "$0: tenured hashmaps keep young values alive... "
+expected='(1 2 3 4 5)'
+actual=`echo "${build} (set! h (hashmap nil nil nil (list t))) (count (build 200 nil)) (count (build 200 nil)) (put! h :k (build 5 nil)) (count (build 200 nil)) (count (build 200 nil)) (count (build 200 nil)) (:k h)" | target/psse -M -g 0 -n 1 -c 64 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+exit ${result}
@@ -0,0 +1,99 @@
+#!/bin/bash
+
+result=0
+
+echo -n "$0: a string read is packed, but is still a string... "
+
+expected='"STRG"'
+actual=`echo '(type "abc")' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: count of a packed string... "
+
+expected='3'
+actual=`echo '(count "abc")' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: nth of a packed string... "
+
+expected='"b"'
+actual=`echo '(nth 2 "abc")' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: car and cdr of a packed string... "
+
+expected='("a" "bc")'
+actual=`echo '(list (car "abc") (cdr "abc"))' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: a packed string equals a cell string... "
+
+expected='t'
+actual=`echo '(= (type nil) "NIL ")' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: append and reverse packed strings... "
+
+expected='"eredolleh"'
+actual=`echo '(reverse (append "hello" "dere"))' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+echo -n "$0: slurp a long file into a packed string... "
+
+tmp=tmp/packed.$$
+head -c 100000 /dev/zero | tr '\0' 'x' > ${tmp}
+expected='100,000'
+actual=`echo "(count (slurp (open \"${tmp}\")))" | target/psse 2>/dev/null | tail -1`
+rm -f ${tmp}
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
+exit ${result}
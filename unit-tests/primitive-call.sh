@@ -0,0 +1,36 @@
+#!/bin/bash
+
+result=0
+
+#####################################################################
+# A primitive which throws an exception still shows its own frame, with
+# its arguments, in the stack trace, although it ran without one in
+# vector space
+echo -n "$0: an exception in a primitive keeps the primitive's frame... "
+expected='Stack frame 2 with 1 arguments:'
+actual=`echo "(car 1)" | target/psse 2>&1 | grep 'Stack frame 2 '`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# Primitives called with more arguments than fit in a frame take the
+# general path, and agree with those which do not
+echo -n "$0: wide and narrow calls of a primitive agree... "
+expected='t'
+actual=`echo "(= (+ 1 2 3 4 5 6 7 8 9 10) (+ (+ 1 2 3 4) (+ 5 6 7 8) (+ 9 10)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+exit ${result}
@@ -26,4 +26,18 @@ else
     result=`echo "${result} + 1" | bc`
 fi
 
+echo -n "$0: quoted forms in a function body survive calls... "
+expected='(lambda (x) (progn (quote (a b c)) x))'
+actual=`{ echo "(set! f (lambda (x) (progn (quote (a b c)) x)))"; \
+          for i in $(seq 200); do echo "(f 1)"; done; \
+          echo "(source f)"; } | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=`echo "${result} + 1" | bc`
+fi
+
 exit ${result}
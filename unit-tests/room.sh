@@ -0,0 +1,33 @@
+#!/bin/bash
+
+result=0
+
+#####################################################################
+# (room) returns a hashmap of the use of memory, broken down by type
+echo -n "$0: room returns a hashmap by type... "
+expected='"HASH"'
+actual=`echo "(type (:by-type (room)))" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+#####################################################################
+# Making a list of ten elements allocates at least ten conses
+echo -n "$0: room counts conses allocated... "
+expected='nil'
+actual=`echo '(set! a (:allocated (:cons (:by-type (room))))) (set! l (list 1 2 3 4 5 6 7 8 9 10)) (negative? (- (:allocated (:cons (:by-type (room)))) a 10))' | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+exit ${result}
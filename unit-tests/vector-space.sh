@@ -0,0 +1,48 @@
+#!/bin/bash
+
+result=0
+
+countdown='(set! f (lambda (n) (cond ((= n 0) 0) (t (f (- n 1))))))'
+
+slabs () {
+    forms=''
+    for i in `seq $1`
+    do
+        forms="${forms} (f 100)"
+    done
+    echo "${countdown} ${forms}" | target/psse -S 2>&1 >/dev/null |\
+        grep ' slabs, ' | sed 's/.*: *\([0-9]*\) slabs.*/\1/' |\
+        awk '{ n += $1 } END { print n + 0 }'
+}
+
+#####################################################################
+# The stack frames of function calls are recycled, so that four times as
+# many calls take no more slabs of vector space
+echo -n "$0: vector space does not grow with the number of calls... "
+few=`slabs 10`
+many=`slabs 40`
+
+if [ "${few}" -gt 0 ] && [ "${few}" = "${many}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected the same number of slabs, got '${few}' and '${many}'"
+    result=1
+fi
+
+#####################################################################
+# Frames taken from the pool are given back to it: no more frames are live
+# after a thousand deep calls than before them
+echo -n "$0: stack frames are all given back... "
+expected='t'
+actual=`echo "${countdown} (set! before (:live (:stak (:by-vector-type (room))))) (f 1000) (set! after (:live (:stak (:by-vector-type (room))))) (= before after)" | target/psse 2>/dev/null | tail -1`
+
+if [ "${expected}" = "${actual}" ]
+then
+    echo "OK"
+else
+    echo "Fail: expected '${expected}', got '${actual}'"
+    result=1
+fi
+
+exit ${result}